@@ -280,12 +280,15 @@ void BoundMemberVariable::GenLoad(Machine& machine, Function& function)
         else
         {
             classObject->GenLoad(machine, function);
+            ClassTypeSymbol* classTypeSymbol = dynamic_cast<ClassTypeSymbol*>(memberVariableSymbol->Parent());
+            Assert(classTypeSymbol, "class type symbol expected");
+            int32_t fieldOffset = static_cast<int32_t>(classTypeSymbol->GetObjectType()->GetField(index).Offset().Value());
             switch (index)
             {
-                case 0:  loadFieldInst = std::move(machine.CreateInst("loadfield.0")); static_cast<LoadField0Inst*>(loadFieldInst.get())->SetFieldType(GetType()->GetValueType());  break;
-                case 1:  loadFieldInst = std::move(machine.CreateInst("loadfield.1")); static_cast<LoadField1Inst*>(loadFieldInst.get())->SetFieldType(GetType()->GetValueType());   break;
-                case 2:  loadFieldInst = std::move(machine.CreateInst("loadfield.2")); static_cast<LoadField2Inst*>(loadFieldInst.get())->SetFieldType(GetType()->GetValueType());  break;
-                case 3:  loadFieldInst = std::move(machine.CreateInst("loadfield.3")); static_cast<LoadField3Inst*>(loadFieldInst.get())->SetFieldType(GetType()->GetValueType());  break;
+                case 0:  loadFieldInst = std::move(machine.CreateInst("loadfield.0")); static_cast<LoadField0Inst*>(loadFieldInst.get())->SetFieldType(GetType()->GetValueType()); static_cast<LoadField0Inst*>(loadFieldInst.get())->SetFieldOffset(fieldOffset);  break;
+                case 1:  loadFieldInst = std::move(machine.CreateInst("loadfield.1")); static_cast<LoadField1Inst*>(loadFieldInst.get())->SetFieldType(GetType()->GetValueType()); static_cast<LoadField1Inst*>(loadFieldInst.get())->SetFieldOffset(fieldOffset);   break;
+                case 2:  loadFieldInst = std::move(machine.CreateInst("loadfield.2")); static_cast<LoadField2Inst*>(loadFieldInst.get())->SetFieldType(GetType()->GetValueType()); static_cast<LoadField2Inst*>(loadFieldInst.get())->SetFieldOffset(fieldOffset);  break;
+                case 3:  loadFieldInst = std::move(machine.CreateInst("loadfield.3")); static_cast<LoadField3Inst*>(loadFieldInst.get())->SetFieldType(GetType()->GetValueType()); static_cast<LoadField3Inst*>(loadFieldInst.get())->SetFieldOffset(fieldOffset);  break;
                 default:
                 {
                     if (index < 256)
@@ -293,18 +296,21 @@ void BoundMemberVariable::GenLoad(Machine& machine, Function& function)
                         loadFieldInst = std::move(machine.CreateInst("loadfield.b"));
                         loadFieldInst->SetIndex(static_cast<uint8_t>(index));
                         static_cast<LoadFieldBInst*>(loadFieldInst.get())->SetFieldType(GetType()->GetValueType());
+                        static_cast<LoadFieldBInst*>(loadFieldInst.get())->SetFieldOffset(fieldOffset);
                     }
                     else if (index < 65536)
                     {
                         loadFieldInst = std::move(machine.CreateInst("loadfield.s"));
                         loadFieldInst->SetIndex(static_cast<uint16_t>(index));
                         static_cast<LoadFieldSInst*>(loadFieldInst.get())->SetFieldType(GetType()->GetValueType());
+                        static_cast<LoadFieldSInst*>(loadFieldInst.get())->SetFieldOffset(fieldOffset);
                     }
                     else
                     {
                         loadFieldInst = std::move(machine.CreateInst("loadfield"));
                         loadFieldInst->SetIndex(index);
                         static_cast<LoadFieldInst*>(loadFieldInst.get())->SetFieldType(GetType()->GetValueType());
+                        static_cast<LoadFieldInst*>(loadFieldInst.get())->SetFieldOffset(fieldOffset);
                     }
                     break;
                 }
@@ -349,12 +355,15 @@ void BoundMemberVariable::GenStore(Machine& machine, Function& function)
         else
         {
             classObject->GenLoad(machine, function);
+            ClassTypeSymbol* classTypeSymbol = dynamic_cast<ClassTypeSymbol*>(memberVariableSymbol->Parent());
+            Assert(classTypeSymbol, "class type symbol expected");
+            int32_t fieldOffset = static_cast<int32_t>(classTypeSymbol->GetObjectType()->GetField(index).Offset().Value());
             switch (index)
             {
-                case 0:  storeFieldInst = std::move(machine.CreateInst("storefield.0")); static_cast<StoreField0Inst*>(storeFieldInst.get())->SetFieldType(GetType()->GetValueType()); break;
-                case 1:  storeFieldInst = std::move(machine.CreateInst("storefield.1")); static_cast<StoreField1Inst*>(storeFieldInst.get())->SetFieldType(GetType()->GetValueType()); break;
-                case 2:  storeFieldInst = std::move(machine.CreateInst("storefield.2")); static_cast<StoreField2Inst*>(storeFieldInst.get())->SetFieldType(GetType()->GetValueType()); break;
-                case 3:  storeFieldInst = std::move(machine.CreateInst("storefield.3")); static_cast<StoreField3Inst*>(storeFieldInst.get())->SetFieldType(GetType()->GetValueType()); break;
+                case 0:  storeFieldInst = std::move(machine.CreateInst("storefield.0")); static_cast<StoreField0Inst*>(storeFieldInst.get())->SetFieldType(GetType()->GetValueType()); static_cast<StoreField0Inst*>(storeFieldInst.get())->SetFieldOffset(fieldOffset); break;
+                case 1:  storeFieldInst = std::move(machine.CreateInst("storefield.1")); static_cast<StoreField1Inst*>(storeFieldInst.get())->SetFieldType(GetType()->GetValueType()); static_cast<StoreField1Inst*>(storeFieldInst.get())->SetFieldOffset(fieldOffset); break;
+                case 2:  storeFieldInst = std::move(machine.CreateInst("storefield.2")); static_cast<StoreField2Inst*>(storeFieldInst.get())->SetFieldType(GetType()->GetValueType()); static_cast<StoreField2Inst*>(storeFieldInst.get())->SetFieldOffset(fieldOffset); break;
+                case 3:  storeFieldInst = std::move(machine.CreateInst("storefield.3")); static_cast<StoreField3Inst*>(storeFieldInst.get())->SetFieldType(GetType()->GetValueType()); static_cast<StoreField3Inst*>(storeFieldInst.get())->SetFieldOffset(fieldOffset); break;
                 default:
                 {
                     if (index < 256)
@@ -362,18 +371,21 @@ void BoundMemberVariable::GenStore(Machine& machine, Function& function)
                         storeFieldInst = std::move(machine.CreateInst("storefield.b"));
                         storeFieldInst->SetIndex(static_cast<uint8_t>(index));
                         static_cast<StoreFieldBInst*>(storeFieldInst.get())->SetFieldType(GetType()->GetValueType());
+                        static_cast<StoreFieldBInst*>(storeFieldInst.get())->SetFieldOffset(fieldOffset);
                     }
                     else if (index < 65536)
                     {
                         storeFieldInst = std::move(machine.CreateInst("storefield.s"));
                         storeFieldInst->SetIndex(static_cast<uint16_t>(index));
                         static_cast<StoreFieldSInst*>(storeFieldInst.get())->SetFieldType(GetType()->GetValueType());
+                        static_cast<StoreFieldSInst*>(storeFieldInst.get())->SetFieldOffset(fieldOffset);
                     }
                     else
                     {
                         storeFieldInst = std::move(machine.CreateInst("storefield"));
                         storeFieldInst->SetIndex(index);
                         static_cast<StoreFieldInst*>(storeFieldInst.get())->SetFieldType(GetType()->GetValueType());
+                        static_cast<StoreFieldInst*>(storeFieldInst.get())->SetFieldOffset(fieldOffset);
                     }
                     break;
                 }
@@ -11,6 +11,7 @@
 #include <cminor/machine/MachineFunctionVisitor.hpp>
 #include <cminor/machine/Machine.hpp>
 #include <cminor/machine/Class.hpp>
+#include <cminor/machine/ExecutionProfile.hpp>
 #include <cminor/symbols/SymbolReader.hpp>
 #include <cminor/symbols/SymbolWriter.hpp>
 #include <cminor/util/Path.hpp>
@@ -28,6 +29,10 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <limits>
+#include <thread>
+#include <atomic>
+#include <exception>
 #ifdef _WIN32
 #pragma warning(disable:4267)
 #pragma warning(disable:4244)
@@ -45,6 +50,7 @@
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/MDBuilder.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Mangler.h>
@@ -57,6 +63,10 @@
 #include <llvm/Analysis/TargetLibraryInfo.h>
 #include <llvm/Object/ObjectFile.h>
 #include <llvm/CodeGen/TargetPassConfig.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Config/llvm-config.h>
 #ifdef _WIN32
 #pragma warning(default:4267)
 #pragma warning(default:4244)
@@ -74,6 +84,39 @@ using namespace cminor::unicode;
 
 typedef llvm::SmallVector<llvm::Value*, 4> ArgVector;
 
+const int minFunctionsPerCodeGenPartition = 256;
+const int numCachedCodeGenPartitions = 16;
+const uint64_t hotFunctionPercent = 1;
+const int hotInlineLimitFactor = 4;
+
+//  A code generation partition owns an LLVM context of its own, so that the partitions can be compiled to object code in parallel.
+
+struct CodeGenPartition
+{
+    CodeGenPartition(const std::string& objectFilePath_) : objectFilePath(objectFilePath_), cached(false) {}
+    std::string objectFilePath;
+    llvm::SmallString<0> bitcode;
+    std::string cacheKey;
+    bool cached;
+    LLVMContext context;
+    std::unique_ptr<Module> module;
+    std::unique_ptr<TargetMachine> targetMachine;
+    std::unordered_map<const llvm::Function*, Function*> llvmFunctionMap;
+    std::unique_ptr<raw_fd_ostream> objectFile;
+    legacy::PassManager passManager;
+};
+
+//  A canonical array loop without calls. The length of the array and the pointer to its elements are computed once before the loop is entered.
+
+struct CallFreeArrayLoop
+{
+    CallFreeArrayLoop(Instruction* lengthCall_, int32_t arrayLocalIndex_) : lengthCall(lengthCall_), arrayLocalIndex(arrayLocalIndex_), length(nullptr), elements(nullptr) {}
+    Instruction* lengthCall;
+    int32_t arrayLocalIndex;
+    llvm::Value* length;
+    llvm::Value* elements;
+};
+
 class ValueStack
 {
 public:
@@ -147,8 +190,8 @@ public:
     void VisitLogicalNotInst(LogicalNotInst& instruction) override;
     void VisitLoadLocalInst(int32_t localIndex) override;
     void VisitStoreLocalInst(int32_t localIndex) override;
-    void VisitLoadFieldInst(int32_t fieldIndex, ValueType fieldType) override;
-    void VisitStoreFieldInst(int32_t fieldIndex, ValueType fieldType) override;
+    void VisitLoadFieldInst(int32_t fieldIndex, int32_t fieldOffset, ValueType fieldType) override;
+    void VisitStoreFieldInst(int32_t fieldIndex, int32_t fieldOffset, ValueType fieldType) override;
     void VisitLoadElemInst(LoadElemInst& instruction) override;
     void VisitStoreElemInst(StoreElemInst& instruction) override;
     void VisitLoadConstantInst(int32_t constantIndex) override;
@@ -240,20 +283,21 @@ private:
     Mode mode;
     llvm::Function* fun;
     Function* function;
-    int32_t nextFunctionVarNumber;
-    int32_t nextClassDataVarNumber;
-    int32_t nextTypePtrVarNumber;
     std::string functionPtrVarName;
     llvm::Constant* functionPtrVar;
     ConstantPool* functionConstantPool;
     ConstantPool* assemblyConstantPool;
     llvm::Constant* constantPoolVariable;
+    llvm::Constant* allocationTableVariable;
+    int32_t arrayElementsFieldOffset;
+    llvm::Value* allocationContext;
     std::vector<AllocaInst*> locals;
     llvm::AllocaInst* functionStackEntry;
     std::unordered_map<std::string, LlvmBinOp> binOpMap;
     std::unordered_map<std::string, LlvmBinPred> binPredMap;
     std::unordered_map<std::string, LlvmConv> convMap;
     std::unordered_map<StringPtr, std::string, StringPtrHash> opFunMap;
+    std::unordered_map<std::u32string, std::string> vmFunctionRtMap;
     ValueStack valueStack;
     llvm::BasicBlock* currentBasicBlock;
     llvm::BasicBlock* entryBasicBlock;
@@ -286,14 +330,34 @@ private:
     std::unordered_set<Function*> inlinedFunctions;
     std::unordered_map<const llvm::Function*, Function*> llvmFunctionMap;
     uint64_t nextStackMapRecordId;
+    bool closedWorld;
+    bool wholeProgram;
+    std::unordered_map<std::u32string, ClassTypeSymbol*> classTypeMap;
+    std::unordered_map<ClassTypeSymbol*, std::vector<ClassTypeSymbol*>> subclassMap;
+    std::unordered_map<std::u32string, InterfaceTypeSymbol*> interfaceTypeMap;
+    std::unordered_map<InterfaceTypeSymbol*, std::vector<std::pair<ClassTypeSymbol*, int32_t>>> interfaceImplementationMap;
+    std::unique_ptr<ExecutionProfile> executionProfile;
+    const FunctionProfile* functionProfile;
+    std::unordered_set<Function*> profileIndexedFunctions;
+    std::unordered_map<Instruction*, int32_t> profileInstIndexMap;
+    std::unordered_set<Instruction*> uncheckedElemAccesses;
+    std::vector<std::unique_ptr<CallFreeArrayLoop>> callFreeArrayLoops;
+    std::unordered_map<Instruction*, CallFreeArrayLoop*> callFreeArrayLoopHeaders;
+    std::unordered_map<Instruction*, CallFreeArrayLoop*> callFreeArrayLoopMap;
     void ScanForInlineCandidates(Function& function);
     bool MakeInlineDecisionFor(Function& function);
     void GenerateInlineDefinitionFor(Function& function);
     void CreateDllMain();
+    void OptimizeModule();
     void GenerateObjectFile(const std::string& assemblyObjectFilePath);
-    void Link(const std::string& assemblyObjectFilePath, std::string& sharedibraryFilePath);
-    void LinkWindows(const std::string& assemblyObjectFilePath, std::string& sharedLibraryFilePath);
-    void LinkLinux(const std::string& assemblyObjectFilePath, std::string& sharedLibraryFilePath);
+    int GetNumCodeGenPartitions() const;
+    void GenerateObjectFiles(const std::string& assemblyObjectFilePath, std::vector<std::string>& objectFilePaths);
+    std::string GetCodeGenOptionsKey() const;
+    void WriteFrameInfo(const std::string& frameInfoFilePath, const CodeGenPartition& partition);
+    void ReadFrameInfo(const std::string& frameInfoFilePath, const std::unordered_map<std::string, Function*>& functionNameMap);
+    void Link(const std::string& assemblyObjectFilePath, const std::vector<std::string>& objectFilePaths, std::string& sharedibraryFilePath);
+    void LinkWindows(const std::string& assemblyObjectFilePath, const std::vector<std::string>& objectFilePaths, std::string& sharedLibraryFilePath);
+    void LinkLinux(const std::string& assemblyObjectFilePath, const std::vector<std::string>& objectFilePaths, std::string& sharedLibraryFilePath);
     void CreateLocalVariables();
     void CreateVariablesForTemporaryGcRoots();
     void StoreTemporaryGcRoot(Instruction& instruction);
@@ -321,6 +385,7 @@ private:
     void InitOpFunMap(ConstantPool& constantPool);
     std::string MangleFunctionName(const Function& function) const;
     llvm::Type* GetType(ValueType type);
+    llvm::Type* GetRtType(ValueType type);
     llvm::IntegerType* GetIntegerType(ValueType type);
     bool IsSignedType(ValueType type) const;
     llvm::ConstantInt* GetConstantInt(ValueType type, IntegralValue value);
@@ -331,13 +396,46 @@ private:
     LlvmConv GetConversionFromULong(ValueType type) const;
     llvm::Value* CreateConversionFromULong(llvm::Value* from, ValueType toType);
     void CallDoNothing();
+    bool IsInlineAccessType(ValueType type) const;
+    llvm::Type* GetMemoryType(ValueType type);
+    llvm::Value* CreateLoadAllocation(llvm::Value* handle);
+    llvm::Value* CreateLoadObject(llvm::Value* objectReference, llvm::BasicBlock* nullReferenceBlock);
+    llvm::Value* CreateMemberPtr(llvm::Value* allocation, int64_t offset, ValueType memberType);
+    llvm::Value* CreateArrayElementPtr(llvm::Value* arr, llvm::Value* index, ValueType elemType, llvm::BasicBlock* failureBlock);
+    llvm::Value* CreateLoadFromMemory(llvm::Value* ptr, ValueType type);
+    void CreateStoreToMemory(llvm::Value* value, llvm::Value* ptr, ValueType type);
+    void CreateLoadFieldCall(llvm::Value* objectReference, int32_t fieldIndex, ValueType fieldType);
+    void CreateStoreFieldCall(llvm::Value* objectReference, llvm::Value* fieldValue, int32_t fieldIndex, ValueType fieldType);
+    void CreateLoadElemCall(llvm::Value* arr, llvm::Value* index, ValueType elemType);
+    void CreateStoreElemCall(llvm::Value* arr, llvm::Value* elementValue, llvm::Value* index, ValueType elemType);
+    bool AllocatesObjects(Function& function) const;
+    llvm::Value* CreateBytePtrMemberPtr(llvm::Value* allocation, int64_t offset);
+    void CreateCreateObjectCall(ClassData* classData);
+    void InitClassHierarchy(Assembly& assembly);
+    Function* GetVirtualCallTarget(VirtualCallInst& instruction, ClassTypeSymbol*& guardClass);
+    Function* GetInterfaceCallTarget(InterfaceCallInst& instruction, int32_t& receiverFieldOffset);
+    llvm::Function* GetDirectCallee(Function* calledFunction);
+    void CreateVirtualFunctionCall(const ArgVector& args, uint32_t vmtIndex, llvm::PointerType* funPtrType, bool callReturnsValue);
+    void CreateInterfaceFunctionCall(ArgVector args, uint32_t imtIndex, llvm::PointerType* funPtrType, bool callReturnsValue);
+    const FunctionProfile* GetFunctionProfile(Function& function) const;
+    bool IsHot(const FunctionProfile& profile) const;
+    void IndexProfiledInstructions(Function& function);
+    void ApplyFunctionProfile();
+    llvm::MDNode* GetBranchWeights(const std::vector<uint64_t>& counts);
+    llvm::MDNode* GetJumpWeights(Instruction& instruction, bool jumpIfTrue);
+    llvm::MDNode* GetSwitchWeights(Instruction& instruction, const std::vector<bool>& caseAdded);
+    void FindUncheckedElemAccesses(Function& function);
+    bool IsCallFreeLoop(Function& function, int32_t c, int32_t j, int32_t& gcPoll) const;
+    void HoistArrayLoopInvariants(CallFreeArrayLoop& loop);
+    llvm::Value* CreateUncheckedElementPtr(Instruction& access, llvm::Value* arr, llvm::Value* index, ValueType elemType);
 };    
 
 NativeCompilerImpl::NativeCompilerImpl() : assembly(nullptr), builder(context), module(), targetMachine(), fun(nullptr), function(nullptr), assemblyConstantPool(nullptr), 
-    functionConstantPool(nullptr), constantPoolVariable(nullptr), nextFunctionVarNumber(0), nextClassDataVarNumber(0), 
-    nextTypePtrVarNumber(0), functionStackEntry(nullptr), currentBasicBlock(nullptr), entryBasicBlock(nullptr), lastAlloca(nullptr), currentExceptionBlockId(-1),  
+    functionConstantPool(nullptr), constantPoolVariable(nullptr), allocationTableVariable(nullptr), arrayElementsFieldOffset(-1), allocationContext(nullptr), 
+    functionStackEntry(nullptr), currentBasicBlock(nullptr), entryBasicBlock(nullptr), lastAlloca(nullptr), currentExceptionBlockId(-1),  
     currentCatchSectionExceptionBlockId(-1), currentPad(nullptr), currentPadKind(LlvmPadKind::none), currentLandingPad(nullptr), exceptionPtr(nullptr), isGCFun(false), optimizationLevel(0),
-    inlineLimit(0), inlineLocals(0), mode(Mode::normalMode), gcEntry(nullptr)
+    inlineLimit(0), inlineLocals(0), mode(Mode::normalMode), gcEntry(nullptr), closedWorld(false), wholeProgram(false), 
+    functionProfile(nullptr)
 {
     InitializeAllTargetInfos();
     InitializeAllTargets();
@@ -870,7 +968,7 @@ llvm::Constant* NativeCompilerImpl::GetClassDataPtrVar(ClassData* classData)
     {
         return it->second;
     }
-    std::string classDataPtrVarName = "__CD" + std::to_string(nextClassDataVarNumber++) + "_" + assembly->Hash();
+    std::string classDataPtrVarName = "__CD_" + GetSha1MessageDigest(ToUtf8(classData->Type()->Name().Value())) + "_" + assembly->Hash();
     std::u32string classDataPtrVarNameUtf32 = ToUtf32(classDataPtrVarName);
     Constant classDataPtrVarNameConstant = assembly->GetConstantPool().GetConstant(assembly->GetConstantPool().Install(StringPtr(classDataPtrVarNameUtf32.c_str())));
     Constant classDataNameConstant = assembly->GetConstantPool().GetConstant(assembly->GetConstantPool().Install(classData->Type()->Name()));
@@ -890,7 +988,7 @@ llvm::Constant* NativeCompilerImpl::GetTypePtrVar(Type* type)
     {
         return it->second;
     }
-    std::string typePtrVarName = "__T" + std::to_string(nextTypePtrVarNumber++) + "_" + assembly->Hash();
+    std::string typePtrVarName = "__T_" + GetSha1MessageDigest(ToUtf8(type->Name().Value())) + "_" + assembly->Hash();
     std::u32string typePtrVarNameUtf32 = ToUtf32(typePtrVarName);
     Constant typePtrVarNameConstant = assembly->GetConstantPool().GetConstant(assembly->GetConstantPool().Install(StringPtr(typePtrVarNameUtf32.c_str())));
     Constant typeNameConstant = assembly->GetConstantPool().GetConstant(assembly->GetConstantPool().Install(type->Name()));
@@ -910,7 +1008,7 @@ llvm::Constant* NativeCompilerImpl::GetFunctionPtrVar(Function* function)
     {
         return it->second;
     }
-    std::string functionPtrVarName = "__F" + std::to_string(nextFunctionVarNumber++) + "_" + assembly->Hash();
+    std::string functionPtrVarName = "__F_" + GetSha1MessageDigest(ToUtf8(function->CallName().Value().AsStringLiteral())) + "_" + assembly->Hash();
     std::u32string functionPtrVarNameUtf32 = ToUtf32(functionPtrVarName);
     Constant functionPtrVarNameConstant = assembly->GetConstantPool().GetConstant(assembly->GetConstantPool().Install(StringPtr(functionPtrVarNameUtf32.c_str())));
     Constant functionNameConstant = assembly->GetConstantPool().GetConstant(assembly->GetConstantPool().Install(function->CallName()));
@@ -959,6 +1057,8 @@ void NativeCompilerImpl::BeginModule(Assembly& assembly)
     this->assembly = &assembly;
     assemblyConstantPool = &assembly.GetConstantPool();
     InitOpFunMap(*assemblyConstantPool);
+    InitClassHierarchy(assembly);
+    wholeProgram = closedWorld && GetGlobalFlag(GlobalFlags::wholeProgram);
     module.reset(new Module(assemblyName, context));
     std::string targetTriple = sys::getDefaultTargetTriple();
     module->setTargetTriple(targetTriple);
@@ -986,6 +1086,15 @@ void NativeCompilerImpl::BeginModule(Assembly& assembly)
     }
     inlineLimit = GetInlineLimit();
     inlineLocals = GetInlineLocals();
+    if (!GetProfileFilePath().empty() && !executionProfile)
+    {
+        if (GetGlobalFlag(GlobalFlags::verbose))
+        {
+            std::cout << "Reading execution profile " << GetProfileFilePath() << "..." << std::endl;
+        }
+        executionProfile.reset(new ExecutionProfile());
+        executionProfile->Read(GetProfileFilePath());
+    }
     targetMachine.reset(target->createTargetMachine(targetTriple, "generic", "", targetOptions, relocModel, codeModel, codeGenLevel));
     dataLayout.reset(new llvm::DataLayout(targetMachine->createDataLayout()));
     module->setDataLayout(*dataLayout);
@@ -1003,12 +1112,30 @@ void NativeCompilerImpl::BeginModule(Assembly& assembly)
         *listStream << "optimization level: " << optimizationLevel << std::endl;
         *listStream << "inline limit: " << inlineLimit << " or fewer intermediate instructions (0 = no inlining)" << std::endl;
         *listStream << "inline locals: " << inlineLocals << std::endl;
+        *listStream << "whole program: " << (wholeProgram ? "true" : "false") << std::endl;
+        *listStream << "execution profile: " << (executionProfile ? GetProfileFilePath() : "none") << std::endl;
     }
     constantPoolVariable = module->getOrInsertGlobal("__constant_pool_" + assembly.Hash(), PointerType::get(GetType(ValueType::byteType), 0));
     ExportGlobalVariable(constantPoolVariable);
     llvm::GlobalVariable* constantPoolVar = cast<llvm::GlobalVariable>(constantPoolVariable);
     constantPoolVar->setInitializer(llvm::Constant::getNullValue(PointerType::get(GetType(ValueType::byteType), 0)));
-    nextFunctionVarNumber = 0;
+    allocationTableVariable = module->getOrInsertGlobal("__allocation_table_" + assembly.Hash(), PointerType::get(GetType(ValueType::byteType), 0));
+    ExportGlobalVariable(allocationTableVariable);
+    llvm::GlobalVariable* allocationTableVar = cast<llvm::GlobalVariable>(allocationTableVariable);
+    allocationTableVar->setInitializer(llvm::Constant::getNullValue(PointerType::get(GetType(ValueType::byteType), 0)));
+    arrayElementsFieldOffset = -1;
+    try
+    {
+        ObjectType* arrayType = dynamic_cast<ObjectType*>(TypeTable::GetType(StringPtr(U"System.Array")));
+        if (arrayType && arrayType->FieldCount() == 2)
+        {
+            // the elements handle of an array (field 2) follows the fields of System.Array
+            arrayElementsFieldOffset = static_cast<int32_t>(arrayType->ObjectSize());
+        }
+    }
+    catch (const std::runtime_error&)
+    {
+    }
     std::vector<Attribute::AttrKind> nounwindAttributes;
     nounwindAttributes.push_back(llvm::Attribute::UWTable);
     nounwindAttributes.push_back(llvm::Attribute::NoUnwind);
@@ -1067,7 +1194,9 @@ void NativeCompilerImpl::EndModule()
 #else
     std::string assemblyObjectFilePath = boost::filesystem::path(assembly->FilePathReadFrom()).replace_extension(".o").generic_string();
 #endif
-    GenerateObjectFile(assemblyObjectFilePath);
+    OptimizeModule();
+    std::vector<std::string> objectFilePaths;
+    GenerateObjectFiles(assemblyObjectFilePath, objectFilePaths);
     std::string optLlFilePath = boost::filesystem::path(assembly->FilePathReadFrom()).replace_extension(".opt.ll").generic_string();
     if (GetGlobalFlag(GlobalFlags::emitOptLlvm))
     {
@@ -1080,7 +1209,7 @@ void NativeCompilerImpl::EndModule()
         module->print(optLlOs, nullptr);
     }
     std::string sharedLibraryFilePath;
-    Link(assemblyObjectFilePath, sharedLibraryFilePath);
+    Link(assemblyObjectFilePath, objectFilePaths, sharedLibraryFilePath);
 }
 
 void NativeCompilerImpl::CreateDllMain()
@@ -1117,6 +1246,57 @@ void NativeCompilerImpl::CreateDllMain()
     }
 }
 
+//  The LLVM optimization pipeline of the optimization level runs on the whole module before it is split for code generation. From level 2 on it 
+//  includes the function inliner, which inlines the inline definitions that ScanForInlineCandidates generated for the called functions, and the 
+//  loop vectorizer. The inliner deletes the inline definitions it has inlined everywhere, so the function map is rebuilt by name afterwards.
+
+void NativeCompilerImpl::OptimizeModule()
+{
+    if (optimizationLevel == 0) return;
+    if (GetGlobalFlag(GlobalFlags::verbose))
+    {
+        std::cout << "Optimizing module " << module->getName().str() << "..." << std::endl;
+    }
+    std::unordered_map<std::string, Function*> functionNameMap;
+    for (const auto& p : llvmFunctionMap)
+    {
+        functionNameMap[p.first->getName().str()] = p.second;
+    }
+    llvmFunctionMap.clear();
+    llvm::PassManagerBuilder passManagerBuilder;
+    passManagerBuilder.OptLevel = optimizationLevel;
+    passManagerBuilder.SizeLevel = 0;
+    passManagerBuilder.LibraryInfo = new llvm::TargetLibraryInfoImpl(llvm::Triple(module->getTargetTriple()));
+    if (optimizationLevel > 1)
+    {
+        passManagerBuilder.Inliner = llvm::createFunctionInliningPass(optimizationLevel > 2 ? 250 : 225);
+    }
+    passManagerBuilder.DisableUnrollLoops = optimizationLevel < 2;
+    passManagerBuilder.LoopVectorize = optimizationLevel > 1;
+    passManagerBuilder.SLPVectorize = optimizationLevel > 2;
+    legacy::FunctionPassManager functionPassManager(module.get());
+    functionPassManager.add(llvm::createTargetTransformInfoWrapperPass(targetMachine->getTargetIRAnalysis()));
+    passManagerBuilder.populateFunctionPassManager(functionPassManager);
+    legacy::PassManager modulePassManager;
+    modulePassManager.add(llvm::createTargetTransformInfoWrapperPass(targetMachine->getTargetIRAnalysis()));
+    passManagerBuilder.populateModulePassManager(modulePassManager);
+    functionPassManager.doInitialization();
+    for (llvm::Function& f : *module)
+    {
+        functionPassManager.run(f);
+    }
+    functionPassManager.doFinalization();
+    modulePassManager.run(*module);
+    for (const llvm::Function& f : *module)
+    {
+        auto it = functionNameMap.find(f.getName().str());
+        if (it != functionNameMap.cend())
+        {
+            llvmFunctionMap[&f] = it->second;
+        }
+    }
+}
+
 void NativeCompilerImpl::GenerateObjectFile(const std::string& assemblyObjectFilePath)
 {
     if (GetGlobalFlag(GlobalFlags::verbose))
@@ -1145,6 +1325,249 @@ void NativeCompilerImpl::GenerateObjectFile(const std::string& assemblyObjectFil
     }
 }
 
+//  The number of partitions does not depend on the number of cores, because SplitModule assigns a function to a partition by the hash of its 
+//  name modulo the number of partitions, and a different count would move the functions to other partitions and invalidate the object code cache.
+
+int NativeCompilerImpl::GetNumCodeGenPartitions() const
+{
+    int numFunctions = 0;
+    for (const llvm::Function& f : *module)
+    {
+        if (!f.isDeclaration())
+        {
+            ++numFunctions;
+        }
+    }
+    if (numFunctions < 2 * minFunctionsPerCodeGenPartition)
+    {
+        return 1;
+    }
+    return numCachedCodeGenPartitions;
+}
+
+std::string NativeCompilerImpl::GetCodeGenOptionsKey() const
+{
+    std::string key = LLVM_VERSION_STRING;
+    key.append(1, ';').append(targetMachine->getTargetTriple().str());
+    key.append(1, ';').append(targetMachine->getTargetCPU().str());
+    key.append(1, ';').append(targetMachine->getTargetFeatureString().str());
+    key.append(1, ';').append(std::to_string(static_cast<int>(targetMachine->getOptLevel())));
+    key.append(1, ';').append(std::to_string(static_cast<int>(targetMachine->getRelocationModel())));
+    key.append(1, ';').append(std::to_string(static_cast<int>(targetMachine->getCodeModel())));
+    key.append(1, ';');
+    return key;
+}
+
+//  The frame information the GC pass computes for the functions of a partition is cached with the object code of the partition, 
+//  one line per function: mangled name, frame size, line number variable offset and GC root stack offsets.
+
+void NativeCompilerImpl::WriteFrameInfo(const std::string& frameInfoFilePath, const CodeGenPartition& partition)
+{
+    std::ofstream frameInfoFile(frameInfoFilePath);
+    for (const auto& p : partition.llvmFunctionMap)
+    {
+        Function* function = p.second;
+        frameInfoFile << p.first->getName().str() << " " << function->FrameSize() << " " << function->LineNumberVarOffset() << " " << function->GCRootStackOffsets().size();
+        for (int32_t gcRootStackOffset : function->GCRootStackOffsets())
+        {
+            frameInfoFile << " " << gcRootStackOffset;
+        }
+        frameInfoFile << "\n";
+    }
+}
+
+void NativeCompilerImpl::ReadFrameInfo(const std::string& frameInfoFilePath, const std::unordered_map<std::string, Function*>& functionNameMap)
+{
+    std::ifstream frameInfoFile(frameInfoFilePath);
+    std::string functionName;
+    while (frameInfoFile >> functionName)
+    {
+        uint64_t frameSize = 0;
+        uint32_t lineNumberVarOffset = 0;
+        size_t numGCRootStackOffsets = 0;
+        frameInfoFile >> frameSize >> lineNumberVarOffset >> numGCRootStackOffsets;
+        std::vector<int32_t> gcRootStackOffsets;
+        for (size_t i = 0; i < numGCRootStackOffsets; ++i)
+        {
+            int32_t gcRootStackOffset = 0;
+            frameInfoFile >> gcRootStackOffset;
+            gcRootStackOffsets.push_back(gcRootStackOffset);
+        }
+        if (!frameInfoFile)
+        {
+            throw std::runtime_error("NativeCompiler: invalid frame information file '" + frameInfoFilePath + "'");
+        }
+        auto it = functionNameMap.find(functionName);
+        if (it != functionNameMap.cend())
+        {
+            Function* function = it->second;
+            function->SetFrameSize(frameSize);
+            function->SetLineNumberVarOffset(lineNumberVarOffset);
+            function->ResetGCRootStackOffsets();
+            for (int32_t gcRootStackOffset : gcRootStackOffsets)
+            {
+                function->AddGCRootStackOffset(gcRootStackOffset);
+            }
+        }
+    }
+}
+
+//  A large module is split into partitions by function and the partitions are compiled to object files in parallel. Each partition is written 
+//  to bitcode and read back into a context of its own. The code generation passes are set up in this thread, because the GC pass is installed
+//  through a global hook, and only running them is done in parallel by as many threads as there are cores. A listing or optimized LLVM code is 
+//  generated from the unsplit module.
+//
+//  The object code of each partition is cached in the ASSEMBLY_NAME.cache directory under the SHA-1 digest of its bitcode and the code generation 
+//  options. A partition whose functions have not changed since the previous build is not compiled again. The cache keeps the entries of the latest build.
+
+void NativeCompilerImpl::GenerateObjectFiles(const std::string& assemblyObjectFilePath, std::vector<std::string>& objectFilePaths)
+{
+    if (listStream || GetGlobalFlag(GlobalFlags::emitOptLlvm))
+    {
+        GenerateObjectFile(assemblyObjectFilePath);
+        objectFilePaths.push_back(assemblyObjectFilePath);
+        return;
+    }
+    std::unordered_map<std::string, Function*> functionNameMap;
+    for (const auto& p : llvmFunctionMap)
+    {
+        functionNameMap[p.first->getName().str()] = p.second;
+    }
+    llvmFunctionMap.clear();
+    int numPartitions = GetNumCodeGenPartitions();
+    std::string codeGenOptionsKey = GetCodeGenOptionsKey();
+    std::string cacheDir = boost::filesystem::path(assemblyObjectFilePath).replace_extension(".cache").generic_string();
+    boost::filesystem::create_directories(cacheDir);
+    std::string objectFileExtension = boost::filesystem::path(assemblyObjectFilePath).extension().generic_string();
+    std::vector<std::unique_ptr<CodeGenPartition>> partitions;
+    SplitModule(std::move(module), numPartitions, [&](std::unique_ptr<Module> partitionModule)
+    {
+        std::string objectFilePath = boost::filesystem::path(assemblyObjectFilePath).replace_extension("." + std::to_string(partitions.size()) + objectFileExtension).generic_string();
+        std::unique_ptr<CodeGenPartition> partition(new CodeGenPartition(objectFilePath));
+        llvm::raw_svector_ostream bitcodeStream(partition->bitcode);
+        WriteBitcodeToFile(partitionModule.get(), bitcodeStream);
+        partition->cacheKey = GetSha1MessageDigest(codeGenOptionsKey + std::string(partition->bitcode.begin(), partition->bitcode.end()));
+        partitions.push_back(std::move(partition));
+    });
+    for (const std::unique_ptr<CodeGenPartition>& partition : partitions)
+    {
+        objectFilePaths.push_back(partition->objectFilePath);
+        std::string cachedObjectFilePath = Path::Combine(cacheDir, partition->cacheKey + objectFileExtension);
+        std::string cachedFrameInfoFilePath = Path::Combine(cacheDir, partition->cacheKey + ".frames");
+        if (boost::filesystem::exists(cachedObjectFilePath) && boost::filesystem::exists(cachedFrameInfoFilePath))
+        {
+            if (GetGlobalFlag(GlobalFlags::verbose))
+            {
+                std::cout << "Using cached object code for " << partition->objectFilePath << "..." << std::endl;
+            }
+            boost::filesystem::copy_file(cachedObjectFilePath, partition->objectFilePath, boost::filesystem::copy_option::overwrite_if_exists);
+            ReadFrameInfo(cachedFrameInfoFilePath, functionNameMap);
+            partition->cached = true;
+            continue;
+        }
+        if (GetGlobalFlag(GlobalFlags::verbose))
+        {
+            std::cout << "Generating object code file " << partition->objectFilePath << "..." << std::endl;
+        }
+        llvm::Expected<std::unique_ptr<Module>> partitionModule = parseBitcodeFile(llvm::MemoryBufferRef(partition->bitcode.str(), partition->objectFilePath), partition->context);
+        if (!partitionModule)
+        {
+            throw std::runtime_error("NativeCompiler: reading bitcode of partition '" + partition->objectFilePath + "' failed: " + llvm::toString(partitionModule.takeError()));
+        }
+        partition->module = std::move(*partitionModule);
+        for (const llvm::Function& f : *partition->module)
+        {
+            auto it = functionNameMap.find(f.getName().str());
+            if (it != functionNameMap.cend())
+            {
+                partition->llvmFunctionMap[&f] = it->second;
+            }
+        }
+        partition->targetMachine.reset(targetMachine->getTarget().createTargetMachine(targetMachine->getTargetTriple().str(), targetMachine->getTargetCPU(), 
+            targetMachine->getTargetFeatureString(), targetMachine->Options, targetMachine->getRelocationModel(), targetMachine->getCodeModel(), targetMachine->getOptLevel()));
+        std::error_code errorCode;
+        partition->objectFile.reset(new raw_fd_ostream(partition->objectFilePath, errorCode, sys::fs::F_None));
+        if (errorCode)
+        {
+            throw std::runtime_error("NativeCompiler: cannot open object code file '" + partition->objectFilePath + "': " + errorCode.message());
+        }
+        CminorGCMachineFunctionPass* gcMachineFunctionPass = new CminorGCMachineFunctionPass(&partition->llvmFunctionMap, nullptr, nullptr);
+        SetCustomGCPass(gcMachineFunctionPass);
+        if (partition->targetMachine->addPassesToEmitFile(partition->passManager, *partition->objectFile, TargetMachine::CGFT_ObjectFile))
+        {
+            throw std::runtime_error("NativeCompiler: cannot emit object code file '" + partition->objectFilePath + "' (llvm::TargetMachine::addPassesToEmitFile failed).");
+        }
+    }
+    std::vector<CodeGenPartition*> uncachedPartitions;
+    for (const std::unique_ptr<CodeGenPartition>& partition : partitions)
+    {
+        if (!partition->cached)
+        {
+            uncachedPartitions.push_back(partition.get());
+        }
+    }
+    std::vector<std::exception_ptr> exceptions(uncachedPartitions.size());
+    std::atomic<int> nextPartition(0);
+    int numCodeGenerators = std::min(static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)), static_cast<int>(uncachedPartitions.size()));
+    std::vector<std::thread> codeGenerators;
+    for (int i = 0; i < numCodeGenerators; ++i)
+    {
+        codeGenerators.push_back(std::thread([&]()
+        {
+            for (int index = nextPartition++; index < int(uncachedPartitions.size()); index = nextPartition++)
+            {
+                CodeGenPartition* partition = uncachedPartitions[index];
+                try
+                {
+                    partition->passManager.run(*partition->module);
+                    partition->objectFile->flush();
+                }
+                catch (...)
+                {
+                    exceptions[index] = std::current_exception();
+                }
+            }
+        }));
+    }
+    for (std::thread& codeGenerator : codeGenerators)
+    {
+        codeGenerator.join();
+    }
+    for (const std::exception_ptr& exception : exceptions)
+    {
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+    std::unordered_set<std::string> cacheKeys;
+    for (const std::unique_ptr<CodeGenPartition>& partition : partitions)
+    {
+        cacheKeys.insert(partition->cacheKey);
+        if (partition->cached) continue;
+        partition->objectFile->close();
+        if (partition->objectFile->has_error())
+        {
+            throw std::runtime_error("NativeCompiler: could not emit object code file '" + partition->objectFilePath + "'.");
+        }
+        boost::filesystem::copy_file(partition->objectFilePath, Path::Combine(cacheDir, partition->cacheKey + objectFileExtension), 
+            boost::filesystem::copy_option::overwrite_if_exists);
+        WriteFrameInfo(Path::Combine(cacheDir, partition->cacheKey + ".frames"), *partition);
+    }
+    std::vector<boost::filesystem::path> staleCacheEntries;
+    for (boost::filesystem::directory_iterator it(cacheDir); it != boost::filesystem::directory_iterator(); ++it)
+    {
+        if (cacheKeys.find(it->path().stem().generic_string()) == cacheKeys.cend())
+        {
+            staleCacheEntries.push_back(it->path());
+        }
+    }
+    for (const boost::filesystem::path& staleCacheEntry : staleCacheEntries)
+    {
+        boost::filesystem::remove(staleCacheEntry);
+    }
+}
+
 /*
 void NativeCompilerImpl::ReadStackMapsFromSharedLibraryFile(const std::string& sharedLibraryFilePath)
 {
@@ -1232,16 +1655,16 @@ void NativeCompilerImpl::ReadStackMapSection(const uint8_t* begin, const uint8_t
 }
 */
 
-void NativeCompilerImpl::Link(const std::string& assemblyObjectFilePath, std::string& sharedLibraryFilePath)
+void NativeCompilerImpl::Link(const std::string& assemblyObjectFilePath, const std::vector<std::string>& objectFilePaths, std::string& sharedLibraryFilePath)
 {
     if (GetGlobalFlag(GlobalFlags::verbose))
     {
         std::cout << "Linking " << assemblyObjectFilePath << "..." << std::endl;
     }
 #ifdef _WIN32
-    LinkWindows(assemblyObjectFilePath, sharedLibraryFilePath);
+    LinkWindows(assemblyObjectFilePath, objectFilePaths, sharedLibraryFilePath);
 #else
-    LinkLinux(assemblyObjectFilePath, sharedLibraryFilePath);
+    LinkLinux(assemblyObjectFilePath, objectFilePaths, sharedLibraryFilePath);
 #endif
 }
 
@@ -1279,7 +1702,7 @@ void ImportAssemblyReferences(Assembly* assembly, std::vector<std::string>& args
     }
 }
 
-void NativeCompilerImpl::LinkWindows(const std::string& assemblyObjectFilePath, std::string& sharedLibraryFilePath)
+void NativeCompilerImpl::LinkWindows(const std::string& assemblyObjectFilePath, const std::vector<std::string>& objectFilePaths, std::string& sharedLibraryFilePath)
 {
     std::vector<std::string> args;
     args.push_back("/dll");
@@ -1292,7 +1715,10 @@ void NativeCompilerImpl::LinkWindows(const std::string& assemblyObjectFilePath,
     std::string dllFileName = Path::GetFileName(dllFilePath);
     args.push_back("/out:" + QuotedPath(dllFilePath));
     args.push_back("/stack:16777216");
-    args.push_back(QuotedPath(assemblyObjectFilePath));
+    for (const std::string& objectFilePath : objectFilePaths)
+    {
+        args.push_back(QuotedPath(objectFilePath));
+    }
     std::string cminorLibDir = CminorLibDir();
     args.push_back("/libpath:" + QuotedPath(cminorLibDir));
     args.push_back("cminorrt.lib");
@@ -1351,11 +1777,16 @@ void NativeCompilerImpl::LinkWindows(const std::string& assemblyObjectFilePath,
     sharedLibraryFilePath = dllFilePath;
 }
 
-void NativeCompilerImpl::LinkLinux(const std::string& assemblyObjectFilePath, std::string& sharedLibraryFilePath)
+void NativeCompilerImpl::LinkLinux(const std::string& assemblyObjectFilePath, const std::vector<std::string>& objectFilePaths, std::string& sharedLibraryFilePath)
 {
     std::string so10FilePath = Path::ChangeExtension(assemblyObjectFilePath, ".so.1.0");
     std::string soFileName = Path::GetFileName(Path::ChangeExtension(assemblyObjectFilePath, ".so"));
-    std::string linkCommandLine = "clang++ -shared " + assemblyObjectFilePath + " -o " + so10FilePath;
+    std::string linkCommandLine = "clang++ -shared";
+    for (const std::string& objectFilePath : objectFilePaths)
+    {
+        linkCommandLine.append(" ").append(objectFilePath);
+    }
+    linkCommandLine.append(" -o ").append(so10FilePath);
     std::string linkErrorFilePath = Path::Combine(Path::GetDirectoryName(assemblyObjectFilePath), "clang++.error");
     try
     {
@@ -1435,14 +1866,463 @@ void NativeCompilerImpl::GenerateInlineDefinitionFor(Function& function)
     mode = prevMode;
 }
 
+//  An inline candidate gets an inline definition in this module with the InlineHint attribute. The inliner of OptimizeModule decides whether 
+//  a call to the inline definition is actually inlined. 
+//  In whole program mode every function of a referenced assembly the program calls becomes an inline candidate regardless of its size, 
+//  so the optimizer sees the bodies of the library functions the program uses as if they were part of the program. The copies of the 
+//  library functions get internal linkage, which lets the interprocedural passes of OptimizeModule change their signatures and delete them 
+//  when all calls have been inlined.
+//  With an execution profile, functions that were not called during profiling are not inline candidates and hot functions are candidates up to 
+//  hotInlineLimitFactor times the inline limit.
+
 bool NativeCompilerImpl::MakeInlineDecisionFor(Function& function)
 {
     if (function.HasInlineAttribute()) return true;
+    if (executionProfile)
+    {
+        const FunctionProfile* profile = GetFunctionProfile(function);
+        if (!profile) return false;
+        if (IsHot(*profile) && function.NumInsts() <= hotInlineLimitFactor * inlineLimit && int(function.NumLocals()) <= hotInlineLimitFactor * inlineLocals) return true;
+    }
+    if (wholeProgram && function.GetAssembly() != assembly && function.NumInsts() > 0) return true;
     if (function.NumInsts() > inlineLimit) return false;
     if (int(function.NumLocals()) > inlineLocals) return false;
     return true;
 }
 
+//  A function is hot when it was called at least hotFunctionPercent percent as many times as the most frequently called function of the profile.
+
+const FunctionProfile* NativeCompilerImpl::GetFunctionProfile(Function& function) const
+{
+    return executionProfile->GetFunctionProfile(ToUtf8(function.CallName().Value().AsStringLiteral()));
+}
+
+bool NativeCompilerImpl::IsHot(const FunctionProfile& profile) const
+{
+    return profile.entryCount * 100 >= executionProfile->MaxEntryCount() * hotFunctionPercent;
+}
+
+//  The profile identifies branch and switch instructions by their index in the function as stored in the assembly, 
+//  so the indices are recorded before unreachable instructions are removed.
+
+void NativeCompilerImpl::IndexProfiledInstructions(Function& function)
+{
+    if (!profileIndexedFunctions.insert(&function).second) return;
+    int n = function.NumInsts();
+    for (int i = 0; i < n; ++i)
+    {
+        Instruction* inst = function.GetInst(i);
+        if (inst->IsJumpingInst() || inst->IsContinuousSwitchInst() || inst->IsBinarySearchSwitchInst())
+        {
+            profileInstIndexMap[inst] = i;
+        }
+    }
+}
+
+//  Functions not called during profiling are marked cold. Hot and cold functions are placed in .text.hot and .text.unlikely sections.
+//  The inliner of OptimizeModule uses a higher threshold for calls to a hot function, which gets the InlineHint attribute, and a lower 
+//  threshold for calls to a cold function.
+
+void NativeCompilerImpl::ApplyFunctionProfile()
+{
+    if (functionProfile)
+    {
+        fun->setEntryCount(functionProfile->entryCount);
+        if (IsHot(*functionProfile))
+        {
+            fun->setSectionPrefix(".hot");
+            fun->addFnAttr(llvm::Attribute::InlineHint);
+        }
+    }
+    else
+    {
+        fun->setEntryCount(0);
+        fun->addFnAttr(llvm::Attribute::Cold);
+        fun->setSectionPrefix(".unlikely");
+    }
+}
+
+//  Counts are scaled to 32-bit branch weights. One is added to each weight, so that a branch not taken during profiling is unlikely but not impossible.
+
+llvm::MDNode* NativeCompilerImpl::GetBranchWeights(const std::vector<uint64_t>& counts)
+{
+    uint64_t maxCount = *std::max_element(counts.cbegin(), counts.cend());
+    uint64_t scale = maxCount / (std::numeric_limits<uint32_t>::max() - 1) + 1;
+    std::vector<uint32_t> weights;
+    for (uint64_t count : counts)
+    {
+        weights.push_back(static_cast<uint32_t>(count / scale) + 1);
+    }
+    return MDBuilder(context).createBranchWeights(weights);
+}
+
+llvm::MDNode* NativeCompilerImpl::GetJumpWeights(Instruction& instruction, bool jumpIfTrue)
+{
+    if (!functionProfile) return nullptr;
+    auto it = profileInstIndexMap.find(&instruction);
+    if (it == profileInstIndexMap.cend()) return nullptr;
+    auto bit = functionProfile->branches.find(it->second);
+    if (bit == functionProfile->branches.cend()) return nullptr;
+    const BranchProfile& branchProfile = bit->second;
+    std::vector<uint64_t> counts;
+    if (jumpIfTrue)
+    {
+        counts.push_back(branchProfile.taken);
+        counts.push_back(branchProfile.notTaken);
+    }
+    else
+    {
+        counts.push_back(branchProfile.notTaken);
+        counts.push_back(branchProfile.taken);
+    }
+    return GetBranchWeights(counts);
+}
+
+//  The first weight of a switch is the weight of the default target. Cases that were not added to the switch go to the default target.
+
+llvm::MDNode* NativeCompilerImpl::GetSwitchWeights(Instruction& instruction, const std::vector<bool>& caseAdded)
+{
+    if (!functionProfile) return nullptr;
+    auto it = profileInstIndexMap.find(&instruction);
+    if (it == profileInstIndexMap.cend()) return nullptr;
+    auto sit = functionProfile->switches.find(it->second);
+    if (sit == functionProfile->switches.cend()) return nullptr;
+    const std::vector<uint64_t>& switchCounts = sit->second;
+    int n = int(caseAdded.size());
+    if (int(switchCounts.size()) != n + 1) return nullptr;
+    std::vector<uint64_t> counts;
+    counts.push_back(switchCounts[n]);
+    for (int i = 0; i < n; ++i)
+    {
+        if (caseAdded[i])
+        {
+            counts.push_back(switchCounts[i]);
+        }
+        else
+        {
+            counts[0] += switchCounts[i];
+        }
+    }
+    return GetBranchWeights(counts);
+}
+
+int32_t GetLoadLocalIndex(Instruction* inst)
+{
+    if (LoadLocalInst* loadLocal = dynamic_cast<LoadLocalInst*>(inst)) return loadLocal->Index();
+    if (LoadLocalBInst* loadLocal = dynamic_cast<LoadLocalBInst*>(inst)) return loadLocal->Index();
+    if (LoadLocalSInst* loadLocal = dynamic_cast<LoadLocalSInst*>(inst)) return loadLocal->Index();
+    if (dynamic_cast<LoadLocal0Inst*>(inst)) return 0;
+    if (dynamic_cast<LoadLocal1Inst*>(inst)) return 1;
+    if (dynamic_cast<LoadLocal2Inst*>(inst)) return 2;
+    if (dynamic_cast<LoadLocal3Inst*>(inst)) return 3;
+    return -1;
+}
+
+int32_t GetStoreLocalIndex(Instruction* inst)
+{
+    if (StoreLocalInst* storeLocal = dynamic_cast<StoreLocalInst*>(inst)) return storeLocal->Index();
+    if (StoreLocalBInst* storeLocal = dynamic_cast<StoreLocalBInst*>(inst)) return storeLocal->Index();
+    if (StoreLocalSInst* storeLocal = dynamic_cast<StoreLocalSInst*>(inst)) return storeLocal->Index();
+    if (dynamic_cast<StoreLocal0Inst*>(inst)) return 0;
+    if (dynamic_cast<StoreLocal1Inst*>(inst)) return 1;
+    if (dynamic_cast<StoreLocal2Inst*>(inst)) return 2;
+    if (dynamic_cast<StoreLocal3Inst*>(inst)) return 3;
+    return -1;
+}
+
+//  Returns the type of the integer constant loaded by inst if the constant is equal to value, otherwise ValueType::none.
+
+ValueType GetIntConstantType(Instruction* inst, const ConstantPool& constantPool, int32_t value)
+{
+    int32_t constantIndex = -1;
+    if (LoadConstantInst* loadConstant = dynamic_cast<LoadConstantInst*>(inst))
+    {
+        constantIndex = loadConstant->Index();
+    }
+    else if (LoadConstantBInst* loadConstant = dynamic_cast<LoadConstantBInst*>(inst))
+    {
+        constantIndex = loadConstant->Index();
+    }
+    else if (LoadConstantSInst* loadConstant = dynamic_cast<LoadConstantSInst*>(inst))
+    {
+        constantIndex = loadConstant->Index();
+    }
+    else if (LoadDefaultValueBaseInst* loadDefaultValue = dynamic_cast<LoadDefaultValueBaseInst*>(inst))
+    {
+        return value == 0 && loadDefaultValue->GetValueType() == ValueType::intType ? ValueType::intType : ValueType::none;
+    }
+    if (constantIndex == -1) return ValueType::none;
+    IntegralValue constantValue = constantPool.GetConstant(ConstantId(constantIndex)).Value();
+    bool equal = false;
+    switch (constantValue.GetType())
+    {
+        case ValueType::sbyteType: equal = constantValue.AsSByte() == value; break;
+        case ValueType::byteType: equal = constantValue.AsByte() == value; break;
+        case ValueType::shortType: equal = constantValue.AsShort() == value; break;
+        case ValueType::ushortType: equal = constantValue.AsUShort() == value; break;
+        case ValueType::intType: equal = constantValue.AsInt() == value; break;
+    }
+    return equal ? constantValue.GetType() : ValueType::none;
+}
+
+//  An integer literal is a constant of the smallest type that holds it, so a small literal used as an int is loaded and then widened with a 
+//  conversion instruction. Returns the number of instructions, one or two, of an int constant equal to value ending at instruction end, or 0.
+
+int32_t IntConstantLength(Function& function, int32_t end, int32_t value)
+{
+    if (end < 0) return 0;
+    Instruction* inst = function.GetInst(end);
+    if (ConversionBaseInst* conversion = dynamic_cast<ConversionBaseInst*>(inst))
+    {
+        if (end < 1 || conversion->GetTargetType() != ValueType::intType) return 0;
+        switch (GetIntConstantType(function.GetInst(end - 1), function.GetConstantPool(), value))
+        {
+            case ValueType::sbyteType: return conversion->Name() == "sb2in" ? 2 : 0;
+            case ValueType::byteType: return conversion->Name() == "by2in" ? 2 : 0;
+            case ValueType::shortType: return conversion->Name() == "sh2in" ? 2 : 0;
+            case ValueType::ushortType: return conversion->Name() == "us2in" ? 2 : 0;
+        }
+        return 0;
+    }
+    return GetIntConstantType(inst, function.GetConstantPool(), value) == ValueType::intType ? 1 : 0;
+}
+
+bool IsIntInst(Instruction* inst, const std::string& groupName)
+{
+    return inst->GroupName() == groupName && inst->TypeName() == "System.Int32";
+}
+
+bool IsArrayLengthCall(Instruction* inst)
+{
+    if (!inst->IsCall()) return false;
+    CallInst* callInst = dynamic_cast<CallInst*>(inst);
+    if (!callInst) return false;
+    Function* calledFunction = callInst->GetFunction();
+    return calledFunction && calledFunction->CallName().Value().AsStringLiteral() == std::u32string(U"System.Array.Length.@get(System.Array)");
+}
+
+//  Returns true if inst computes with values on the stack or loads a constant other than a string literal without calling the runtime.
+
+bool IsCallFreeValueInst(Instruction* inst, const ConstantPool& constantPool)
+{
+    int32_t constantIndex = -1;
+    if (LoadConstantInst* loadConstant = dynamic_cast<LoadConstantInst*>(inst))
+    {
+        constantIndex = loadConstant->Index();
+    }
+    else if (LoadConstantBInst* loadConstant = dynamic_cast<LoadConstantBInst*>(inst))
+    {
+        constantIndex = loadConstant->Index();
+    }
+    else if (LoadConstantSInst* loadConstant = dynamic_cast<LoadConstantSInst*>(inst))
+    {
+        constantIndex = loadConstant->Index();
+    }
+    if (constantIndex != -1)
+    {
+        return constantPool.GetConstant(ConstantId(constantIndex)).Value().GetType() != ValueType::stringLiteral;
+    }
+    return dynamic_cast<LoadDefaultValueBaseInst*>(inst) || dynamic_cast<UnaryOpBaseInst*>(inst) || dynamic_cast<BinaryOpBaseInst*>(inst) || 
+        dynamic_cast<BinaryPredBaseInst*>(inst) || dynamic_cast<LogicalNotInst*>(inst) || dynamic_cast<ConversionBaseInst*>(inst) || 
+        dynamic_cast<DupInst*>(inst) || dynamic_cast<SwapInst*>(inst) || dynamic_cast<RotateInst*>(inst) || dynamic_cast<PopInst*>(inst);
+}
+
+void GetJumpTargets(Instruction* inst, std::vector<int32_t>& targets)
+{
+    if (inst->IsJumpingInst())
+    {
+        targets.push_back(static_cast<IndexParamInst*>(inst)->Index());
+    }
+    else if (inst->IsContinuousSwitchInst())
+    {
+        ContinuousSwitchInst* cswitch = static_cast<ContinuousSwitchInst*>(inst);
+        targets.insert(targets.end(), cswitch->Targets().cbegin(), cswitch->Targets().cend());
+        targets.push_back(cswitch->DefaultTarget());
+    }
+    else if (inst->IsBinarySearchSwitchInst())
+    {
+        BinarySearchSwitchInst* bswitch = static_cast<BinarySearchSwitchInst*>(inst);
+        for (const auto& t : bswitch->Targets())
+        {
+            targets.push_back(t.second);
+        }
+        targets.push_back(bswitch->DefaultTarget());
+    }
+}
+
+//  Finds array element accesses that cannot fail in loops of the form 'for (int i = 0; i < a.Length; ++i) { ... a[i] ... }' where i and a are local variables.
+//  The loop is recognized from the instructions generated for it:
+//
+//      load 0, C-1: storelocal i, C: loadlocal i, loadlocal a, call Length getter, less, jumptrue C+6, jump EXIT, 
+//      C+6: ...body..., loadlocal i, load 1, add, s: storelocal i, ..., J: jump C
+//
+//  where the constants 0 and 1 are either int constants or sbyte constants converted to int.
+//
+//  i stays between zero and a.Length - 1 in the body before the increment provided that the loop is entered only through the initialization, 
+//  i is stored only by the increment, a is not stored at all in the loop, and neither of them is accessed through a variable reference.
+//  The Length getter fails on a null array before the body is entered, so the accesses need neither a null check nor a bounds check.
+//
+//  If the loop is also call-free, the Length getter is called once before the loop and the pointer to the elements of a is loaded once after 
+//  it. The condition compares i with the saved length and the unchecked accesses use the saved pointer. The gcpoll of the loop is left out, 
+//  like the safepoint of a counted loop in HotSpot: the loop runs at most a.Length times, and without a safepoint the garbage collector cannot 
+//  move the elements while the loop runs. The loop body then consists of plain loads, stores and arithmetic that the loop vectorizer of 
+//  OptimizeModule can vectorize.
+
+void NativeCompilerImpl::FindUncheckedElemAccesses(Function& function)
+{
+    int32_t n = function.NumInsts();
+    std::unordered_set<int32_t> referencedLocals;
+    std::vector<std::vector<int32_t>> targets(n);
+    for (int32_t k = 0; k < n; ++k)
+    {
+        Instruction* inst = function.GetInst(k);
+        if (CreateLocalVariableReferenceInst* createReference = dynamic_cast<CreateLocalVariableReferenceInst*>(inst))
+        {
+            referencedLocals.insert(createReference->LocalIndex());
+        }
+        GetJumpTargets(inst, targets[k]);
+    }
+    for (int32_t j = 0; j < n; ++j)
+    {
+        Instruction* jump = function.GetInst(j);
+        if (!jump->IsJump()) continue;
+        int32_t c = static_cast<JumpInst*>(jump)->Index();
+        if (c < 2 || c + 6 > j) continue;
+        int32_t i = GetLoadLocalIndex(function.GetInst(c));
+        int32_t a = GetLoadLocalIndex(function.GetInst(c + 1));
+        if (i == -1 || a == -1 || i == a) continue;
+        if (referencedLocals.find(i) != referencedLocals.cend() || referencedLocals.find(a) != referencedLocals.cend()) continue;
+        if (GetStoreLocalIndex(function.GetInst(c - 1)) != i || IntConstantLength(function, c - 2, 0) == 0) continue;
+        if (!IsArrayLengthCall(function.GetInst(c + 2)) || !IsIntInst(function.GetInst(c + 3), "less")) continue;
+        Instruction* jumpTrue = function.GetInst(c + 4);
+        Instruction* jumpExit = function.GetInst(c + 5);
+        if (!dynamic_cast<JumpTrueInst*>(jumpTrue) || static_cast<JumpTrueInst*>(jumpTrue)->Index() != c + 6) continue;
+        if (!jumpExit->IsJump()) continue;
+        int32_t exit = static_cast<JumpInst*>(jumpExit)->Index();
+        if (exit != endOfFunction && exit >= c && exit <= j) continue;
+        bool canonical = true;
+        int32_t s = -1;
+        int32_t increment = -1;
+        for (int32_t k = c; k <= j && canonical; ++k)
+        {
+            Instruction* inst = function.GetInst(k);
+            if (inst->IsEhBlockInst() || inst->IsEndEhInst() || dynamic_cast<BeginTryInst*>(inst))
+            {
+                canonical = false;
+            }
+            int32_t storeIndex = GetStoreLocalIndex(inst);
+            if (storeIndex == a)
+            {
+                canonical = false;
+            }
+            else if (storeIndex == i)
+            {
+                int32_t oneLength = IntConstantLength(function, k - 2, 1);
+                increment = k - 2 - oneLength;
+                if (s != -1 || oneLength == 0 || increment < c + 6 || GetLoadLocalIndex(function.GetInst(increment)) != i || !IsIntInst(function.GetInst(k - 1), "add"))
+                {
+                    canonical = false;
+                }
+                s = k;
+            }
+        }
+        if (!canonical || s == -1) continue;
+        for (int32_t k = 0; k < n && canonical; ++k)
+        {
+            bool inLoop = k >= c && k <= j;
+            for (int32_t target : targets[k])
+            {
+                if (!inLoop && target >= c && target <= j)
+                {
+                    canonical = false;
+                }
+                else if (inLoop && k != j && k > s && target <= s && target > c)
+                {
+                    canonical = false;
+                }
+            }
+        }
+        if (!canonical) continue;
+        CallFreeArrayLoop* callFreeLoop = nullptr;
+        int32_t gcPoll = -1;
+        if (IsCallFreeLoop(function, c, j, gcPoll))
+        {
+            callFreeArrayLoops.push_back(std::unique_ptr<CallFreeArrayLoop>(new CallFreeArrayLoop(function.GetInst(c + 2), a)));
+            callFreeLoop = callFreeArrayLoops.back().get();
+            callFreeArrayLoopHeaders[function.GetInst(c)] = callFreeLoop;
+            callFreeArrayLoopMap[function.GetInst(c + 2)] = callFreeLoop;
+            callFreeArrayLoopMap[function.GetInst(gcPoll)] = callFreeLoop;
+        }
+        for (int32_t k = c + 8; k < increment; ++k)
+        {
+            Instruction* inst = function.GetInst(k);
+            if ((dynamic_cast<LoadElemInst*>(inst) || dynamic_cast<StoreElemInst*>(inst)) && 
+                GetLoadLocalIndex(function.GetInst(k - 2)) == a && GetLoadLocalIndex(function.GetInst(k - 1)) == i)
+            {
+                uncheckedElemAccesses.insert(inst);
+                if (callFreeLoop)
+                {
+                    callFreeArrayLoopMap[inst] = callFreeLoop;
+                }
+            }
+        }
+    }
+}
+
+//  A canonical loop is call-free when its instructions other than the Length getter call and exactly one gcpoll only access locals, constants, 
+//  array elements of an inline access type and values on the stack, and all its jumps other than the jump back to the condition go forward.
+
+bool NativeCompilerImpl::IsCallFreeLoop(Function& function, int32_t c, int32_t j, int32_t& gcPoll) const
+{
+    if (arrayElementsFieldOffset == -1) return false;
+    gcPoll = -1;
+    for (int32_t k = c; k < j; ++k)
+    {
+        if (k == c + 2) continue;
+        Instruction* inst = function.GetInst(k);
+        if (dynamic_cast<GcPollInst*>(inst))
+        {
+            if (gcPoll != -1) return false;
+            gcPoll = k;
+        }
+        else if (inst->IsJumpingInst())
+        {
+            int32_t target = static_cast<IndexParamInst*>(inst)->Index();
+            if (target != endOfFunction && target <= k) return false;
+        }
+        else if (LoadElemInst* loadElem = dynamic_cast<LoadElemInst*>(inst))
+        {
+            if (!IsInlineAccessType(loadElem->GetElemType())) return false;
+        }
+        else if (StoreElemInst* storeElem = dynamic_cast<StoreElemInst*>(inst))
+        {
+            if (!IsInlineAccessType(storeElem->GetElemType())) return false;
+        }
+        else if (GetLoadLocalIndex(inst) == -1 && GetStoreLocalIndex(inst) == -1 && !IsCallFreeValueInst(inst, function.GetConstantPool()))
+        {
+            return false;
+        }
+    }
+    return gcPoll != -1;
+}
+
+//  Called when the header of a call-free loop is entered from the initialization. A null array throws from the Length getter here, where the 
+//  first evaluation of the condition would have thrown. The elements pointer is loaded after the call, which is the last safepoint before the loop.
+
+void NativeCompilerImpl::HoistArrayLoopInvariants(CallFreeArrayLoop& loop)
+{
+    CallInst* lengthCall = static_cast<CallInst*>(loop.lengthCall);
+    llvm::Value* arr = builder.CreateLoad(locals[loop.arrayLocalIndex]);
+    ArgVector args;
+    args.push_back(arr);
+    SetCurrentLineNumber(function->GetSourceLine(GetCurrentInstructionIndex()));
+    CreateCall(GetDirectCallee(lengthCall->GetFunction()), args, true);
+    loop.length = valueStack.Pop();
+    llvm::Value* arrayObject = CreateLoadAllocation(arr);
+    llvm::Value* elementsHandle = CreateLoadFromMemory(CreateMemberPtr(arrayObject, arrayElementsFieldOffset, ValueType::ulongType), ValueType::ulongType);
+    loop.elements = CreateLoadAllocation(elementsHandle);
+}
+
 void NativeCompilerImpl::ScanForInlineCandidates(Function& function)
 {
     std::vector<Function*> inlineCandidates;
@@ -1459,6 +2339,24 @@ void NativeCompilerImpl::ScanForInlineCandidates(Function& function)
                 inlineCandidates.push_back(calledFunction);
             }
         }
+        else if (VirtualCallInst* virtualCallInst = dynamic_cast<VirtualCallInst*>(inst))
+        {
+            ClassTypeSymbol* guardClass = nullptr;
+            Function* target = GetVirtualCallTarget(*virtualCallInst, guardClass);
+            if (target && inlinedFunctions.find(target) == inlinedFunctions.cend())
+            {
+                inlineCandidates.push_back(target);
+            }
+        }
+        else if (InterfaceCallInst* interfaceCallInst = dynamic_cast<InterfaceCallInst*>(inst))
+        {
+            int32_t receiverFieldOffset = -1;
+            Function* target = GetInterfaceCallTarget(*interfaceCallInst, receiverFieldOffset);
+            if (target && inlinedFunctions.find(target) == inlinedFunctions.cend())
+            {
+                inlineCandidates.push_back(target);
+            }
+        }
     }
     inlineCandidates.erase(std::unique(inlineCandidates.begin(), inlineCandidates.end()), inlineCandidates.end());
     int nc = int(inlineCandidates.size());
@@ -1521,6 +2419,12 @@ void NativeCompilerImpl::BeginVisitFunction(Function& function)
         formatter.WriteLine("before removing unreachable instructions:");
         function.Dump(formatter);
     }
+    functionProfile = nullptr;
+    if (executionProfile)
+    {
+        functionProfile = GetFunctionProfile(function);
+        IndexProfiledInstructions(function);
+    }
     function.RemoveUnreachableInstructions(jumpTargets);
     if (listStream)
     {
@@ -1528,6 +2432,24 @@ void NativeCompilerImpl::BeginVisitFunction(Function& function)
         formatter.WriteLine("after removing unreachable instructions:");
         function.Dump(formatter);
     }
+    uncheckedElemAccesses.clear();
+    callFreeArrayLoops.clear();
+    callFreeArrayLoopHeaders.clear();
+    callFreeArrayLoopMap.clear();
+    if (optimizationLevel > 0)
+    {
+        FindUncheckedElemAccesses(function);
+        if (listStream && !uncheckedElemAccesses.empty())
+        {
+            CodeFormatter formatter(*listStream);
+            formatter.WriteLine("unchecked array element accesses: " + std::to_string(uncheckedElemAccesses.size()));
+        }
+        if (listStream && !callFreeArrayLoops.empty())
+        {
+            CodeFormatter formatter(*listStream);
+            formatter.WriteLine("call-free array loops: " + std::to_string(callFreeArrayLoops.size()));
+        }
+    }
     llvm::Type* returnType = GetType(function.ReturnType());
     std::vector<llvm::Type*> paramTypes;
     for (ValueType pvt : function.ParameterTypes())
@@ -1573,7 +2495,14 @@ void NativeCompilerImpl::BeginVisitFunction(Function& function)
     }
     else if (mode == Mode::inlineMode)
     {
-        fun->setLinkage(llvm::GlobalValue::LinkageTypes::LinkOnceODRLinkage);
+        if (wholeProgram && function.GetAssembly() != assembly)
+        {
+            fun->setLinkage(llvm::GlobalValue::LinkageTypes::InternalLinkage);
+        }
+        else
+        {
+            fun->setLinkage(llvm::GlobalValue::LinkageTypes::LinkOnceODRLinkage);
+        }
         if (function.HasExceptionBlocks() || function.CanThrow())
         {
             fun->setAttributes(unwindInlineFunctionAttributes);
@@ -1589,6 +2518,10 @@ void NativeCompilerImpl::BeginVisitFunction(Function& function)
     {
         Assert(false, "unknown mode");
     }
+    if (executionProfile)
+    {
+        ApplyFunctionProfile();
+    }
     if (function.HasExceptionBlocks())
     {
         SetPersonalityFunction();
@@ -1644,11 +2577,32 @@ void NativeCompilerImpl::BeginVisitFunction(Function& function)
 #else
     functionStackEntry = nullptr;
 #endif
+    allocationContext = nullptr;
+    if (AllocatesObjects(function))
+    {
+        llvm::Function* rtGetAllocationContext = cast<llvm::Function>(module->getOrInsertFunction("RtGetAllocationContext", 
+            PointerType::get(GetType(ValueType::byteType), 0), nullptr));
+        ImportFunction(rtGetAllocationContext);
+        allocationContext = builder.CreateCall(rtGetAllocationContext);
+    }
     functionConstantPool = &function.GetConstantPool();
     currentBasicBlock = entryBlock;
     functionPtrVar = GetFunctionPtrVar(&function);
 }
 
+bool NativeCompilerImpl::AllocatesObjects(Function& function) const
+{
+    int n = function.NumInsts();
+    for (int i = 0; i < n; ++i)
+    {
+        if (dynamic_cast<CreateObjectInst*>(function.GetInst(i)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 void NativeCompilerImpl::EndVisitFunction(Function& function)
 {
     bool lastIsJumpOrThrow = false;
@@ -1694,6 +2648,11 @@ void NativeCompilerImpl::EndVisitFunction(Function& function)
 
 void NativeCompilerImpl::BeginVisitInstruction(int instructionNumber, bool prevEndsBasicBlock, Instruction* inst)
 {
+    auto hit = callFreeArrayLoopHeaders.find(inst);
+    if (hit != callFreeArrayLoopHeaders.cend() && !prevEndsBasicBlock && currentBasicBlock)
+    {
+        HoistArrayLoopInvariants(*hit->second);
+    }
     auto it = basicBlocks.find(instructionNumber);
     if (it != basicBlocks.cend())
     {
@@ -1909,31 +2868,178 @@ void NativeCompilerImpl::VisitBinaryPredBaseInst(BinaryPredBaseInst& instruction
             }
         }
     }
-    else
+    else
+    {
+        throw std::runtime_error("NativeCompiler: binary predicate operation not found");
+    }
+}
+
+void NativeCompilerImpl::VisitLogicalNotInst(LogicalNotInst& instruction)
+{
+    valueStack.Push(builder.CreateNot(valueStack.Pop()));
+}
+
+void NativeCompilerImpl::VisitLoadLocalInst(int32_t localIndex)
+{
+    valueStack.Push(builder.CreateLoad(locals[localIndex]));
+}
+
+void NativeCompilerImpl::VisitStoreLocalInst(int32_t localIndex)
+{
+    llvm::Value* value = valueStack.Pop();
+    builder.CreateStore(value, locals[localIndex]);
+}
+
+bool NativeCompilerImpl::IsInlineAccessType(ValueType type) const
+{
+    switch (type)
+    {
+        case ValueType::boolType: case ValueType::sbyteType: case ValueType::byteType: case ValueType::shortType: case ValueType::ushortType: case ValueType::intType: 
+        case ValueType::uintType: case ValueType::longType: case ValueType::ulongType: case ValueType::floatType: case ValueType::doubleType: case ValueType::charType:
+        case ValueType::objectReference:
+        {
+            return true;
+        }
+        default:
+        {
+            return false;
+        }
+    }
+}
+
+llvm::Type* NativeCompilerImpl::GetMemoryType(ValueType type)
+{
+    if (type == ValueType::boolType)
+    {
+        return GetType(ValueType::byteType);
+    }
+    return GetType(type);
+}
+
+llvm::Value* NativeCompilerImpl::CreateLoadAllocation(llvm::Value* handle)
+{
+    llvm::Value* allocationTable = builder.CreateBitCast(builder.CreateLoad(allocationTableVariable), 
+        PointerType::get(PointerType::get(GetType(ValueType::byteType), 0), 0));
+    llvm::Value* handleValue = handle;
+    if (handle->getType()->isPointerTy())
+    {
+        handleValue = builder.CreatePtrToInt(handle, GetType(ValueType::ulongType));
+    }
+    llvm::Value* allocationPtr = builder.CreateGEP(allocationTable, handleValue);
+    return builder.CreateLoad(allocationPtr);
+}
+
+llvm::Value* NativeCompilerImpl::CreateLoadObject(llvm::Value* objectReference, llvm::BasicBlock* nullReferenceBlock)
+{
+    llvm::BasicBlock* notNullBlock = BasicBlock::Create(context, "notNull" + std::to_string(GetCurrentInstructionIndex()), fun);
+    llvm::Value* isNull = builder.CreateICmpEQ(objectReference, llvm::Constant::getNullValue(GetType(ValueType::objectReference)));
+    builder.CreateCondBr(isNull, nullReferenceBlock, notNullBlock);
+    currentBasicBlock = notNullBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    return CreateLoadAllocation(objectReference);
+}
+
+llvm::Value* NativeCompilerImpl::CreateMemberPtr(llvm::Value* allocation, int64_t offset, ValueType memberType)
+{
+    llvm::Value* memberBytePtr = builder.CreateGEP(allocation, builder.getInt64(offset));
+    return builder.CreateBitCast(memberBytePtr, PointerType::get(GetMemoryType(memberType), 0));
+}
+
+//  When failureBlock is null the array is known to be non-null and the index in range, so no checks are generated.
+
+llvm::Value* NativeCompilerImpl::CreateArrayElementPtr(llvm::Value* arr, llvm::Value* index, ValueType elemType, llvm::BasicBlock* failureBlock)
+{
+    if (!failureBlock)
     {
-        throw std::runtime_error("NativeCompiler: binary predicate operation not found");
+        llvm::Value* arrayObject = CreateLoadAllocation(arr);
+        llvm::Value* elementsHandle = CreateLoadFromMemory(CreateMemberPtr(arrayObject, arrayElementsFieldOffset, ValueType::ulongType), ValueType::ulongType);
+        llvm::Value* elementArray = builder.CreateBitCast(CreateLoadAllocation(elementsHandle), PointerType::get(GetMemoryType(elemType), 0));
+        return builder.CreateGEP(elementArray, index);
     }
+    llvm::Value* arrayObject = CreateLoadObject(arr, failureBlock);
+    llvm::Value* elementsHandle = CreateLoadFromMemory(CreateMemberPtr(arrayObject, arrayElementsFieldOffset, ValueType::ulongType), ValueType::ulongType);
+    llvm::Value* elements = CreateLoadAllocation(elementsHandle);
+    llvm::Value* numElements = CreateLoadFromMemory(CreateMemberPtr(elements, NumArrayElementsOffset(), ValueType::intType), ValueType::intType);
+    llvm::BasicBlock* inRangeBlock = BasicBlock::Create(context, "inRange" + std::to_string(GetCurrentInstructionIndex()), fun);
+    llvm::Value* inRange = builder.CreateICmpULT(index, numElements);
+    builder.CreateCondBr(inRange, inRangeBlock, failureBlock);
+    currentBasicBlock = inRangeBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    llvm::Value* elementArray = builder.CreateBitCast(elements, PointerType::get(GetMemoryType(elemType), 0));
+    return builder.CreateGEP(elementArray, index);
 }
 
-void NativeCompilerImpl::VisitLogicalNotInst(LogicalNotInst& instruction)
+//  Object layouts are packed and allocations are not aligned, so memory is accessed with byte alignment.
+
+llvm::Value* NativeCompilerImpl::CreateLoadFromMemory(llvm::Value* ptr, ValueType type)
 {
-    valueStack.Push(builder.CreateNot(valueStack.Pop()));
+    llvm::Value* value = builder.CreateAlignedLoad(ptr, 1);
+    if (type == ValueType::boolType)
+    {
+        return builder.CreateICmpNE(value, builder.getInt8(0));
+    }
+    return value;
 }
 
-void NativeCompilerImpl::VisitLoadLocalInst(int32_t localIndex)
+void NativeCompilerImpl::CreateStoreToMemory(llvm::Value* value, llvm::Value* ptr, ValueType type)
 {
-    valueStack.Push(builder.CreateLoad(locals[localIndex]));
+    if (type == ValueType::boolType)
+    {
+        value = builder.CreateZExt(value, GetType(ValueType::byteType));
+    }
+    builder.CreateAlignedStore(value, ptr, 1);
 }
 
-void NativeCompilerImpl::VisitStoreLocalInst(int32_t localIndex)
+//  The field is accessed directly in the object using the offset the compiler has computed from the layout of the class.
+//  A null object reference branches to a call to the runtime that throws the NullReferenceException.
+
+void NativeCompilerImpl::VisitLoadFieldInst(int32_t fieldIndex, int32_t fieldOffset, ValueType fieldType)
 {
-    llvm::Value* value = valueStack.Pop();
-    builder.CreateStore(value, locals[localIndex]);
+    llvm::Value* objectReference = valueStack.Pop();
+    if (fieldOffset == -1 || !IsInlineAccessType(fieldType))
+    {
+        CreateLoadFieldCall(objectReference, fieldIndex, fieldType);
+        return;
+    }
+    llvm::BasicBlock* nullReferenceBlock = BasicBlock::Create(context, "nullReference" + std::to_string(GetCurrentInstructionIndex()), fun);
+    llvm::Value* object = CreateLoadObject(objectReference, nullReferenceBlock);
+    llvm::Value* fieldValue = CreateLoadFromMemory(CreateMemberPtr(object, fieldOffset, fieldType), fieldType);
+    llvm::BasicBlock* continueBlock = BasicBlock::Create(context, "continueTarget" + std::to_string(GetCurrentInstructionIndex()), fun);
+    builder.CreateBr(continueBlock);
+    currentBasicBlock = nullReferenceBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    CreateLoadFieldCall(objectReference, fieldIndex, fieldType);
+    valueStack.Pop();
+    builder.CreateUnreachable();
+    currentBasicBlock = continueBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    valueStack.Push(fieldValue);
 }
 
-void NativeCompilerImpl::VisitLoadFieldInst(int32_t fieldIndex, ValueType fieldType)
+void NativeCompilerImpl::VisitStoreFieldInst(int32_t fieldIndex, int32_t fieldOffset, ValueType fieldType)
 {
     llvm::Value* objectReference = valueStack.Pop();
+    llvm::Value* fieldValue = valueStack.Pop();
+    if (fieldOffset == -1 || !IsInlineAccessType(fieldType))
+    {
+        CreateStoreFieldCall(objectReference, fieldValue, fieldIndex, fieldType);
+        return;
+    }
+    llvm::BasicBlock* nullReferenceBlock = BasicBlock::Create(context, "nullReference" + std::to_string(GetCurrentInstructionIndex()), fun);
+    llvm::Value* object = CreateLoadObject(objectReference, nullReferenceBlock);
+    CreateStoreToMemory(fieldValue, CreateMemberPtr(object, fieldOffset, fieldType), fieldType);
+    llvm::BasicBlock* continueBlock = BasicBlock::Create(context, "continueTarget" + std::to_string(GetCurrentInstructionIndex()), fun);
+    builder.CreateBr(continueBlock);
+    currentBasicBlock = nullReferenceBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    CreateStoreFieldCall(objectReference, fieldValue, fieldIndex, fieldType);
+    builder.CreateUnreachable();
+    currentBasicBlock = continueBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+}
+
+void NativeCompilerImpl::CreateLoadFieldCall(llvm::Value* objectReference, int32_t fieldIndex, ValueType fieldType)
+{
     ArgVector args;
     args.push_back(objectReference);
     llvm::Value* index = builder.getInt32(fieldIndex);
@@ -2028,10 +3134,8 @@ void NativeCompilerImpl::VisitLoadFieldInst(int32_t fieldIndex, ValueType fieldT
     CreateCall(callee, args, true);
 }
 
-void NativeCompilerImpl::VisitStoreFieldInst(int32_t fieldIndex, ValueType fieldType)
+void NativeCompilerImpl::CreateStoreFieldCall(llvm::Value* objectReference, llvm::Value* fieldValue, int32_t fieldIndex, ValueType fieldType)
 {
-    llvm::Value* objectReference = valueStack.Pop();
-    llvm::Value* fieldValue = valueStack.Pop();
     ArgVector args;
     args.push_back(objectReference);
     args.push_back(fieldValue);
@@ -2127,15 +3231,86 @@ void NativeCompilerImpl::VisitStoreFieldInst(int32_t fieldIndex, ValueType field
     CreateCall(callee, args, false);
 }
 
+//  The element is accessed directly in the array elements allocation after checking the index against the number of elements.
+//  A null array or an index out of range branches to a call to the runtime that throws the exception.
+//  Accesses found by FindUncheckedElemAccesses cannot fail and are generated without the checks. In a call-free loop they use the elements 
+//  pointer loaded before the loop.
+
+llvm::Value* NativeCompilerImpl::CreateUncheckedElementPtr(Instruction& access, llvm::Value* arr, llvm::Value* index, ValueType elemType)
+{
+    auto it = callFreeArrayLoopMap.find(&access);
+    if (it != callFreeArrayLoopMap.cend() && it->second->elements)
+    {
+        llvm::Value* elementArray = builder.CreateBitCast(it->second->elements, PointerType::get(GetMemoryType(elemType), 0));
+        return builder.CreateGEP(elementArray, index);
+    }
+    return CreateArrayElementPtr(arr, index, elemType, nullptr);
+}
+
 void NativeCompilerImpl::VisitLoadElemInst(LoadElemInst& instruction)
 {
     llvm::Value* index = valueStack.Pop();
     llvm::Value* arr = valueStack.Pop();
+    ValueType elemType = instruction.GetElemType();
+    if (arrayElementsFieldOffset == -1 || !IsInlineAccessType(elemType))
+    {
+        CreateLoadElemCall(arr, index, elemType);
+        return;
+    }
+    if (uncheckedElemAccesses.find(&instruction) != uncheckedElemAccesses.cend())
+    {
+        valueStack.Push(CreateLoadFromMemory(CreateUncheckedElementPtr(instruction, arr, index, elemType), elemType));
+        return;
+    }
+    llvm::BasicBlock* failureBlock = BasicBlock::Create(context, "elementAccessFailed" + std::to_string(GetCurrentInstructionIndex()), fun);
+    llvm::Value* elementValue = CreateLoadFromMemory(CreateArrayElementPtr(arr, index, elemType, failureBlock), elemType);
+    llvm::BasicBlock* continueBlock = BasicBlock::Create(context, "continueTarget" + std::to_string(GetCurrentInstructionIndex()), fun);
+    builder.CreateBr(continueBlock);
+    currentBasicBlock = failureBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    CreateLoadElemCall(arr, index, elemType);
+    valueStack.Pop();
+    builder.CreateUnreachable();
+    currentBasicBlock = continueBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    valueStack.Push(elementValue);
+}
+
+void NativeCompilerImpl::VisitStoreElemInst(StoreElemInst& instruction)
+{
+    llvm::Value* index = valueStack.Pop();
+    llvm::Value* arr = valueStack.Pop();
+    llvm::Value* elementValue = valueStack.Pop();
+    ValueType elemType = instruction.GetElemType();
+    if (arrayElementsFieldOffset == -1 || !IsInlineAccessType(elemType))
+    {
+        CreateStoreElemCall(arr, elementValue, index, elemType);
+        return;
+    }
+    if (uncheckedElemAccesses.find(&instruction) != uncheckedElemAccesses.cend())
+    {
+        CreateStoreToMemory(elementValue, CreateUncheckedElementPtr(instruction, arr, index, elemType), elemType);
+        return;
+    }
+    llvm::BasicBlock* failureBlock = BasicBlock::Create(context, "elementAccessFailed" + std::to_string(GetCurrentInstructionIndex()), fun);
+    CreateStoreToMemory(elementValue, CreateArrayElementPtr(arr, index, elemType, failureBlock), elemType);
+    llvm::BasicBlock* continueBlock = BasicBlock::Create(context, "continueTarget" + std::to_string(GetCurrentInstructionIndex()), fun);
+    builder.CreateBr(continueBlock);
+    currentBasicBlock = failureBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    CreateStoreElemCall(arr, elementValue, index, elemType);
+    builder.CreateUnreachable();
+    currentBasicBlock = continueBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+}
+
+void NativeCompilerImpl::CreateLoadElemCall(llvm::Value* arr, llvm::Value* index, ValueType elemType)
+{
     ArgVector args;
     args.push_back(arr);
     args.push_back(index);
     llvm::Function* callee = nullptr;
-    switch (instruction.GetElemType())
+    switch (elemType)
     {
         case ValueType::sbyteType:
         {
@@ -2224,17 +3399,14 @@ void NativeCompilerImpl::VisitLoadElemInst(LoadElemInst& instruction)
     CreateCall(callee, args, true);
 }
 
-void NativeCompilerImpl::VisitStoreElemInst(StoreElemInst& instruction)
+void NativeCompilerImpl::CreateStoreElemCall(llvm::Value* arr, llvm::Value* elementValue, llvm::Value* index, ValueType elemType)
 {
-    llvm::Value* index = valueStack.Pop();
-    llvm::Value* arr = valueStack.Pop();
-    llvm::Value* elementValue = valueStack.Pop();
     ArgVector args;
     args.push_back(arr);
     args.push_back(elementValue);
     args.push_back(index);
     llvm::Function* callee = nullptr;
-    switch (instruction.GetElemType())
+    switch (elemType)
     {
         case ValueType::sbyteType:
         {
@@ -2624,7 +3796,7 @@ void NativeCompilerImpl::VisitJumpTrueInst(JumpTrueInst& instruction)
     }
     BasicBlock* continueBlock = BasicBlock::Create(context, "continueTarget" + std::to_string(GetCurrentInstructionIndex()), fun);
     llvm::Value* cond = valueStack.Pop();
-    builder.CreateCondBr(cond, trueTargetBlock, continueBlock);
+    builder.CreateCondBr(cond, trueTargetBlock, continueBlock, GetJumpWeights(instruction, true));
     currentBasicBlock = continueBlock;
     builder.SetInsertPoint(currentBasicBlock);
 }
@@ -2645,7 +3817,7 @@ void NativeCompilerImpl::VisitJumpFalseInst(JumpFalseInst& instruction)
     }
     BasicBlock* continueBlock = BasicBlock::Create(context, "continueTarget" + std::to_string(GetCurrentInstructionIndex()), fun);
     llvm::Value* cond = valueStack.Pop();
-    builder.CreateCondBr(cond, continueBlock, falseTargetBlock);
+    builder.CreateCondBr(cond, continueBlock, falseTargetBlock, GetJumpWeights(instruction, false));
     currentBasicBlock = continueBlock;
     builder.SetInsertPoint(currentBasicBlock);
 }
@@ -2670,6 +3842,7 @@ void NativeCompilerImpl::VisitContinuousSwitchInst(ContinuousSwitchInst& instruc
     int n = int(instruction.Targets().size());
     Assert(n == end.Value() - begin.Value() + 1, "invalid switch range");
     SwitchInst* switchInst = builder.CreateSwitch(cond, defaultBlock, n);
+    std::vector<bool> caseAdded;
     for (int i = 0; i < n; ++i)
     {
         int32_t target = instruction.Targets()[i];
@@ -2679,6 +3852,11 @@ void NativeCompilerImpl::VisitContinuousSwitchInst(ContinuousSwitchInst& instruc
             basicBlocks[target] = targetBlock;
             switchInst->addCase(GetConstantInt(condType, MakeIntegralValue<uint64_t>(begin.Value() + i, begin.GetType())), targetBlock);
         }
+        caseAdded.push_back(target != defaultTarget);
+    }
+    if (llvm::MDNode* switchWeights = GetSwitchWeights(instruction, caseAdded))
+    {
+        switchInst->setMetadata(LLVMContext::MD_prof, switchWeights);
     }
     if (defaultTarget == endOfFunction)
     {
@@ -2718,6 +3896,10 @@ void NativeCompilerImpl::VisitBinarySearchSwitchInst(BinarySearchSwitchInst& ins
         basicBlocks[target] = targetBlock;
         switchInst->addCase(GetConstantInt(condType, caseValue), targetBlock);
     }
+    if (llvm::MDNode* switchWeights = GetSwitchWeights(instruction, std::vector<bool>(n, true)))
+    {
+        switchInst->setMetadata(LLVMContext::MD_prof, switchWeights);
+    }
     if (defaultTarget == endOfFunction)
     {
         currentBasicBlock = defaultBlock;
@@ -2730,9 +3912,8 @@ void NativeCompilerImpl::VisitBinarySearchSwitchInst(BinarySearchSwitchInst& ins
     }
 }
 
-void NativeCompilerImpl::VisitCallInst(CallInst& instruction)
+llvm::Function* NativeCompilerImpl::GetDirectCallee(Function* calledFunction)
 {
-    Function* calledFunction = instruction.GetFunction();
     llvm::Type* returnType = GetType(calledFunction->ReturnType());
     std::vector<llvm::Type*> paramTypes;
     for (ValueType pvt : calledFunction->ParameterTypes())
@@ -2768,8 +3949,22 @@ void NativeCompilerImpl::VisitCallInst(CallInst& instruction)
             ImportFunction(callee);
         }
     }
+    return callee;
+}
+
+void NativeCompilerImpl::VisitCallInst(CallInst& instruction)
+{
+    auto it = callFreeArrayLoopMap.find(&instruction);
+    if (it != callFreeArrayLoopMap.cend() && it->second->length)
+    {
+        valueStack.Pop();
+        valueStack.Push(it->second->length);
+        return;
+    }
+    Function* calledFunction = instruction.GetFunction();
+    llvm::Function* callee = GetDirectCallee(calledFunction);
     ArgVector args;
-    int n = int(paramTypes.size());
+    int n = int(calledFunction->ParameterTypes().size());
     args.resize(n);
     for (int i = 0; i < n; ++i)
     {
@@ -2783,6 +3978,152 @@ void NativeCompilerImpl::VisitCallInst(CallInst& instruction)
     StoreTemporaryGcRoot(instruction);
 }
 
+//  The class hierarchy of the program is built from the class types linked when the assembly was loaded. The subclasses of a class include the class itself.
+//  If the assembly contains the main function, the linked class types are all the class types of the program. Otherwise a class may have subclasses in 
+//  assemblies that reference this one, unless the class and all its known subclasses are internal.
+
+void NativeCompilerImpl::InitClassHierarchy(Assembly& assembly)
+{
+    closedWorld = false;
+    classTypeMap.clear();
+    subclassMap.clear();
+    interfaceTypeMap.clear();
+    interfaceImplementationMap.clear();
+    for (const std::unique_ptr<Function>& machineFunction : assembly.GetMachineFunctionTable().MachineFunctions())
+    {
+        if (machineFunction->IsMain())
+        {
+            closedWorld = true;
+            break;
+        }
+    }
+    for (ClassTypeSymbol* classType : assembly.LinkedClassTypes())
+    {
+        if (classType->IsClassTemplate() || !classType->GetClassData()) continue;
+        std::u32string className = classType->FullName();
+        if (classTypeMap.find(className) != classTypeMap.cend()) continue;
+        classTypeMap[className] = classType;
+        for (ClassTypeSymbol* cls = classType; cls; cls = cls->BaseClass())
+        {
+            subclassMap[cls].push_back(classType);
+        }
+        int32_t n = int32_t(classType->ImplementedInterfaces().size());
+        for (int32_t i = 0; i < n; ++i)
+        {
+            InterfaceTypeSymbol* intf = classType->ImplementedInterfaces()[i];
+            interfaceTypeMap[intf->FullName()] = intf;
+            interfaceImplementationMap[intf].push_back(std::make_pair(classType, i));
+        }
+    }
+}
+
+//  Returns the function a virtual call resolves to when all the concrete subclasses of the static class of the receiver agree on it. When they do not 
+//  but the static class itself is concrete, returns its function and sets guardClass: the call is direct when the receiver is exactly of that class.
+
+Function* NativeCompilerImpl::GetVirtualCallTarget(VirtualCallInst& instruction, ClassTypeSymbol*& guardClass)
+{
+    guardClass = nullptr;
+    auto it = classTypeMap.find(instruction.GetClassName().Value());
+    if (it == classTypeMap.cend()) return nullptr;
+    ClassTypeSymbol* classType = it->second;
+    auto sit = subclassMap.find(classType);
+    if (sit == subclassMap.cend()) return nullptr;
+    const std::vector<ClassTypeSymbol*>& subclasses = sit->second;
+    uint32_t vmtIndex = instruction.VmtIndex();
+    std::vector<Function*> targets;
+    for (ClassTypeSymbol* subclass : subclasses)
+    {
+        if (!closedWorld && (subclass->Access() != SymbolAccess::internal_ || subclass->GetSymbolType() == SymbolType::classTemplateSpecializationSymbol)) return nullptr;
+        if (subclass->IsAbstract()) continue;
+        MethodTable& vmt = subclass->GetClassData()->Vmt();
+        if (int32_t(vmtIndex) >= vmt.Count()) return nullptr;
+        Function* method = vmt.GetMethod(vmtIndex);
+        if (!method) return nullptr;
+        if (std::find(targets.cbegin(), targets.cend(), method) == targets.cend())
+        {
+            targets.push_back(method);
+        }
+    }
+    if (targets.size() == 1)
+    {
+        return targets.front();
+    }
+    if (targets.size() > 1 && !classType->IsAbstract())
+    {
+        guardClass = classType;
+        return classType->GetClassData()->Vmt().GetMethod(vmtIndex);
+    }
+    return nullptr;
+}
+
+//  An interface object holds the receiver and the index of the interface in the interface method tables of the class of the receiver. When none of the 
+//  classes that implement the interface has subclasses, the class of the receiver is one of them, so if they all implement the method with the same 
+//  function, the call can be made directly.
+
+Function* NativeCompilerImpl::GetInterfaceCallTarget(InterfaceCallInst& instruction, int32_t& receiverFieldOffset)
+{
+    if (!closedWorld) return nullptr;
+    auto it = interfaceTypeMap.find(instruction.GetInterfaceName().Value());
+    if (it == interfaceTypeMap.cend()) return nullptr;
+    InterfaceTypeSymbol* intf = it->second;
+    uint32_t imtIndex = instruction.ImtIndex();
+    Function* target = nullptr;
+    for (const std::pair<ClassTypeSymbol*, int32_t>& implementation : interfaceImplementationMap[intf])
+    {
+        ClassTypeSymbol* classType = implementation.first;
+        if (subclassMap[classType].size() != 1) return nullptr;
+        if (classType->IsAbstract()) continue;
+        MethodTable& imt = classType->GetClassData()->Imt(implementation.second);
+        if (int32_t(imtIndex) >= imt.Count()) return nullptr;
+        Function* method = imt.GetMethod(imtIndex);
+        if (!method || (target && method != target)) return nullptr;
+        target = method;
+    }
+    if (target)
+    {
+        ObjectType* interfaceObjectType = static_cast<ObjectType*>(intf->GetMachineType());
+        receiverFieldOffset = static_cast<int32_t>(interfaceObjectType->GetField(0).Offset().Value());
+    }
+    return target;
+}
+
+void NativeCompilerImpl::CreateVirtualFunctionCall(const ArgVector& args, uint32_t vmtIndex, llvm::PointerType* funPtrType, bool callReturnsValue)
+{
+    ArgVector resolveArgs;
+    resolveArgs.push_back(args[0]);
+    resolveArgs.push_back(llvm::ConstantInt::get(GetIntegerType(ValueType::uintType), vmtIndex));
+    llvm::Function* resolveVirtualFunctionCallAddress = cast<llvm::Function>(module->getOrInsertFunction("RtResolveVirtualFunctionCallAddress", 
+        PointerType::get(GetType(ValueType::byteType), 0),
+        GetType(ValueType::objectReference), GetType(ValueType::intType), 
+        nullptr));
+    ImportFunction(resolveVirtualFunctionCallAddress);
+    CreateCall(resolveVirtualFunctionCallAddress, resolveArgs, true);
+    llvm::Value* functionAddress = valueStack.Pop();
+    llvm::Value* funPtrValue = builder.CreateBitCast(functionAddress, funPtrType);
+    CreateCall(funPtrValue, args, callReturnsValue);
+}
+
+void NativeCompilerImpl::CreateInterfaceFunctionCall(ArgVector args, uint32_t imtIndex, llvm::PointerType* funPtrType, bool callReturnsValue)
+{
+    ArgVector resolveArgs;
+    resolveArgs.push_back(args[0]);
+    AllocaInst* receiver = new llvm::AllocaInst(GetType(ValueType::objectReference));
+    InsertAllocaIntoEntryBlock(receiver);
+    resolveArgs.push_back(llvm::ConstantInt::get(GetIntegerType(ValueType::uintType), imtIndex));
+    resolveArgs.push_back(receiver);
+    llvm::Function* rtResolveInterfaceCallAddress = cast<llvm::Function>(module->getOrInsertFunction("RtResolveInterfaceCallAddress", PointerType::get(GetType(ValueType::byteType), 0),
+        GetType(ValueType::objectReference), GetType(ValueType::intType), PointerType::get(GetType(ValueType::objectReference), 0), nullptr));
+    ImportFunction(rtResolveInterfaceCallAddress);
+    CreateCall(rtResolveInterfaceCallAddress, resolveArgs, true);
+    llvm::Value* functionAddress = valueStack.Pop();
+    args[0] = builder.CreateLoad(receiver);
+    llvm::Value* funPtrValue = builder.CreateBitCast(functionAddress, funPtrType);
+    CreateCall(funPtrValue, args, callReturnsValue);
+}
+
+//  A devirtualized call checks the receiver: a null receiver, or a receiver of another class than the guard class, takes the virtual call path, 
+//  which throws or calls the right function. The results of the two paths are merged.
+
 void NativeCompilerImpl::VisitVirtualCallInst(VirtualCallInst& instruction)
 {
     llvm::Type* returnType = GetType(instruction.GetFunctionType().ReturnType());
@@ -2802,22 +4143,61 @@ void NativeCompilerImpl::VisitVirtualCallInst(VirtualCallInst& instruction)
         llvm::Value* arg = valueStack.Pop();
         args[n - i - 1] = arg;
     }
-    ArgVector resolveArgs;
     uint32_t vmtIndex = instruction.VmtIndex();
-    resolveArgs.push_back(args[0]);
-    resolveArgs.push_back(llvm::ConstantInt::get(GetIntegerType(ValueType::uintType), vmtIndex));
-    llvm::Function* resolveVirtualFunctionCallAddress = cast<llvm::Function>(module->getOrInsertFunction("RtResolveVirtualFunctionCallAddress", 
-        PointerType::get(GetType(ValueType::byteType), 0),
-        GetType(ValueType::objectReference), GetType(ValueType::intType), 
-        nullptr));
-    ImportFunction(resolveVirtualFunctionCallAddress);
-    CreateCall(resolveVirtualFunctionCallAddress, resolveArgs, true);
-    llvm::Value* functionAddress = valueStack.Pop();
-    llvm::Value* funPtrValue = builder.CreateBitCast(functionAddress, funPtrType);
+    bool callReturnsValue = instruction.GetFunctionType().ReturnType() != ValueType::none;
     int32_t pc = GetCurrentInstructionIndex();
     uint32_t lineNumber = function->GetSourceLine(pc);
     SetCurrentLineNumber(lineNumber);
-    CreateCall(funPtrValue, args, instruction.GetFunctionType().ReturnType() != ValueType::none);
+    ClassTypeSymbol* guardClass = nullptr;
+    Function* target = nullptr;
+    if (optimizationLevel > 0 && currentPad == nullptr)
+    {
+        target = GetVirtualCallTarget(instruction, guardClass);
+    }
+    if (!target)
+    {
+        CreateVirtualFunctionCall(args, vmtIndex, funPtrType, callReturnsValue);
+        StoreTemporaryGcRoot(instruction);
+        return;
+    }
+    std::string instIndex = std::to_string(pc);
+    llvm::BasicBlock* directCallBlock = BasicBlock::Create(context, "directCall" + instIndex, fun);
+    llvm::BasicBlock* virtualCallBlock = BasicBlock::Create(context, "virtualCall" + instIndex, fun);
+    llvm::BasicBlock* continueBlock = BasicBlock::Create(context, "continueTarget" + instIndex, fun);
+    if (guardClass)
+    {
+        llvm::Value* receiver = CreateLoadObject(args[0], virtualCallBlock);
+        int64_t classDataFieldOffset = guardClass->GetObjectType()->GetField(0).Offset().Value();
+        llvm::Value* classDataPtr = builder.CreateAlignedLoad(CreateBytePtrMemberPtr(receiver, classDataFieldOffset), 1);
+        llvm::Value* guardClassDataPtr = builder.CreateLoad(GetClassDataPtrVar(guardClass->GetClassData()));
+        builder.CreateCondBr(builder.CreateICmpEQ(classDataPtr, guardClassDataPtr), directCallBlock, virtualCallBlock);
+    }
+    else
+    {
+        llvm::Value* isNull = builder.CreateICmpEQ(args[0], llvm::Constant::getNullValue(GetType(ValueType::objectReference)));
+        builder.CreateCondBr(isNull, virtualCallBlock, directCallBlock);
+    }
+    currentBasicBlock = directCallBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    CreateCall(GetDirectCallee(target), args, callReturnsValue);
+    llvm::Value* directCallResult = callReturnsValue ? valueStack.Pop() : nullptr;
+    llvm::BasicBlock* directCallEndBlock = currentBasicBlock;
+    builder.CreateBr(continueBlock);
+    currentBasicBlock = virtualCallBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    CreateVirtualFunctionCall(args, vmtIndex, funPtrType, callReturnsValue);
+    llvm::Value* virtualCallResult = callReturnsValue ? valueStack.Pop() : nullptr;
+    llvm::BasicBlock* virtualCallEndBlock = currentBasicBlock;
+    builder.CreateBr(continueBlock);
+    currentBasicBlock = continueBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    if (callReturnsValue)
+    {
+        llvm::PHINode* result = builder.CreatePHI(returnType, 2);
+        result->addIncoming(directCallResult, directCallEndBlock);
+        result->addIncoming(virtualCallResult, virtualCallEndBlock);
+        valueStack.Push(result);
+    }
     StoreTemporaryGcRoot(instruction);
 }
 
@@ -2840,24 +4220,54 @@ void NativeCompilerImpl::VisitInterfaceCallInst(InterfaceCallInst& instruction)
         llvm::Value* arg = valueStack.Pop();
         args[n - i - 1] = arg;
     }
-    ArgVector resolveArgs;
-    resolveArgs.push_back(args[0]);
     uint32_t imtIndex = instruction.ImtIndex();
-    AllocaInst* receiver = new llvm::AllocaInst(GetType(ValueType::objectReference));
-    InsertAllocaIntoEntryBlock(receiver);
-    resolveArgs.push_back(llvm::ConstantInt::get(GetIntegerType(ValueType::uintType), imtIndex));
-    resolveArgs.push_back(receiver);
-    llvm::Function* rtResolveInterfaceCallAddress = cast<llvm::Function>(module->getOrInsertFunction("RtResolveInterfaceCallAddress", PointerType::get(GetType(ValueType::byteType), 0),
-        GetType(ValueType::objectReference), GetType(ValueType::intType), PointerType::get(GetType(ValueType::objectReference), 0), nullptr));
-    ImportFunction(rtResolveInterfaceCallAddress);
-    CreateCall(rtResolveInterfaceCallAddress, resolveArgs, true);
-    llvm::Value* functionAddress = valueStack.Pop();
-    args[0] = builder.CreateLoad(receiver);
-    llvm::Value* funPtrValue = builder.CreateBitCast(functionAddress, funPtrType);
+    bool callReturnsValue = instruction.GetFunctionType().ReturnType() != ValueType::none;
     int32_t pc = GetCurrentInstructionIndex();
     uint32_t lineNumber = function->GetSourceLine(pc);
     SetCurrentLineNumber(lineNumber);
-    CreateCall(funPtrValue, args, instruction.GetFunctionType().ReturnType() != ValueType::none);
+    int32_t receiverFieldOffset = -1;
+    Function* target = nullptr;
+    if (optimizationLevel > 0 && currentPad == nullptr)
+    {
+        target = GetInterfaceCallTarget(instruction, receiverFieldOffset);
+    }
+    if (!target)
+    {
+        CreateInterfaceFunctionCall(args, imtIndex, funPtrType, callReturnsValue);
+        StoreTemporaryGcRoot(instruction);
+        return;
+    }
+    std::string instIndex = std::to_string(pc);
+    llvm::BasicBlock* directCallBlock = BasicBlock::Create(context, "directCall" + instIndex, fun);
+    llvm::BasicBlock* interfaceCallBlock = BasicBlock::Create(context, "interfaceCall" + instIndex, fun);
+    llvm::BasicBlock* continueBlock = BasicBlock::Create(context, "continueTarget" + instIndex, fun);
+    llvm::Value* interfaceObject = CreateLoadObject(args[0], interfaceCallBlock);
+    llvm::Value* receiver = CreateLoadFromMemory(CreateMemberPtr(interfaceObject, receiverFieldOffset, ValueType::objectReference), ValueType::objectReference);
+    llvm::Value* isNull = builder.CreateICmpEQ(receiver, llvm::Constant::getNullValue(GetType(ValueType::objectReference)));
+    builder.CreateCondBr(isNull, interfaceCallBlock, directCallBlock);
+    currentBasicBlock = directCallBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    ArgVector directCallArgs = args;
+    directCallArgs[0] = receiver;
+    CreateCall(GetDirectCallee(target), directCallArgs, callReturnsValue);
+    llvm::Value* directCallResult = callReturnsValue ? valueStack.Pop() : nullptr;
+    llvm::BasicBlock* directCallEndBlock = currentBasicBlock;
+    builder.CreateBr(continueBlock);
+    currentBasicBlock = interfaceCallBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    CreateInterfaceFunctionCall(args, imtIndex, funPtrType, callReturnsValue);
+    llvm::Value* interfaceCallResult = callReturnsValue ? valueStack.Pop() : nullptr;
+    llvm::BasicBlock* interfaceCallEndBlock = currentBasicBlock;
+    builder.CreateBr(continueBlock);
+    currentBasicBlock = continueBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    if (callReturnsValue)
+    {
+        llvm::PHINode* result = builder.CreatePHI(returnType, 2);
+        result->addIncoming(directCallResult, directCallEndBlock);
+        result->addIncoming(interfaceCallResult, interfaceCallEndBlock);
+        valueStack.Push(result);
+    }
     StoreTemporaryGcRoot(instruction);
 }
 
@@ -2865,6 +4275,43 @@ void NativeCompilerImpl::VisitVmCallInst(VmCallInst& instruction)
 {
     ConstantId vmFunctionNameId(instruction.Index());
     Constant vmFunctionName = functionConstantPool->GetConstant(vmFunctionNameId);
+    auto it = vmFunctionRtMap.find(vmFunctionName.Value().AsStringLiteral());
+    if (it != vmFunctionRtMap.cend())
+    {
+        const std::string& rtFunctionName = it->second;
+        ValueType returnType = function->ReturnType();
+        std::vector<llvm::Type*> paramTypes;
+        ArgVector args;
+        uint32_t n = function->NumParameters();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            ValueType paramType = function->ParameterTypes()[i];
+            paramTypes.push_back(GetRtType(paramType));
+            llvm::Value* arg = builder.CreateLoad(locals[i]);
+            if (paramType == ValueType::boolType)
+            {
+                arg = builder.CreateZExt(arg, GetRtType(paramType));
+            }
+            args.push_back(arg);
+        }
+        llvm::FunctionType* rtFunctionType = llvm::FunctionType::get(GetRtType(returnType), paramTypes, false);
+        llvm::Function* rtFunction = cast<llvm::Function>(module->getOrInsertFunction(rtFunctionName, rtFunctionType));
+        ImportFunction(rtFunction);
+        int32_t pc = GetCurrentInstructionIndex();
+        uint32_t lineNumber = function->GetSourceLine(pc);
+        SetCurrentLineNumber(lineNumber);
+        CreateCall(rtFunction, args, returnType != ValueType::none);
+        if (returnType == ValueType::boolType)
+        {
+            llvm::Value* result = valueStack.Pop();
+            valueStack.Push(builder.CreateICmpNE(result, llvm::ConstantInt::get(result->getType(), 0)));
+        }
+        if (returnType != ValueType::none)
+        {
+            StoreTemporaryGcRoot(instruction);
+        }
+        return;
+    }
     ConstantId assemblyVmFunctionNameId = assemblyConstantPool->Install(vmFunctionName);
     std::vector<llvm::Type*> vmCallContextElementTypes;
     vmCallContextElementTypes.push_back(GetType(ValueType::intType));
@@ -3035,18 +4482,90 @@ void NativeCompilerImpl::VisitSetClassDataInst(SetClassDataInst& instruction)
     CreateCall(rtSetClassDataPtr, args, false);
 }
 
+//  An object is allocated inline from the allocation context of the thread, which the function fetches once in its entry block: the free pointer is bumped, 
+//  a handle reserved for the thread is popped and the allocation header and the allocation table entry are written as ManagedMemoryPool::CreateObject does. 
+//  The segment memory is already zeroed. Instead of a random hash code the object gets the handle multiplied by an odd constant, which keeps the hash codes
+//  of live objects distinct. When the context has no room or no handles left, RtCreateObject allocates the object and refills the handles of the context.
+
 void NativeCompilerImpl::VisitCreateObjectInst(CreateObjectInst& instruction)
+{
+    Type* type = instruction.GetType();
+    ClassData* classData = ClassDataTable::GetClassData(StringPtr(type->Name()));
+    ObjectType* objectType = dynamic_cast<ObjectType*>(type);
+    if (!allocationContext || currentPad != nullptr || !objectType || objectType->ObjectSize() + sizeof(ManagedAllocationHeader) > defaultLargeObjectThresholdSize)
+    {
+        CreateCreateObjectCall(classData);
+        StoreTemporaryGcRoot(instruction);
+        return;
+    }
+    uint32_t allocationSize = static_cast<uint32_t>(objectType->ObjectSize() + sizeof(ManagedAllocationHeader));
+    std::string instIndex = std::to_string(GetCurrentInstructionIndex());
+    llvm::Value* freePtr = CreateBytePtrMemberPtr(allocationContext, AllocationContext::FreeOffset());
+    llvm::Value* free = builder.CreateLoad(freePtr);
+    llvm::Value* top = builder.CreateLoad(CreateBytePtrMemberPtr(allocationContext, AllocationContext::TopOffset()));
+    llvm::Value* newFree = builder.CreateGEP(free, builder.getInt64(allocationSize));
+    llvm::Value* numHandlesPtr = CreateMemberPtr(allocationContext, AllocationContext::NumHandlesOffset(), ValueType::intType);
+    llvm::Value* numHandles = builder.CreateLoad(numHandlesPtr);
+    llvm::Value* fits = builder.CreateICmpULE(builder.CreatePtrToInt(newFree, GetType(ValueType::ulongType)), builder.CreatePtrToInt(top, GetType(ValueType::ulongType)));
+    llvm::Value* hasHandles = builder.CreateICmpSGT(numHandles, builder.getInt32(0));
+    llvm::BasicBlock* inlineBlock = BasicBlock::Create(context, "inlineAlloc" + instIndex, fun);
+    llvm::BasicBlock* runtimeBlock = BasicBlock::Create(context, "runtimeAlloc" + instIndex, fun);
+    llvm::BasicBlock* continueBlock = BasicBlock::Create(context, "continueTarget" + instIndex, fun);
+    builder.CreateCondBr(builder.CreateAnd(fits, hasHandles), inlineBlock, runtimeBlock);
+    currentBasicBlock = inlineBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    builder.CreateStore(newFree, freePtr);
+    llvm::Value* handleIndex = builder.CreateSub(numHandles, builder.getInt32(1));
+    builder.CreateStore(handleIndex, numHandlesPtr);
+    llvm::Value* handles = builder.CreateBitCast(builder.CreateGEP(allocationContext, builder.getInt64(AllocationContext::HandlesOffset())), 
+        PointerType::get(GetType(ValueType::ulongType), 0));
+    llvm::Value* handle = builder.CreateLoad(builder.CreateGEP(handles, builder.CreateSExt(handleIndex, GetType(ValueType::longType))));
+    llvm::Value* header = free;
+    CreateStoreToMemory(builder.getInt32(allocationSize), CreateMemberPtr(header, offsetof(ManagedAllocationHeader, allocationSize), ValueType::uintType), ValueType::uintType);
+    llvm::Value* segmentId = builder.CreateLoad(CreateMemberPtr(allocationContext, AllocationContext::SegmentIdOffset(), ValueType::intType));
+    CreateStoreToMemory(segmentId, CreateMemberPtr(header, offsetof(ManagedAllocationHeader, segmentId), ValueType::intType), ValueType::intType);
+    CreateStoreToMemory(builder.getInt32(lockNotAllocated), CreateMemberPtr(header, offsetof(ManagedAllocationHeader, lockId), ValueType::intType), ValueType::intType);
+    CreateStoreToMemory(builder.getInt8(static_cast<uint8_t>(AllocationFlags::object)), CreateMemberPtr(header, offsetof(ManagedAllocationHeader, flags), ValueType::byteType), 
+        ValueType::byteType);
+    int64_t objectHeaderOffset = offsetof(ManagedAllocationHeader, objectHeader);
+    builder.CreateAlignedStore(builder.CreateLoad(GetTypePtrVar(type)), CreateBytePtrMemberPtr(header, objectHeaderOffset + offsetof(ObjectHeader, type)), 1);
+    llvm::Value* hashCode = builder.CreateMul(handle, builder.getInt64(0x9E3779B97F4A7C15));
+    CreateStoreToMemory(hashCode, CreateMemberPtr(header, objectHeaderOffset + offsetof(ObjectHeader, hashCode), ValueType::ulongType), ValueType::ulongType);
+    llvm::Value* allocationTable = builder.CreateBitCast(builder.CreateLoad(allocationTableVariable), 
+        PointerType::get(PointerType::get(GetType(ValueType::byteType), 0), 0));
+    builder.CreateStore(builder.CreateGEP(header, builder.getInt64(sizeof(ManagedAllocationHeader))), builder.CreateGEP(allocationTable, handle));
+    llvm::Value* inlineObjectReference = builder.CreateIntToPtr(handle, GetType(ValueType::objectReference));
+    builder.CreateBr(continueBlock);
+    currentBasicBlock = runtimeBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    CreateCreateObjectCall(classData);
+    llvm::Value* runtimeObjectReference = valueStack.Pop();
+    llvm::BasicBlock* runtimeEndBlock = currentBasicBlock;
+    builder.CreateBr(continueBlock);
+    currentBasicBlock = continueBlock;
+    builder.SetInsertPoint(currentBasicBlock);
+    llvm::PHINode* objectReference = builder.CreatePHI(GetType(ValueType::objectReference), 2);
+    objectReference->addIncoming(inlineObjectReference, inlineBlock);
+    objectReference->addIncoming(runtimeObjectReference, runtimeEndBlock);
+    valueStack.Push(objectReference);
+    StoreTemporaryGcRoot(instruction);
+}
+
+llvm::Value* NativeCompilerImpl::CreateBytePtrMemberPtr(llvm::Value* allocation, int64_t offset)
+{
+    llvm::Value* memberBytePtr = builder.CreateGEP(allocation, builder.getInt64(offset));
+    return builder.CreateBitCast(memberBytePtr, PointerType::get(PointerType::get(GetType(ValueType::byteType), 0), 0));
+}
+
+void NativeCompilerImpl::CreateCreateObjectCall(ClassData* classData)
 {
     llvm::Function* rtCreateObject = cast<llvm::Function>(module->getOrInsertFunction("RtCreateObject", GetType(ValueType::objectReference),
         PointerType::get(GetType(ValueType::byteType), 0), nullptr));
     ImportFunction(rtCreateObject);
     ArgVector args;
-    Type* type = instruction.GetType();
-    ClassData* classData = ClassDataTable::GetClassData(StringPtr(type->Name()));
     llvm::Value* classDataPtrVar = GetClassDataPtrVar(classData);
     args.push_back(builder.CreateLoad(classDataPtrVar));
     CreateCall(rtCreateObject, args, true);
-    StoreTemporaryGcRoot(instruction);
 }
 
 void NativeCompilerImpl::VisitCopyObjectInst(CopyObjectInst& instruction)
@@ -3127,13 +4646,11 @@ void NativeCompilerImpl::VisitThrowInst(ThrowInst& instruction)
     SetCurrentLineNumber(lineNumber);
     llvm::Value* exceptionObject = valueStack.Pop(); 
     llvm::Function* rtThrowException = cast<llvm::Function>(module->getOrInsertFunction("RtThrowException", GetType(ValueType::none), GetType(ValueType::objectReference), 
-        PointerType::get(GetType(ValueType::byteType), 0), nullptr));
+        nullptr));
     ImportFunction(rtThrowException);
     rtThrowException->setAttributes(noReturnFunctionAttributes);
     ArgVector args;
     args.push_back(exceptionObject);
-    Assert(functionStackEntry, "a nonleaf function needs a function stack entry");
-    args.push_back(builder.CreateBitCast(functionStackEntry, PointerType::get(GetType(ValueType::byteType), 0)));
     CreateCall(rtThrowException, args, false);
     if (function->ReturnsValue())
     {
@@ -4608,6 +6125,8 @@ void NativeCompilerImpl::VisitStoreVariableReferenceInst(StoreVariableReferenceI
 
 void NativeCompilerImpl::VisitGcPollInst(GcPollInst& instruction)
 {
+    auto it = callFreeArrayLoopMap.find(&instruction);
+    if (it != callFreeArrayLoopMap.cend() && it->second->length) return;
     llvm::Function* rtPollGc = cast<llvm::Function>(module->getOrInsertFunction("RtPollGc", GetType(ValueType::none), nullptr));
     ImportFunction(rtPollGc);
     ArgVector args;
@@ -4700,6 +6219,15 @@ llvm::Type* NativeCompilerImpl::GetType(ValueType type)
     }
 }
 
+llvm::Type* NativeCompilerImpl::GetRtType(ValueType type)
+{
+    if (type == ValueType::boolType)
+    {
+        return llvm::Type::getInt8Ty(context); // C bool in the signature of a runtime function
+    }
+    return GetType(type);
+}
+
 llvm::IntegerType* NativeCompilerImpl::GetIntegerType(ValueType type)
 {
     switch (type)
@@ -5305,6 +6833,30 @@ void NativeCompilerImpl::InitMaps()
     convMap["bo2fl"] = LlvmConv::uitofp;
     convMap["bo2do"] = LlvmConv::uitofp;
     convMap["bo2ch"] = LlvmConv::zext;
+
+    vmFunctionRtMap[U"strindexof"] = "RtStringIndexOf";
+    vmFunctionRtMap[U"strlastindexof"] = "RtStringLastIndexOf";
+    vmFunctionRtMap[U"strindexofany"] = "RtStringIndexOfAny";
+    vmFunctionRtMap[U"strlastindexofany"] = "RtStringLastIndexOfAny";
+    vmFunctionRtMap[U"strstartswith"] = "RtStringStartsWith";
+    vmFunctionRtMap[U"strendswith"] = "RtStringEndsWith";
+    vmFunctionRtMap[U"streq"] = "RtStringEqual";
+    vmFunctionRtMap[U"strless"] = "RtStringLess";
+    vmFunctionRtMap[U"strhash"] = "RtStringGetHashCode";
+    vmFunctionRtMap[U"substring"] = "RtStringSubstring";
+    vmFunctionRtMap[U"strtrim"] = "RtStringTrim";
+    vmFunctionRtMap[U"strconcat"] = "RtStringConcat";
+    vmFunctionRtMap[U"utf8decode"] = "RtStringFromUtf8";
+    vmFunctionRtMap[U"utf8length"] = "RtStringUtf8Length";
+    vmFunctionRtMap[U"utf8encode"] = "RtStringToUtf8";
+    vmFunctionRtMap[U"arrcopy"] = "RtArrayCopy";
+    vmFunctionRtMap[U"arrfill"] = "RtArrayFill";
+    vmFunctionRtMap[U"arreq"] = "RtArrayEqual";
+    vmFunctionRtMap[U"arrindexof"] = "RtArrayIndexOf";
+    vmFunctionRtMap[U"arrreverse"] = "RtArrayReverse";
+    vmFunctionRtMap[U"arrsort"] = "RtArraySort";
+    vmFunctionRtMap[U"mmapbyte"] = "RtLoadMappedByte";
+    vmFunctionRtMap[U"mmapint"] = "RtLoadMappedInt";
 }
 
 void NativeCompilerImpl::InitOpFunMap(ConstantPool& constantPool)
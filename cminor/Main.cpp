@@ -117,6 +117,12 @@ void PrintHelp(HelpTopics helpTopics)
             "   --use-ms-link (-u)\n" <<
             "       Use Microsoft's link.exe as a linker if in path (used with --native).\n" << 
             "       Otherwise uses LLVM's lld-link as a linker.\n" <<
+            "   --whole-program (-w)\n" <<
+            "       Optimize program together with referenced assemblies (used with --native and optimization level 2 or 3).\n" <<
+            "       Functions of referenced assemblies called by the program are compiled into the program as inline candidates.\n" <<
+            "   --profile-in=FILE (-f=FILE)\n" <<
+            "       Optimize using execution profile FILE written by the virtual machine with the --profile-out option (used with --native).\n" <<
+            "       Call counts steer inlining and hot/cold function placement, branch and switch counts become branch weights.\n" <<
             "---------------------------------------------------------------------\n" <<
             std::endl;
     }
@@ -144,7 +150,18 @@ void PrintHelp(HelpTopics helpTopics)
             "   --trace (-r)\n" <<
             "       Trace execution of native program to stderr (used with --native).\n" <<
             "   --stats (-a)\n" <<
-            "       Print statistics.\n" <<
+            "       Print statistics. Includes lock contention statistics of managed monitors and condition variables.\n" <<
+            "   --lock-stats=FILE (-k=FILE)\n" <<
+            "       Write lock contention statistics of managed monitors and condition variables to FILE in JSON format.\n" <<
+            "   --profile-out=FILE (-p=FILE)\n" <<
+            "       Write execution profile of the program to FILE (not used with --native).\n" <<
+            "       The profile contains function call counts, branch counts and switch target counts.\n" <<
+            "       It can be given to the native compiler with the --profile-in option of the build command.\n" <<
+            "   --perf-map (-m)\n" <<
+            "       Write addresses and mangled names of native functions to /tmp/perf-PID.map for Linux perf (used with --native).\n" <<
+            "   --perf-stacks=FILE (-e=FILE)\n" <<
+            "       Write managed stack of each interpreter thread 99 times per second to FILE (not used with --native).\n" <<
+            "       Each sample has the thread id and monotonic clock time, so it can be matched to samples of 'perf record -k mono'.\n" <<
             "   --gcactions (-g)\n" <<
             "       Print garbage collections actions to stderr.\n" <<
             "       [G]=collecting garbage, [F]=performing full collection.\n" <<
@@ -373,6 +390,10 @@ int main(int argc, const char** argv)
                         {
                             runOptions.push_back(arg);
                         }
+                        else if (arg == "-m" || arg == "--perf-map")
+                        {
+                            runOptions.push_back(arg);
+                        }
                         else if (arg.find('=', 0) != std::string::npos)
                         {
                             std::vector<std::string> components = Split(arg, '=');
@@ -390,6 +411,18 @@ int main(int argc, const char** argv)
                                 {
                                     runOptions.push_back(arg);
                                 }
+                                else if (components[0] == "-k" || components[0] == "--lock-stats")
+                                {
+                                    runOptions.push_back(arg);
+                                }
+                                else if (components[0] == "-p" || components[0] == "--profile-out")
+                                {
+                                    runOptions.push_back(arg);
+                                }
+                                else if (components[0] == "-e" || components[0] == "--perf-stacks")
+                                {
+                                    runOptions.push_back(arg);
+                                }
                                 else if (components[0] == "-l" || components[0] == "--gnutls-logging-level")
                                 {
                                     runOptions.push_back(arg);
@@ -592,6 +625,10 @@ int main(int argc, const char** argv)
                         {
                             buildOptions.push_back(arg);
                         }
+                        else if (arg == "-w" || arg == "--whole-program")
+                        {
+                            buildOptions.push_back(arg);
+                        }
                         else if (arg == "--link-with-debug-machine")
                         {
                             buildOptions.push_back(arg);
@@ -640,6 +677,10 @@ int main(int argc, const char** argv)
                                 {
                                     buildOptions.push_back(arg);
                                 }
+                                else if (components[0] == "-f" || components[0] == "--profile-in")
+                                {
+                                    buildOptions.push_back(arg);
+                                }
                                 else if (components[0] == "-s" || components[0] == "--debug-pass")
                                 {
                                     const std::string& value = components[1];
@@ -137,6 +137,12 @@ void PrintHelp()
         "   --use-ms-link (-u)\n" <<
         "       Use Microsoft's link.exe as a linker if in path (used with --native)\n" <<
         "       Otherwise uses LLVM's lld-link as a linker.\n" <<
+        "   --whole-program (-w)\n" <<
+        "       Optimize program together with referenced assemblies (used with --native and optimization level 2 or 3).\n" <<
+        "       Functions of referenced assemblies called by the program are compiled into the program as inline candidates.\n" <<
+        "   --profile-in=FILE (-f=FILE)\n" <<
+        "       Optimize using execution profile FILE written by the virtual machine with the --profile-out option (used with --native).\n" <<
+        "       Call counts steer inlining and hot/cold function placement, branch and switch counts become branch weights.\n" <<
         std::endl;
 }
 
@@ -193,6 +199,10 @@ int main(int argc, const char** argv)
                 {
                     SetGlobalFlag(GlobalFlags::useMsLink);
                 }
+                else if (arg == "-w" || arg == "--whole-program")
+                {
+                    SetGlobalFlag(GlobalFlags::wholeProgram);
+                }
                 else if (arg == "--link-with-debug-machine")
                 {
                     SetGlobalFlag(GlobalFlags::linkWithDebugMachine);
@@ -244,6 +254,10 @@ int main(int argc, const char** argv)
                             int inlineLocals = boost::lexical_cast<int>(components[1]);
                             SetInlineLocals(inlineLocals);
                         }
+                        else if (components[0] == "-f" || components[0] == "--profile-in")
+                        {
+                            SetProfileFilePath(GetFullPath(components[1]));
+                        }
                         else if (components[0] == "-s" || components[0] == "--debug-pass")
                         {
                             const std::string& value = components[1];
@@ -16,6 +16,7 @@
 #include <cminor/vmlib/VmFunction.hpp>
 #include <cminor/vmlib/File.hpp>
 #include <cminor/vmlib/Socket.hpp>
+#include <cminor/vmlib/MemoryMappedFile.hpp>
 #include <cminor/vmlib/Threading.hpp>
 #include <cminor/db/Shell.hpp>
 #include <cminor/parsing/InitDone.hpp>
@@ -48,6 +49,7 @@ struct InitDone
         InitVmFunctions(vmFunctionNamePool);
         FileInit();
         SocketInit();
+        MappedFileInit();
         ThreadingInit();
         cminor::parsing::Init();
         cminor::util::Init();
@@ -57,6 +59,7 @@ struct InitDone
         cminor::util::Done();
         cminor::parsing::Done();
         ThreadingDone();
+        MappedFileDone();
         SocketDone();
         FileDone();
         DoneVmFunctions();
@@ -189,7 +189,7 @@ void Segment::Clear()
     std::memset(base, 0, n);
 }
 
-AllocationContext::AllocationContext() : segmentId(-1), free(nullptr), top(nullptr)
+AllocationContext::AllocationContext() : segmentId(-1), free(nullptr), top(nullptr), numHandles(0)
 {
 }
 
@@ -380,7 +380,10 @@ void GenArena2::Allocate(Thread& thread, uint64_t blockSize, void*& ptr, int32_t
                 throw std::runtime_error("could not allocate " + std::to_string(blockSize) + " bytes memory from arena " + std::to_string(int(Id())));
             }
         }
-        segmentId = segment->Id();
+        else
+        {
+            segmentId = segment->Id();
+        }
     }
 }
 
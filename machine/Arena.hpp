@@ -52,10 +52,25 @@ const uint8_t defaultNumAllocationContextPages = 2;
 MACHINE_API void SetNumAllocationContextPages(uint8_t numPages);
 MACHINE_API uint8_t GetNumAllocationContextPages();
 
+const int32_t numAllocationContextHandles = 64;
+
+//  An allocation context is a block of segment memory reserved for the allocations of a single thread. It also holds allocation handles 
+//  reserved for the thread, so that natively compiled code can create an object without the runtime: it bumps the free pointer, pops a handle 
+//  and stores the allocation to the allocation table itself. The offset functions give the layout of the context for the native compiler.
+
 class AllocationContext
 {
 public:
     AllocationContext();
+    int32_t NumHandles() const { return numHandles; }
+    bool HasRoomForHandles() const { return numHandles < numAllocationContextHandles; }
+    void PushHandle(AllocationHandle handle) { handles[numHandles++] = handle.Value(); }
+    AllocationHandle PopHandle() { return AllocationHandle(handles[--numHandles]); }
+    static int64_t SegmentIdOffset() { return offsetof(AllocationContext, segmentId); }
+    static int64_t FreeOffset() { return offsetof(AllocationContext, free); }
+    static int64_t TopOffset() { return offsetof(AllocationContext, top); }
+    static int64_t NumHandlesOffset() { return offsetof(AllocationContext, numHandles); }
+    static int64_t HandlesOffset() { return offsetof(AllocationContext, handles); }
     void SetSegmentId(int32_t segmentId_) { segmentId = segmentId_; }
     void SetFree(uint8_t* free_) { free = free_; }
     void SetTop(uint8_t* top_) { top = top_; }
@@ -82,6 +97,8 @@ private:
     int32_t segmentId;
     uint8_t* free;
     uint8_t* top;
+    int32_t numHandles;
+    uint64_t handles[numAllocationContextHandles];
 };
 
 class Arena
@@ -0,0 +1,411 @@
+// =================================
+// Copyright (c) 2017 Seppo Laakko
+// Distributed under the MIT license
+// =================================
+
+#include <cminor/machine/ArrayOps.hpp>
+#include <cminor/machine/StringOps.hpp>
+#include <cminor/machine/Machine.hpp>
+#include <cminor/machine/Type.hpp>
+#include <cminor/machine/Error.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cminor { namespace machine {
+
+struct ArrayData
+{
+    ArrayData() : elements(nullptr), elementType(nullptr), valueType(ValueType::none), elementSize(0), numElements(0) {}
+    uint8_t* elements;
+    Type* elementType;
+    ValueType valueType;
+    uint32_t elementSize;
+    int32_t numElements;
+};
+
+ArrayData GetArrayData(ManagedMemoryPool& memoryPool, ObjectReference arr, std::unique_lock<std::recursive_mutex>& lock)
+{
+    if (arr.IsNull())
+    {
+        throw NullReferenceException("array is null");
+    }
+    IntegralValue elementsHandleValue = memoryPool.GetField(arr, 2, lock);
+    Assert(elementsHandleValue.GetType() == ValueType::allocationHandle, "allocation handle expected");
+    AllocationHandle handle(elementsHandleValue.Value());
+    ArrayData data;
+    if (handle.Value() == 0)
+    {
+        return data;
+    }
+    void* arrayElements = memoryPool.GetAllocation(handle, lock);
+    ArrayElementsHeader* header = &GetAllocationHeader(arrayElements)->arrayElementsHeader;
+    data.elements = static_cast<uint8_t*>(arrayElements);
+    data.elementType = header->GetElementType();
+    data.valueType = data.elementType->GetValueType();
+    data.elementSize = ValueSize(data.valueType);
+    data.numElements = header->NumElements();
+    return data;
+}
+
+void CheckArrayRange(const ArrayData& data, int32_t index, int32_t count)
+{
+    if (index < 0 || count < 0 || index > data.numElements || count > data.numElements - index)
+    {
+        throw IndexOutOfRangeException("array index out of range");
+    }
+}
+
+void CheckIntegralElements(const ArrayData& data)
+{
+    switch (data.valueType)
+    {
+        case ValueType::boolType: case ValueType::sbyteType: case ValueType::byteType: case ValueType::shortType: case ValueType::ushortType:
+        case ValueType::intType: case ValueType::uintType: case ValueType::longType: case ValueType::ulongType: case ValueType::charType:
+        {
+            return;
+        }
+    }
+    throw InvalidCastException("array of integer, char or bool elements expected");
+}
+
+template<typename T>
+void FillElements(uint8_t* elements, T value, int32_t count)
+{
+    T* p = reinterpret_cast<T*>(elements);
+    std::fill(p, p + count, value);
+}
+
+template<typename T>
+int32_t FindElement(const uint8_t* elements, T value, int32_t start, int32_t end)
+{
+    const T* p = reinterpret_cast<const T*>(elements);
+    const T* q = std::find(p + start, p + end, value);
+    if (q == p + end)
+    {
+        return -1;
+    }
+    return static_cast<int32_t>(q - p);
+}
+
+template<typename T>
+void ReverseElements(uint8_t* elements, int32_t index, int32_t count)
+{
+    T* p = reinterpret_cast<T*>(elements) + index;
+    std::reverse(p, p + count);
+}
+
+const int32_t radixSortThreshold = 256;
+const int32_t parallelSortMinChunk = 64 * 1024;
+
+template<typename T>
+void RadixSort(T* data, int32_t n)
+{
+    typedef typename std::make_unsigned<T>::type U;
+    const U signFlip = std::is_signed<T>::value ? static_cast<U>(U(1) << (8 * sizeof(T) - 1)) : U(0);
+    std::vector<T> buffer(n);
+    T* src = data;
+    T* dst = buffer.data();
+    for (int shift = 0; shift < 8 * static_cast<int>(sizeof(T)); shift += 8)
+    {
+        int32_t counts[256] = {};
+        for (int32_t i = 0; i < n; ++i)
+        {
+            ++counts[((static_cast<U>(src[i]) ^ signFlip) >> shift) & 0xFF];
+        }
+        if (counts[((static_cast<U>(src[0]) ^ signFlip) >> shift) & 0xFF] == n)
+        {
+            continue;
+        }
+        int32_t pos = 0;
+        for (int i = 0; i < 256; ++i)
+        {
+            int32_t c = counts[i];
+            counts[i] = pos;
+            pos += c;
+        }
+        for (int32_t i = 0; i < n; ++i)
+        {
+            T x = src[i];
+            dst[counts[((static_cast<U>(x) ^ signFlip) >> shift) & 0xFF]++] = x;
+        }
+        std::swap(src, dst);
+    }
+    if (src != data)
+    {
+        std::copy(src, src + n, data);
+    }
+}
+
+template<typename T>
+void SortIntegers(T* data, int32_t n)
+{
+    if (n < radixSortThreshold)
+    {
+        std::sort(data, data + n);
+    }
+    else
+    {
+        RadixSort(data, n);
+    }
+}
+
+template<typename T>
+void SortFloats(T* data, int32_t n)
+{
+    std::stable_sort(data, data + n);
+}
+
+//  Each chunk is sorted by its own thread, and the same threads then merge the chunks pairwise: at level L the thread of chunk i, where i is a multiple
+//  of 2^(L+1), waits for the thread of chunk i + 2^L to finish level L - 1 and merges their ranges from one buffer to the other. No threads are
+//  started after the chunk sorts.
+
+template<typename T>
+void SortElements(T* data, int32_t n, bool parallel, void (*sortChunk)(T*, int32_t))
+{
+    int32_t numChunks = 1;
+    if (parallel)
+    {
+        numChunks = std::min(static_cast<int32_t>(std::max(std::thread::hardware_concurrency(), 1u)), n / parallelSortMinChunk);
+    }
+    if (numChunks < 2)
+    {
+        sortChunk(data, n);
+        return;
+    }
+    std::vector<int32_t> bounds;
+    for (int32_t i = 0; i <= numChunks; ++i)
+    {
+        bounds.push_back(static_cast<int32_t>(static_cast<int64_t>(n) * i / numChunks));
+    }
+    int32_t numLevels = 0;
+    while ((1 << numLevels) < numChunks)
+    {
+        ++numLevels;
+    }
+    std::vector<T> buffer(n);
+    T* buffers[2] = { data, buffer.data() };
+    std::vector<int32_t> levelsDone(numChunks, -1);
+    std::mutex levelsMtx;
+    std::condition_variable levelDone;
+    auto run = [&](int32_t i)
+    {
+        sortChunk(data + bounds[i], bounds[i + 1] - bounds[i]);
+        for (int32_t level = 0; ; ++level)
+        {
+            {
+                std::lock_guard<std::mutex> lock(levelsMtx);
+                levelsDone[i] = level;
+            }
+            levelDone.notify_all();
+            int32_t step = 1 << level;
+            if (level == numLevels || i % (2 * step) != 0)
+            {
+                return;
+            }
+            T* src = buffers[level % 2];
+            T* dst = buffers[(level + 1) % 2];
+            int32_t lo = bounds[i];
+            int32_t mid = bounds[std::min(i + step, numChunks)];
+            int32_t hi = bounds[std::min(i + 2 * step, numChunks)];
+            if (i + step < numChunks)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(levelsMtx);
+                    levelDone.wait(lock, [&]() { return levelsDone[i + step] >= level; });
+                }
+                std::merge(src + lo, src + mid, src + mid, src + hi, dst + lo);
+            }
+            else
+            {
+                std::copy(src + lo, src + hi, dst + lo);
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int32_t i = 1; i < numChunks; ++i)
+    {
+        workers.push_back(std::thread(run, i));
+    }
+    run(0);
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    if (numLevels % 2 != 0)
+    {
+        std::copy(buffer.begin(), buffer.end(), data);
+    }
+}
+
+template<typename T>
+void SortFloatElements(T* data, int32_t n, bool parallel)
+{
+    T* end = std::partition(data, data + n, [](T x) { return x == x; });
+    SortElements<T>(data, static_cast<int32_t>(end - data), parallel, SortFloats<T>);
+}
+
+MACHINE_API void ArrayCopy(ObjectReference source, int32_t sourceIndex, ObjectReference destination, int32_t destinationIndex, int32_t length)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    ArrayData src = GetArrayData(memoryPool, source, lock);
+    ArrayData dst = GetArrayData(memoryPool, destination, lock);
+    CheckArrayRange(src, sourceIndex, length);
+    CheckArrayRange(dst, destinationIndex, length);
+    if (length == 0)
+    {
+        return;
+    }
+    if (src.elementType != dst.elementType)
+    {
+        throw InvalidCastException("array element types differ");
+    }
+    std::memmove(dst.elements + destinationIndex * dst.elementSize, src.elements + sourceIndex * src.elementSize, length * src.elementSize);
+}
+
+MACHINE_API void ArrayFill(ObjectReference arr, uint64_t value, int32_t index, int32_t count)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    ArrayData data = GetArrayData(memoryPool, arr, lock);
+    CheckArrayRange(data, index, count);
+    if (count == 0)
+    {
+        return;
+    }
+    CheckIntegralElements(data);
+    uint8_t* begin = data.elements + index * data.elementSize;
+    switch (data.elementSize)
+    {
+        case 1: std::memset(begin, static_cast<uint8_t>(value), count); break;
+        case 2: FillElements<uint16_t>(begin, static_cast<uint16_t>(value), count); break;
+        case 4: FillElements<uint32_t>(begin, static_cast<uint32_t>(value), count); break;
+        case 8: FillElements<uint64_t>(begin, value, count); break;
+    }
+}
+
+MACHINE_API bool ArrayEqual(ObjectReference left, ObjectReference right)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    ArrayData l = GetArrayData(memoryPool, left, lock);
+    ArrayData r = GetArrayData(memoryPool, right, lock);
+    if (l.numElements != r.numElements)
+    {
+        return false;
+    }
+    if (l.numElements == 0 || l.elements == r.elements)
+    {
+        return true;
+    }
+    if (l.elementType != r.elementType)
+    {
+        return false;
+    }
+    return std::memcmp(l.elements, r.elements, l.numElements * l.elementSize) == 0;
+}
+
+MACHINE_API int32_t ArrayIndexOf(ObjectReference arr, uint64_t value, int32_t start, int32_t count)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    ArrayData data = GetArrayData(memoryPool, arr, lock);
+    CheckArrayRange(data, start, count);
+    if (count == 0)
+    {
+        return -1;
+    }
+    CheckIntegralElements(data);
+    int32_t end = start + count;
+    switch (data.elementSize)
+    {
+        case 1:
+        {
+            const void* found = std::memchr(data.elements + start, static_cast<uint8_t>(value), count);
+            if (!found)
+            {
+                return -1;
+            }
+            return static_cast<int32_t>(static_cast<const uint8_t*>(found) - data.elements);
+        }
+        case 2: return FindElement<uint16_t>(data.elements, static_cast<uint16_t>(value), start, end);
+        case 4:
+        {
+            int32_t i = StrIndexOf(reinterpret_cast<const char32_t*>(data.elements), end, static_cast<char32_t>(value), start);
+            return i;
+        }
+        case 8: return FindElement<uint64_t>(data.elements, value, start, end);
+    }
+    return -1;
+}
+
+MACHINE_API void ArrayReverse(ObjectReference arr, int32_t index, int32_t count)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    ArrayData data = GetArrayData(memoryPool, arr, lock);
+    CheckArrayRange(data, index, count);
+    if (count < 2)
+    {
+        return;
+    }
+    switch (data.elementSize)
+    {
+        case 1: ReverseElements<uint8_t>(data.elements, index, count); break;
+        case 2: ReverseElements<uint16_t>(data.elements, index, count); break;
+        case 4: ReverseElements<uint32_t>(data.elements, index, count); break;
+        case 8: ReverseElements<uint64_t>(data.elements, index, count); break;
+    }
+}
+
+//  The elements are sorted in a copy with the allocations mutex released and the thread in the waiting state, so that neither other allocating
+//  threads nor a garbage collection wait for the sort. A collection may move the array meanwhile, so after the sort the thread waits until the
+//  collection has finished and looks the elements up again before it writes the sorted copy back.
+
+MACHINE_API bool ArraySort(Thread& thread, ObjectReference arr, int32_t index, int32_t count, bool parallel)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    ArrayData data = GetArrayData(memoryPool, arr, lock);
+    CheckArrayRange(data, index, count);
+    bool primitive = data.valueType != ValueType::objectReference && data.valueType != ValueType::none;
+    if (count < 2 || !primitive)
+    {
+        return primitive;
+    }
+    size_t numBytes = static_cast<size_t>(count) * data.elementSize;
+    std::unique_ptr<uint8_t[]> elements(new uint8_t[numBytes]);
+    std::memcpy(elements.get(), data.elements + index * data.elementSize, numBytes);
+    ValueType valueType = data.valueType;
+    lock.unlock();
+    {
+        WaitingSetter waiting(thread);
+        uint8_t* begin = elements.get();
+        switch (valueType)
+        {
+            case ValueType::boolType: case ValueType::byteType: SortElements<uint8_t>(begin, count, parallel, SortIntegers<uint8_t>); break;
+            case ValueType::sbyteType: SortElements<int8_t>(reinterpret_cast<int8_t*>(begin), count, parallel, SortIntegers<int8_t>); break;
+            case ValueType::shortType: SortElements<int16_t>(reinterpret_cast<int16_t*>(begin), count, parallel, SortIntegers<int16_t>); break;
+            case ValueType::ushortType: SortElements<uint16_t>(reinterpret_cast<uint16_t*>(begin), count, parallel, SortIntegers<uint16_t>); break;
+            case ValueType::intType: SortElements<int32_t>(reinterpret_cast<int32_t*>(begin), count, parallel, SortIntegers<int32_t>); break;
+            case ValueType::uintType: case ValueType::charType: SortElements<uint32_t>(reinterpret_cast<uint32_t*>(begin), count, parallel, SortIntegers<uint32_t>); break;
+            case ValueType::longType: SortElements<int64_t>(reinterpret_cast<int64_t*>(begin), count, parallel, SortIntegers<int64_t>); break;
+            case ValueType::ulongType: SortElements<uint64_t>(reinterpret_cast<uint64_t*>(begin), count, parallel, SortIntegers<uint64_t>); break;
+            case ValueType::floatType: SortFloatElements<float>(reinterpret_cast<float*>(begin), count, parallel); break;
+            case ValueType::doubleType: SortFloatElements<double>(reinterpret_cast<double*>(begin), count, parallel); break;
+        }
+    }
+    GetMachine().GetGarbageCollector().WaitForIdle(thread);
+    lock.lock();
+    data = GetArrayData(memoryPool, arr, lock);
+    std::memcpy(data.elements + index * data.elementSize, elements.get(), numBytes);
+    return true;
+}
+
+} } // namespace cminor::machine
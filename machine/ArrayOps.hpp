@@ -0,0 +1,28 @@
+// =================================
+// Copyright (c) 2017 Seppo Laakko
+// Distributed under the MIT license
+// =================================
+
+#ifndef CMINOR_MACHINE_ARRAY_OPS_INCLUDED
+#define CMINOR_MACHINE_ARRAY_OPS_INCLUDED
+#include <cminor/machine/Object.hpp>
+
+namespace cminor { namespace machine {
+
+//  Bulk array operations used by both the System.Array VM functions and the corresponding Rt entry points of native code.
+//  They operate directly on the packed element data of the arrays. Copy, Equal and Reverse accept arrays of any element type;
+//  Fill and IndexOf accept arrays of integer, char and bool elements and take the value as the low bytes of a 64-bit integer.
+//  Sort sorts arrays of primitive elements in ascending order and returns false without touching the array for other element types.
+//  Integer, char and bool elements are radix sorted, floating-point elements are merge sorted and NaNs are placed last. If parallel is true,
+//  a large range is split into chunks that are sorted and merged by native worker threads.
+
+MACHINE_API void ArrayCopy(ObjectReference source, int32_t sourceIndex, ObjectReference destination, int32_t destinationIndex, int32_t length);
+MACHINE_API void ArrayFill(ObjectReference arr, uint64_t value, int32_t index, int32_t count);
+MACHINE_API bool ArrayEqual(ObjectReference left, ObjectReference right);
+MACHINE_API int32_t ArrayIndexOf(ObjectReference arr, uint64_t value, int32_t start, int32_t count);
+MACHINE_API void ArrayReverse(ObjectReference arr, int32_t index, int32_t count);
+MACHINE_API bool ArraySort(Thread& thread, ObjectReference arr, int32_t index, int32_t count, bool parallel);
+
+} } // namespace cminor::machine
+
+#endif // CMINOR_MACHINE_ARRAY_OPS_INCLUDED
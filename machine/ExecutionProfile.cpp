@@ -0,0 +1,223 @@
+// =================================
+// Copyright (c) 2017 Seppo Laakko
+// Distributed under the MIT license
+// =================================
+
+#include <cminor/machine/ExecutionProfile.hpp>
+#include <cminor/machine/Function.hpp>
+#include <cminor/util/Unicode.hpp>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace cminor { namespace machine {
+
+using namespace cminor::unicode;
+
+std::atomic<bool> executionProfilingEnabled(false);
+
+typedef std::unordered_map<Function*, FunctionProfile> ThreadProfile;
+
+std::mutex threadProfilesMutex;
+std::vector<std::unique_ptr<ThreadProfile>> threadProfiles;
+thread_local ThreadProfile* threadProfile = nullptr;
+
+ThreadProfile& GetThreadProfile()
+{
+    if (!threadProfile)
+    {
+        std::lock_guard<std::mutex> lock(threadProfilesMutex);
+        threadProfiles.push_back(std::unique_ptr<ThreadProfile>(new ThreadProfile()));
+        threadProfile = threadProfiles.back().get();
+    }
+    return *threadProfile;
+}
+
+MACHINE_API void EnableExecutionProfiling()
+{
+    executionProfilingEnabled = true;
+}
+
+MACHINE_API void RecordFunctionEntry(Function& function)
+{
+    ++GetThreadProfile()[&function].entryCount;
+}
+
+MACHINE_API void RecordBranch(Function& function, int32_t instIndex, bool taken)
+{
+    BranchProfile& branchProfile = GetThreadProfile()[&function].branches[instIndex];
+    if (taken)
+    {
+        ++branchProfile.taken;
+    }
+    else
+    {
+        ++branchProfile.notTaken;
+    }
+}
+
+MACHINE_API void RecordSwitch(Function& function, int32_t instIndex, int32_t targetIndex, int32_t numTargets)
+{
+    std::vector<uint64_t>& counts = GetThreadProfile()[&function].switches[instIndex];
+    if (counts.empty())
+    {
+        counts.resize(numTargets + 1);
+    }
+    ++counts[targetIndex];
+}
+
+void MergeFunctionProfile(FunctionProfile& to, const FunctionProfile& from)
+{
+    to.entryCount += from.entryCount;
+    for (const auto& p : from.branches)
+    {
+        BranchProfile& branchProfile = to.branches[p.first];
+        branchProfile.taken += p.second.taken;
+        branchProfile.notTaken += p.second.notTaken;
+    }
+    for (const auto& p : from.switches)
+    {
+        std::vector<uint64_t>& counts = to.switches[p.first];
+        if (counts.size() < p.second.size())
+        {
+            counts.resize(p.second.size());
+        }
+        for (int i = 0; i < int(p.second.size()); ++i)
+        {
+            counts[i] += p.second[i];
+        }
+    }
+}
+
+MACHINE_API void WriteExecutionProfile(const std::string& filePath)
+{
+    std::unordered_map<std::string, FunctionProfile> functionProfiles;
+    {
+        std::lock_guard<std::mutex> lock(threadProfilesMutex);
+        for (const std::unique_ptr<ThreadProfile>& profile : threadProfiles)
+        {
+            for (const auto& p : *profile)
+            {
+                MergeFunctionProfile(functionProfiles[ToUtf8(p.first->CallName().Value().AsStringLiteral())], p.second);
+            }
+        }
+    }
+    std::ofstream file(filePath);
+    if (!file)
+    {
+        throw std::runtime_error("could not create execution profile file '" + filePath + "'");
+    }
+    std::vector<std::string> callNames;
+    for (const auto& p : functionProfiles)
+    {
+        callNames.push_back(p.first);
+    }
+    std::sort(callNames.begin(), callNames.end());
+    for (const std::string& callName : callNames)
+    {
+        const FunctionProfile& functionProfile = functionProfiles[callName];
+        file << "function " << functionProfile.entryCount << " " << callName << "\n";
+        std::vector<std::pair<int32_t, BranchProfile>> branches(functionProfile.branches.begin(), functionProfile.branches.end());
+        std::sort(branches.begin(), branches.end(), [](const std::pair<int32_t, BranchProfile>& left, const std::pair<int32_t, BranchProfile>& right) { return left.first < right.first; });
+        for (const std::pair<int32_t, BranchProfile>& branch : branches)
+        {
+            file << "branch " << branch.first << " " << branch.second.taken << " " << branch.second.notTaken << "\n";
+        }
+        std::vector<std::pair<int32_t, std::vector<uint64_t>>> switches(functionProfile.switches.begin(), functionProfile.switches.end());
+        std::sort(switches.begin(), switches.end(), [](const std::pair<int32_t, std::vector<uint64_t>>& left, const std::pair<int32_t, std::vector<uint64_t>>& right) { return left.first < right.first; });
+        for (const std::pair<int32_t, std::vector<uint64_t>>& switch_ : switches)
+        {
+            file << "switch " << switch_.first << " " << switch_.second.size();
+            for (uint64_t count : switch_.second)
+            {
+                file << " " << count;
+            }
+            file << "\n";
+        }
+    }
+}
+
+ExecutionProfile::ExecutionProfile() : maxEntryCount(0)
+{
+}
+
+void ExecutionProfile::Read(const std::string& filePath)
+{
+    std::ifstream file(filePath);
+    if (!file)
+    {
+        throw std::runtime_error("could not open execution profile file '" + filePath + "'");
+    }
+    FunctionProfile* functionProfile = nullptr;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        if (line.empty()) continue;
+        std::istringstream s(line);
+        std::string kind;
+        s >> kind;
+        if (kind == "function")
+        {
+            uint64_t entryCount = 0;
+            s >> entryCount;
+            s.get();
+            std::string callName;
+            std::getline(s, callName);
+            if (s.fail() || callName.empty())
+            {
+                throw std::runtime_error("invalid execution profile file '" + filePath + "' line " + std::to_string(lineNumber));
+            }
+            functionProfile = &functionProfiles[callName];
+            functionProfile->entryCount += entryCount;
+            maxEntryCount = std::max(maxEntryCount, functionProfile->entryCount);
+        }
+        else if (kind == "branch" && functionProfile)
+        {
+            int32_t instIndex = 0;
+            BranchProfile branchProfile;
+            s >> instIndex >> branchProfile.taken >> branchProfile.notTaken;
+            if (!s)
+            {
+                throw std::runtime_error("invalid execution profile file '" + filePath + "' line " + std::to_string(lineNumber));
+            }
+            functionProfile->branches[instIndex] = branchProfile;
+        }
+        else if (kind == "switch" && functionProfile)
+        {
+            int32_t instIndex = 0;
+            size_t n = 0;
+            s >> instIndex >> n;
+            std::vector<uint64_t> counts(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                s >> counts[i];
+            }
+            if (!s)
+            {
+                throw std::runtime_error("invalid execution profile file '" + filePath + "' line " + std::to_string(lineNumber));
+            }
+            functionProfile->switches[instIndex] = counts;
+        }
+        else
+        {
+            throw std::runtime_error("invalid execution profile file '" + filePath + "' line " + std::to_string(lineNumber));
+        }
+    }
+}
+
+const FunctionProfile* ExecutionProfile::GetFunctionProfile(const std::string& callName) const
+{
+    auto it = functionProfiles.find(callName);
+    if (it != functionProfiles.cend())
+    {
+        return &it->second;
+    }
+    return nullptr;
+}
+
+} } // namespace cminor::machine
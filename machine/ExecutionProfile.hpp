@@ -0,0 +1,66 @@
+// =================================
+// Copyright (c) 2017 Seppo Laakko
+// Distributed under the MIT license
+// =================================
+
+#ifndef CMINOR_MACHINE_EXECUTION_PROFILE_INCLUDED
+#define CMINOR_MACHINE_EXECUTION_PROFILE_INCLUDED
+#include <cminor/machine/MachineApi.hpp>
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cminor { namespace machine {
+
+class Function;
+
+//  Execution profiling is enabled by the --profile-out option of the virtual machine. When enabled, the interpreter records per function
+//  the number of calls, for each jumptrue and jumpfalse instruction the number of times the jump was taken and not taken, and for each switch
+//  instruction the number of times each case target and the default target was chosen. Instructions are identified by their index in the
+//  function as it is stored in the assembly. Each thread records to a profile of its own; the profiles are merged when the profile is written.
+
+extern std::atomic<bool> executionProfilingEnabled;
+
+struct MACHINE_API BranchProfile
+{
+    BranchProfile() : taken(0), notTaken(0) {}
+    uint64_t taken;
+    uint64_t notTaken;
+};
+
+//  Switch counts have one entry for each case target in the order of the targets of the switch instruction followed by an entry for the default target.
+
+struct MACHINE_API FunctionProfile
+{
+    FunctionProfile() : entryCount(0) {}
+    uint64_t entryCount;
+    std::unordered_map<int32_t, BranchProfile> branches;
+    std::unordered_map<int32_t, std::vector<uint64_t>> switches;
+};
+
+MACHINE_API void EnableExecutionProfiling();
+MACHINE_API void RecordFunctionEntry(Function& function);
+MACHINE_API void RecordBranch(Function& function, int32_t instIndex, bool taken);
+MACHINE_API void RecordSwitch(Function& function, int32_t instIndex, int32_t targetIndex, int32_t numTargets);
+MACHINE_API void WriteExecutionProfile(const std::string& filePath);
+
+//  An execution profile written by the virtual machine is read by the native compiler when given the --profile-in option.
+//  Functions are identified by their call names.
+
+class MACHINE_API ExecutionProfile
+{
+public:
+    ExecutionProfile();
+    void Read(const std::string& filePath);
+    const FunctionProfile* GetFunctionProfile(const std::string& callName) const;
+    uint64_t MaxEntryCount() const { return maxEntryCount; }
+private:
+    std::unordered_map<std::string, FunctionProfile> functionProfiles;
+    uint64_t maxEntryCount;
+};
+
+} } // namespace cminor::machine
+
+#endif // CMINOR_MACHINE_EXECUTION_PROFILE_INCLUDED
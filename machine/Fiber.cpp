@@ -0,0 +1,270 @@
+// =================================
+// Copyright (c) 2017 Seppo Laakko
+// Distributed under the MIT license
+// =================================
+
+#include <cminor/machine/Fiber.hpp>
+#include <cminor/machine/Thread.hpp>
+#include <cminor/machine/Machine.hpp>
+#include <cminor/machine/Function.hpp>
+#include <cminor/machine/Instruction.hpp>
+#include <cminor/machine/OsInterface.hpp>
+#include <algorithm>
+#include <thread>
+
+namespace cminor { namespace machine {
+
+uint64_t fiberStackReserveSize = defaultFiberStackReserveSize;
+
+uint64_t GetFiberStackReserveSize()
+{
+    return fiberStackReserveSize;
+}
+
+void SetFiberStackReserveSize(uint64_t fiberStackReserveSize_)
+{
+    fiberStackReserveSize = fiberStackReserveSize_;
+}
+
+PollSocketsFn pollSockets = nullptr;
+
+MACHINE_API void SetPollSocketsFn(PollSocketsFn pollSockets_)
+{
+    pollSockets = pollSockets_;
+}
+
+const int initialFiberFrames = 16;
+
+Fiber::Fiber(int32_t id_, Thread& thread_, uint64_t stackReserveSize) :
+    id(id_), state(FiberState::ready), stack(thread_, stackReserveSize, GetSystemPageSize(), initialFiberFrames), handlingException(false),
+    currentExceptionBlock(nullptr), exceptionObjectType(nullptr)
+{
+}
+
+FiberScheduler::FiberScheduler(Thread& thread_) : thread(thread_), root(nullptr), current(nullptr)
+{
+    int32_t rootId = GetMachine().GetNextFiberId();
+    std::unique_ptr<Fiber> rootFiber(new Fiber(rootId, thread, 0));
+    rootFiber->SetState(FiberState::running);
+    root = rootFiber.get();
+    current = root;
+    fibers[rootId] = std::move(rootFiber);
+}
+
+int32_t FiberScheduler::StartFiber(Function& fun, ObjectReference receiver)
+{
+    int32_t fiberId = GetMachine().GetNextFiberId();
+    std::unique_ptr<Fiber> fiber(new Fiber(fiberId, thread, GetFiberStackReserveSize()));
+    fiber->OpStack().Push(receiver);
+    fiber->GetStack().AllocateFrame(fun);
+    readyQueue.push_back(fiber.get());
+    fibers[fiberId] = std::move(fiber);
+    return fiberId;
+}
+
+void FiberScheduler::YieldCurrent()
+{
+    if (readyQueue.empty() && sleepers.empty() && socketWaits.empty())
+    {
+        return;
+    }
+    thread.RequestFiberSwitch();
+}
+
+void FiberScheduler::SleepCurrent(std::chrono::nanoseconds duration)
+{
+    std::chrono::steady_clock::time_point wakeTime = std::chrono::steady_clock::now() + duration;
+    current->SetState(FiberState::sleeping);
+    current->SetWakeTime(wakeTime);
+    sleepers.insert(std::make_pair(wakeTime, current));
+    thread.RequestFiberSwitch();
+}
+
+bool FiberScheduler::Join(int32_t fiberId)
+{
+    if (fiberId == current->Id())
+    {
+        throw ThreadingException("fiber cannot join itself");
+    }
+    auto it = fibers.find(fiberId);
+    if (it == fibers.cend())
+    {
+        return false;
+    }
+    Fiber* fiber = it->second.get();
+    if (fiber->State() == FiberState::finished)
+    {
+        return false;
+    }
+    if (readyQueue.empty() && sleepers.empty() && socketWaits.empty())
+    {
+        throw ThreadingException("fiber deadlock: all other fibers of thread " + std::to_string(thread.Id()) + " are waiting to join");
+    }
+    current->SetState(FiberState::joining);
+    fiber->AddJoiner(current);
+    thread.RequestFiberSwitch();
+    return true;
+}
+
+void FiberScheduler::WaitSocketCurrent(int32_t socketHandle, int32_t events)
+{
+    current->SetState(FiberState::waitingSocket);
+    socketWaits.push_back(SocketWait(current, socketHandle, events));
+    thread.RequestFiberSwitch();
+}
+
+bool FiberScheduler::Switch(bool currentFinished)
+{
+    Fiber* prev = current;
+    thread.ExchangeContext(*prev);
+    if (currentFinished)
+    {
+        prev->SetState(FiberState::finished);
+        for (Fiber* joiner : prev->Joiners())
+        {
+            joiner->SetState(FiberState::ready);
+            readyQueue.push_back(joiner);
+        }
+        prev->Joiners().clear();
+        if (prev != root)
+        {
+            fibers.erase(prev->Id());
+        }
+    }
+    else if (prev->State() == FiberState::running)
+    {
+        prev->SetState(FiberState::ready);
+        readyQueue.push_back(prev);
+    }
+    Fiber* next = NextReady();
+    if (!next)
+    {
+        if (fibers.size() == 1 && root->State() == FiberState::finished)
+        {
+            thread.ExchangeContext(*root);
+            current = root;
+            return false;
+        }
+        ResumeWithDeadlockException(currentFinished ? nullptr : prev);
+        return true;
+    }
+    thread.ExchangeContext(*next);
+    next->SetState(FiberState::running);
+    current = next;
+    return true;
+}
+
+//  All unfinished fibers are waiting to join. Resumes one of them, preferring the fiber that switched (null if it finished), and throws a ThreadingException in it.
+
+void FiberScheduler::ResumeWithDeadlockException(Fiber* prev)
+{
+    Fiber* victim = nullptr;
+    if (prev && prev->State() == FiberState::joining)
+    {
+        victim = prev;
+    }
+    else if (root->State() == FiberState::joining)
+    {
+        victim = root;
+    }
+    else
+    {
+        for (const auto& p : fibers)
+        {
+            if (p.second->State() == FiberState::joining)
+            {
+                victim = p.second.get();
+                break;
+            }
+        }
+    }
+    Assert(victim, "joining fiber expected");
+    for (const auto& p : fibers)
+    {
+        std::vector<Fiber*>& joiners = p.second->Joiners();
+        joiners.erase(std::remove(joiners.begin(), joiners.end(), victim), joiners.end());
+    }
+    thread.ExchangeContext(*victim);
+    victim->SetState(FiberState::running);
+    current = victim;
+    ThrowThreadingException(ThreadingException("fiber deadlock: all fibers of thread " + std::to_string(thread.Id()) + " are waiting to join"), *thread.GetStack().CurrentFrame());
+}
+
+Fiber* FiberScheduler::NextReady()
+{
+    while (true)
+    {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        while (!sleepers.empty() && sleepers.begin()->first <= now)
+        {
+            Fiber* sleeper = sleepers.begin()->second;
+            sleepers.erase(sleepers.begin());
+            sleeper->SetState(FiberState::ready);
+            readyQueue.push_back(sleeper);
+        }
+        if (!socketWaits.empty())
+        {
+            PollSockets(0);
+        }
+        if (!readyQueue.empty())
+        {
+            Fiber* next = readyQueue.front();
+            readyQueue.pop_front();
+            return next;
+        }
+        if (sleepers.empty() && socketWaits.empty())
+        {
+            return nullptr;
+        }
+        ThreadState prevState = thread.GetState();
+        thread.SetState(ThreadState::waiting);
+        if (socketWaits.empty())
+        {
+            std::this_thread::sleep_until(sleepers.begin()->first);
+        }
+        else
+        {
+            int timeoutMs = -1;
+            if (!sleepers.empty())
+            {
+                timeoutMs = int(std::chrono::duration_cast<std::chrono::milliseconds>(sleepers.begin()->first - now).count()) + 1;
+            }
+            PollSockets(timeoutMs);
+        }
+        thread.SetState(prevState);
+        GetMachine().GetGarbageCollector().WaitForIdle(thread);
+    }
+}
+
+//  Without a socket library every socket counts as ready, so the fiber retries its operation, which then blocks the thread.
+
+void FiberScheduler::PollSockets(int timeoutMs)
+{
+    if (pollSockets)
+    {
+        pollSockets(socketWaits, timeoutMs);
+    }
+    else
+    {
+        for (SocketWait& socketWait : socketWaits)
+        {
+            socketWait.ready = true;
+        }
+    }
+    auto it = socketWaits.begin();
+    while (it != socketWaits.end())
+    {
+        if (it->ready)
+        {
+            it->fiber->SetState(FiberState::ready);
+            readyQueue.push_back(it->fiber);
+            it = socketWaits.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+} } // namespace cminor::machine
@@ -0,0 +1,131 @@
+// =================================
+// Copyright (c) 2017 Seppo Laakko
+// Distributed under the MIT license
+// =================================
+
+#ifndef CMINOR_MACHINE_FIBER_INCLUDED
+#define CMINOR_MACHINE_FIBER_INCLUDED
+#include <cminor/machine/MachineApi.hpp>
+#include <cminor/machine/Stack.hpp>
+#include <cminor/machine/OperandStack.hpp>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <stack>
+#include <unordered_map>
+#include <vector>
+
+namespace cminor { namespace machine {
+
+constexpr uint64_t defaultFiberStackReserveSize = 256 * 1024;
+
+uint64_t GetFiberStackReserveSize();
+void SetFiberStackReserveSize(uint64_t fiberStackReserveSize_);
+
+class Thread;
+class ExceptionBlock;
+class ObjectType;
+
+enum class FiberState : uint8_t
+{
+    ready, running, sleeping, joining, waitingSocket, finished
+};
+
+//  A fiber is a cooperatively scheduled interpreter context: a frame stack, an operand stack and the exception handling state.
+//  Fibers run on the thread that started them. The context of the running fiber is held by the thread itself; a parked fiber
+//  holds its own context. The stack of a fiber reserves GetFiberStackReserveSize() bytes and commits memory one page at a time.
+
+class Fiber
+{
+public:
+    Fiber(int32_t id_, Thread& thread_, uint64_t stackReserveSize);
+    Fiber(const Fiber&) = delete;
+    Fiber& operator=(const Fiber&) = delete;
+    int32_t Id() const { return id; }
+    FiberState State() const { return state; }
+    void SetState(FiberState state_) { state = state_; }
+    Stack& GetStack() { return stack; }
+    const Stack& GetStack() const { return stack; }
+    OperandStack& OpStack() { return opStack; }
+    const OperandStack& OpStack() const { return opStack; }
+    ObjectReference Exception() const { return exception; }
+    std::chrono::steady_clock::time_point WakeTime() const { return wakeTime; }
+    void SetWakeTime(std::chrono::steady_clock::time_point wakeTime_) { wakeTime = wakeTime_; }
+    void AddJoiner(Fiber* joiner) { joiners.push_back(joiner); }
+    std::vector<Fiber*>& Joiners() { return joiners; }
+private:
+    friend class Thread;
+    int32_t id;
+    FiberState state;
+    Stack stack;
+    OperandStack opStack;
+    bool handlingException;
+    std::stack<bool> handlingExceptionStack;
+    ObjectReference exception;
+    ExceptionBlock* currentExceptionBlock;
+    ObjectType* exceptionObjectType;
+    std::chrono::steady_clock::time_point wakeTime;
+    std::vector<Fiber*> joiners;
+};
+
+//  A fiber waiting for a socket to become ready for the given selectRead/selectWrite events of the socket library.
+
+struct SocketWait
+{
+    SocketWait(Fiber* fiber_, int32_t socketHandle_, int32_t events_) : fiber(fiber_), socketHandle(socketHandle_), events(events_), ready(false) {}
+    Fiber* fiber;
+    int32_t socketHandle;
+    int32_t events;
+    bool ready;
+};
+
+//  Sets the ready flag of the socket waits whose sockets are ready, waiting at most timeoutMs milliseconds (-1 = no limit) for one to become ready.
+//  Set by the socket library, which owns the socket handles.
+
+typedef void(*PollSocketsFn)(std::vector<SocketWait>& socketWaits, int timeoutMs);
+
+MACHINE_API void SetPollSocketsFn(PollSocketsFn pollSockets_);
+
+//  The fiber scheduler of a thread is created when the thread starts its first fiber. The code the thread was running becomes its root
+//  fiber. YieldCurrent(), SleepCurrent() and Join() only request a switch; the interpreter loop calls Switch() between instructions. When no
+//  fiber is ready the thread sleeps until the earliest sleeping fiber wakes up. The thread exits when all its fibers have finished, the root fiber
+//  context being restored last, so that the thread ends with the operand stack of its own main function. A join that would leave no fiber able to
+//  run, and a fiber finishing while all the others wait to join, raise a ThreadingException in a joining fiber.
+//
+//  A fiber that would block on a blocking socket waits for it with WaitSocketCurrent(); when no fiber is ready the thread polls the sockets of the
+//  waiting fibers until one becomes ready or the earliest sleeping fiber wakes up.
+//
+//  The scheduler is 1:N, not M:N: fibers are pinned to their thread and switch only at yield, sleep, join and socket waits. File I/O, connecting
+//  a socket, selector waits and condition variable waits block the thread and all its fibers, and fibers are not supported in native code.
+
+class FiberScheduler
+{
+public:
+    FiberScheduler(Thread& thread_);
+    FiberScheduler(const FiberScheduler&) = delete;
+    FiberScheduler& operator=(const FiberScheduler&) = delete;
+    int32_t StartFiber(Function& fun, ObjectReference receiver);
+    void YieldCurrent();
+    void SleepCurrent(std::chrono::nanoseconds duration);
+    bool Join(int32_t fiberId);
+    void WaitSocketCurrent(int32_t socketHandle, int32_t events);
+    bool Switch(bool currentFinished);
+    int32_t CurrentFiberId() const { return current->Id(); }
+    const std::unordered_map<int32_t, std::unique_ptr<Fiber>>& Fibers() const { return fibers; }
+private:
+    Thread& thread;
+    std::unordered_map<int32_t, std::unique_ptr<Fiber>> fibers;
+    std::deque<Fiber*> readyQueue;
+    std::multimap<std::chrono::steady_clock::time_point, Fiber*> sleepers;
+    std::vector<SocketWait> socketWaits;
+    Fiber* root;
+    Fiber* current;
+    Fiber* NextReady();
+    void PollSockets(int timeoutMs);
+    void ResumeWithDeadlockException(Fiber* prev);
+};
+
+} } // namespace cminor::machine
+
+#endif // CMINOR_MACHINE_FIBER_INCLUDED
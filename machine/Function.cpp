@@ -1024,6 +1024,7 @@ public:
     void AddNativeFunction(Function* fun);
     void SortNativeFunctionsByAddress();
     Function* GetNativeFunction(void* rip) const;
+    const std::vector<Function*>& NativeFunctions() const { return nativeFunctions; }
 private:
     static std::unique_ptr<FunctionTableImpl> instance;
     std::unordered_map<StringPtr, Function*, StringPtrHash> functionMap;
@@ -1208,6 +1209,11 @@ MACHINE_API Function* FunctionTable::GetNativeFunction(void* rip)
     return FunctionTableImpl::Instance().GetNativeFunction(rip);
 }
 
+MACHINE_API const std::vector<Function*>& FunctionTable::NativeFunctions()
+{
+    return FunctionTableImpl::Instance().NativeFunctions();
+}
+
 VmFunction::~VmFunction()
 {
 }
@@ -220,6 +220,7 @@ public:
     uint64_t FrameSize() const { return frameSize; }
     void SetFrameSize(uint64_t frameSize_) { frameSize = frameSize_; }
     void AddGCRootStackOffset(int32_t gcRootStackOffset) { gcRootStackOffsets.push_back(gcRootStackOffset); }
+    void ResetGCRootStackOffsets() { gcRootStackOffsets.clear(); }
     const std::vector<int32_t>& GCRootStackOffsets() const { return gcRootStackOffsets; }
     uint32_t LineNumberVarOffset() const { return lineNumberVarOffset; }
     void SetLineNumberVarOffset(uint32_t lineNumberVarOffset_) { lineNumberVarOffset = lineNumberVarOffset_; }
@@ -281,6 +282,7 @@ public:
     MACHINE_API static void AddNativeFunction(Function* fun);
     MACHINE_API static void SortNativeFunctionsByAddress();
     MACHINE_API static Function* GetNativeFunction(void* rip);
+    MACHINE_API static const std::vector<Function*>& NativeFunctions();
 };
 
 class MACHINE_API VmFunction
@@ -270,6 +270,34 @@ inline void GarbageCollector::MarkLiveAllocations(ObjectReference objectReferenc
     }
 }
 
+void GarbageCollector::MarkLiveAllocations(ObjectReference exceptionReference, const OperandStack& operandStack, const Stack& stack, 
+    std::unordered_set<AllocationHandle, AllocationHandleHash>& checked)
+{
+    MarkLiveAllocations(exceptionReference, checked);
+    for (IntegralValue value : operandStack.Values())
+    {
+        if (value.GetType() == ValueType::objectReference)
+        {
+            ObjectReference gcRoot(value.Value());
+            MarkLiveAllocations(gcRoot, checked);
+        }
+    }
+    for (Frame* frame : stack.Frames())
+    {
+        int n = frame->NumLocals();
+        for (int i = 0; i < n; ++i)
+        {
+            const LocalVariable& local = frame->Local(i);
+            IntegralValue value = local.GetValue();
+            if (value.GetType() == ValueType::objectReference)
+            {
+                ObjectReference gcRoot(value.Value());
+                MarkLiveAllocations(gcRoot, checked);
+            }
+        }
+    }
+}
+
 void GarbageCollector::MarkLiveAllocations()
 {
 #ifdef DEBUG_GC
@@ -302,6 +330,11 @@ void GarbageCollector::MarkLiveAllocations()
             }
         }
     }
+    for (const auto& p : memoryPool.InternedStrings())
+    {
+        ObjectReference internedString = p.second;
+        MarkLiveAllocations(internedString, checked);
+    }
     for (const std::unique_ptr<Thread>& thread : machine.Threads())
     {
         if (thread->GetState() == ThreadState::exited)
@@ -311,70 +344,35 @@ void GarbageCollector::MarkLiveAllocations()
 #ifdef DEBUG_GC
         std::cerr << "thread " << thread->Id() << std::endl;
 #endif
-        ObjectReference exceptionReference = thread->Exception();
-        MarkLiveAllocations(exceptionReference, checked);
-        const OperandStack& operandStack = thread->OpStack();
-        for (IntegralValue value : operandStack.Values())
-        {
-            if (value.GetType() == ValueType::objectReference)
-            {
-                ObjectReference gcRoot(value.Value());
-                MarkLiveAllocations(gcRoot, checked);
-            }
-        }
-        for (Frame* frame : thread->GetStack().Frames())
+        MarkLiveAllocations(thread->Exception(), thread->OpStack(), thread->GetStack(), checked);
+        const FiberScheduler* fiberScheduler = thread->GetFiberSchedulerIfStarted();
+        if (fiberScheduler)
         {
-            int n = frame->NumLocals();
-            for (int i = 0; i < n; ++i)
+            for (const auto& p : fiberScheduler->Fibers())
             {
-                const LocalVariable& local = frame->Local(i);
-                IntegralValue value = local.GetValue();
-                if (value.GetType() == ValueType::objectReference)
-                {
-                    ObjectReference gcRoot(value.Value());
-                    MarkLiveAllocations(gcRoot, checked);
-                }
+                const Fiber* fiber = p.second.get();
+                MarkLiveAllocations(fiber->Exception(), fiber->OpStack(), fiber->GetStack(), checked);
             }
         }
         if (RunningNativeCode())
         {
 #ifdef STACK_WALK_GC
             std::vector<uint64_t> roots;
-            void* stackPtr = thread->StackPtr();
-            void* instructionPtr = *reinterpret_cast<void**>(stackPtr);
-            void* framePtr = thread->FramePtr();
-            const Function* threadMain = thread->ThreadMain();
-            Function* fun = FunctionTable::GetNativeFunction(instructionPtr);
-            while (fun)
+            for (NativeFrameWalker walker(*thread); walker.CurrentFunction(); walker.Next())
             {
+                Function* fun = walker.CurrentFunction();
 #ifdef DEBUG_GC
                 std::cerr << fun->MangledName() << std::endl;
 #endif
                 for (int32_t gcRootStackOffset : fun->GCRootStackOffsets())
                 {
-                    uint64_t* rootPtr = reinterpret_cast<uint64_t*>(reinterpret_cast<uint8_t*>(framePtr) + gcRootStackOffset);
+                    uint64_t* rootPtr = reinterpret_cast<uint64_t*>(walker.FramePtr() + gcRootStackOffset);
                     uint64_t root = *rootPtr;
                     if (root != 0)
                     {
                         roots.push_back(root);
                     }
                 }
-                if (fun == threadMain)
-                {
-                    break;
-                }
-                if (fun->FrameSize() == -1)
-                {
-                    throw std::runtime_error("cannot walk: frame size -1 encountered");
-                }
-                else
-                {
-                    stackPtr = reinterpret_cast<uint8_t*>(stackPtr) + fun->FrameSize();
-                }
-                framePtr = *reinterpret_cast<void**>(stackPtr);
-                stackPtr = reinterpret_cast<uint8_t*>(stackPtr) + 8;
-                instructionPtr = *reinterpret_cast<void**>(stackPtr);
-                fun = FunctionTable::GetNativeFunction(instructionPtr);
             }
 #ifdef DEBUG_GC
             std::cerr << roots.size() << " roots found" << std::endl;
@@ -21,6 +21,8 @@ extern MutexOwner gc;
 extern Mutex garbageCollectorMutex;
 
 class Machine;
+class OperandStack;
+class Stack;
 
 enum class GarbageCollectorState
 {
@@ -67,6 +69,8 @@ private:
     void WaitForThreadsRunning();
     void CollectGarbage();
     void MarkLiveAllocations(ObjectReference objectReference, std::unordered_set<AllocationHandle, AllocationHandleHash>& checked);
+    void MarkLiveAllocations(ObjectReference exceptionReference, const OperandStack& operandStack, const Stack& stack, 
+        std::unordered_set<AllocationHandle, AllocationHandleHash>& checked);
     void MarkLiveAllocations();
 };
 
@@ -15,6 +15,7 @@
 #include <cminor/machine/Class.hpp>
 #include <cminor/machine/Type.hpp>
 #include <cminor/machine/MachineFunctionVisitor.hpp>
+#include <cminor/machine/ExecutionProfile.hpp>
 
 namespace cminor { namespace machine {
 
@@ -556,7 +557,7 @@ void StoreLocalSInst::Accept(MachineFunctionVisitor& visitor)
     visitor.VisitStoreLocalInst(Index());
 }
 
-LoadFieldInst::LoadFieldInst() : IndexParamInst("loadfield"), fieldType(ValueType::none)
+LoadFieldInst::LoadFieldInst() : IndexParamInst("loadfield"), fieldType(ValueType::none), fieldOffset(-1)
 {
 }
 
@@ -564,12 +565,14 @@ void LoadFieldInst::Encode(Writer& writer)
 {
     IndexParamInst::Encode(writer);
     writer.Put(uint8_t(fieldType));
+    writer.Put(fieldOffset);
 }
 
 Instruction* LoadFieldInst::Decode(Reader& reader)
 {
     IndexParamInst::Decode(reader);
     fieldType = ValueType(reader.GetByte());
+    fieldOffset = reader.GetInt();
     return this;
 }
 
@@ -595,10 +598,10 @@ void LoadFieldInst::Execute(Frame& frame)
 
 void LoadFieldInst::Accept(MachineFunctionVisitor& visitor)
 {
-    visitor.VisitLoadFieldInst(Index(), fieldType);
+    visitor.VisitLoadFieldInst(Index(), fieldOffset, fieldType);
 }
 
-LoadField0Inst::LoadField0Inst() : Instruction("loadfield.0"), fieldType(ValueType::none)
+LoadField0Inst::LoadField0Inst() : Instruction("loadfield.0"), fieldType(ValueType::none), fieldOffset(-1)
 {
 }
 
@@ -606,12 +609,14 @@ void LoadField0Inst::Encode(Writer& writer)
 {
     Instruction::Encode(writer);
     writer.Put(uint8_t(fieldType));
+    writer.Put(fieldOffset);
 }
 
 Instruction* LoadField0Inst::Decode(Reader& reader)
 {
     Instruction::Decode(reader);
     fieldType = ValueType(reader.GetByte());
+    fieldOffset = reader.GetInt();
     return this;
 }
 
@@ -637,10 +642,10 @@ void LoadField0Inst::Execute(Frame& frame)
 
 void LoadField0Inst::Accept(MachineFunctionVisitor& visitor)
 {
-    visitor.VisitLoadFieldInst(0, fieldType);
+    visitor.VisitLoadFieldInst(0, fieldOffset, fieldType);
 }
 
-LoadField1Inst::LoadField1Inst() : Instruction("loadfield.1"), fieldType(ValueType::none)
+LoadField1Inst::LoadField1Inst() : Instruction("loadfield.1"), fieldType(ValueType::none), fieldOffset(-1)
 {
 }
 
@@ -648,12 +653,14 @@ void LoadField1Inst::Encode(Writer& writer)
 {
     Instruction::Encode(writer);
     writer.Put(uint8_t(fieldType));
+    writer.Put(fieldOffset);
 }
 
 Instruction* LoadField1Inst::Decode(Reader& reader)
 {
     Instruction::Decode(reader);
     fieldType = ValueType(reader.GetByte());
+    fieldOffset = reader.GetInt();
     return this;
 }
 
@@ -679,10 +686,10 @@ void LoadField1Inst::Execute(Frame& frame)
 
 void LoadField1Inst::Accept(MachineFunctionVisitor& visitor)
 {
-    visitor.VisitLoadFieldInst(1, fieldType);
+    visitor.VisitLoadFieldInst(1, fieldOffset, fieldType);
 }
 
-LoadField2Inst::LoadField2Inst() : Instruction("loadfield.2"), fieldType(ValueType::none)
+LoadField2Inst::LoadField2Inst() : Instruction("loadfield.2"), fieldType(ValueType::none), fieldOffset(-1)
 {
 }
 
@@ -690,12 +697,14 @@ void LoadField2Inst::Encode(Writer& writer)
 {
     Instruction::Encode(writer);
     writer.Put(uint8_t(fieldType));
+    writer.Put(fieldOffset);
 }
 
 Instruction* LoadField2Inst::Decode(Reader& reader)
 {
     Instruction::Decode(reader);
     fieldType = ValueType(reader.GetByte());
+    fieldOffset = reader.GetInt();
     return this;
 }
 
@@ -721,10 +730,10 @@ void LoadField2Inst::Execute(Frame& frame)
 
 void LoadField2Inst::Accept(MachineFunctionVisitor& visitor)
 {
-    visitor.VisitLoadFieldInst(2, fieldType);
+    visitor.VisitLoadFieldInst(2, fieldOffset, fieldType);
 }
 
-LoadField3Inst::LoadField3Inst() : Instruction("loadfield.3"), fieldType(ValueType::none)
+LoadField3Inst::LoadField3Inst() : Instruction("loadfield.3"), fieldType(ValueType::none), fieldOffset(-1)
 {
 }
 
@@ -732,12 +741,14 @@ void LoadField3Inst::Encode(Writer& writer)
 {
     Instruction::Encode(writer);
     writer.Put(uint8_t(fieldType));
+    writer.Put(fieldOffset);
 }
 
 Instruction* LoadField3Inst::Decode(Reader& reader)
 {
     Instruction::Decode(reader);
     fieldType = ValueType(reader.GetByte());
+    fieldOffset = reader.GetInt();
     return this;
 }
 
@@ -763,10 +774,10 @@ void LoadField3Inst::Execute(Frame& frame)
 
 void LoadField3Inst::Accept(MachineFunctionVisitor& visitor)
 {
-    visitor.VisitLoadFieldInst(3, fieldType);
+    visitor.VisitLoadFieldInst(3, fieldOffset, fieldType);
 }
 
-LoadFieldBInst::LoadFieldBInst() : ByteParamInst("loadfield.b"), fieldType(ValueType::none)
+LoadFieldBInst::LoadFieldBInst() : ByteParamInst("loadfield.b"), fieldType(ValueType::none), fieldOffset(-1)
 {
 }
 
@@ -774,12 +785,14 @@ void LoadFieldBInst::Encode(Writer& writer)
 {
     ByteParamInst::Encode(writer);
     writer.Put(uint8_t(fieldType));
+    writer.Put(fieldOffset);
 }
 
 Instruction* LoadFieldBInst::Decode(Reader& reader)
 {
     ByteParamInst::Decode(reader);
     fieldType = ValueType(reader.GetByte());
+    fieldOffset = reader.GetInt();
     return this;
 }
 
@@ -805,10 +818,10 @@ void LoadFieldBInst::Execute(Frame& frame)
 
 void LoadFieldBInst::Accept(MachineFunctionVisitor& visitor)
 {
-    visitor.VisitLoadFieldInst(Index(), fieldType);
+    visitor.VisitLoadFieldInst(Index(), fieldOffset, fieldType);
 }
 
-LoadFieldSInst::LoadFieldSInst() : UShortParamInst("loadfield.s"), fieldType(ValueType::none)
+LoadFieldSInst::LoadFieldSInst() : UShortParamInst("loadfield.s"), fieldType(ValueType::none), fieldOffset(-1)
 {
 }
 
@@ -816,12 +829,14 @@ void LoadFieldSInst::Encode(Writer& writer)
 {
     UShortParamInst::Encode(writer);
     writer.Put(uint8_t(fieldType));
+    writer.Put(fieldOffset);
 }
 
 Instruction* LoadFieldSInst::Decode(Reader& reader)
 {
     UShortParamInst::Decode(reader);
     fieldType = ValueType(reader.GetByte());
+    fieldOffset = reader.GetInt();
     return this;
 }
 
@@ -847,10 +862,10 @@ void LoadFieldSInst::Execute(Frame& frame)
 
 void LoadFieldSInst::Accept(MachineFunctionVisitor& visitor)
 {
-    visitor.VisitLoadFieldInst(Index(), fieldType);
+    visitor.VisitLoadFieldInst(Index(), fieldOffset, fieldType);
 }
 
-StoreFieldInst::StoreFieldInst() : IndexParamInst("storefield"), fieldType(ValueType::none)
+StoreFieldInst::StoreFieldInst() : IndexParamInst("storefield"), fieldType(ValueType::none), fieldOffset(-1)
 {
 }
 
@@ -858,12 +873,14 @@ void StoreFieldInst::Encode(Writer& writer)
 {
     IndexParamInst::Encode(writer);
     writer.Put(uint8_t(fieldType));
+    writer.Put(fieldOffset);
 }
 
 Instruction* StoreFieldInst::Decode(Reader& reader)
 {
     IndexParamInst::Decode(reader);
     fieldType = ValueType(reader.GetByte());
+    fieldOffset = reader.GetInt();
     return this;
 }
 
@@ -889,10 +906,10 @@ void StoreFieldInst::Execute(Frame& frame)
 
 void StoreFieldInst::Accept(MachineFunctionVisitor& visitor)
 {
-    visitor.VisitStoreFieldInst(Index(), fieldType);
+    visitor.VisitStoreFieldInst(Index(), fieldOffset, fieldType);
 }
 
-StoreField0Inst::StoreField0Inst() : Instruction("storefield.0"), fieldType(ValueType::none)
+StoreField0Inst::StoreField0Inst() : Instruction("storefield.0"), fieldType(ValueType::none), fieldOffset(-1)
 {
 }
 
@@ -900,12 +917,14 @@ void StoreField0Inst::Encode(Writer& writer)
 {
     Instruction::Encode(writer);
     writer.Put(uint8_t(fieldType));
+    writer.Put(fieldOffset);
 }
 
 Instruction* StoreField0Inst::Decode(Reader& reader)
 {
     Instruction::Decode(reader);
     fieldType = ValueType(reader.GetByte());
+    fieldOffset = reader.GetInt();
     return this;
 }
 
@@ -931,10 +950,10 @@ void StoreField0Inst::Execute(Frame& frame)
 
 void StoreField0Inst::Accept(MachineFunctionVisitor& visitor)
 {
-    visitor.VisitStoreFieldInst(0, fieldType);
+    visitor.VisitStoreFieldInst(0, fieldOffset, fieldType);
 }
 
-StoreField1Inst::StoreField1Inst() : Instruction("storefield.1"), fieldType(ValueType::none)
+StoreField1Inst::StoreField1Inst() : Instruction("storefield.1"), fieldType(ValueType::none), fieldOffset(-1)
 {
 }
 
@@ -942,12 +961,14 @@ void StoreField1Inst::Encode(Writer& writer)
 {
     Instruction::Encode(writer);
     writer.Put(uint8_t(fieldType));
+    writer.Put(fieldOffset);
 }
 
 Instruction* StoreField1Inst::Decode(Reader& reader)
 {
     Instruction::Decode(reader);
     fieldType = ValueType(reader.GetByte());
+    fieldOffset = reader.GetInt();
     return this;
 }
 
@@ -973,10 +994,10 @@ void StoreField1Inst::Execute(Frame& frame)
 
 void StoreField1Inst::Accept(MachineFunctionVisitor& visitor)
 {
-    visitor.VisitStoreFieldInst(1, fieldType);
+    visitor.VisitStoreFieldInst(1, fieldOffset, fieldType);
 }
 
-StoreField2Inst::StoreField2Inst() : Instruction("storefield.2"), fieldType(ValueType::none)
+StoreField2Inst::StoreField2Inst() : Instruction("storefield.2"), fieldType(ValueType::none), fieldOffset(-1)
 {
 }
 
@@ -984,12 +1005,14 @@ void StoreField2Inst::Encode(Writer& writer)
 {
     Instruction::Encode(writer);
     writer.Put(uint8_t(fieldType));
+    writer.Put(fieldOffset);
 }
 
 Instruction* StoreField2Inst::Decode(Reader& reader)
 {
     Instruction::Decode(reader);
     fieldType = ValueType(reader.GetByte());
+    fieldOffset = reader.GetInt();
     return this;
 }
 
@@ -1015,10 +1038,10 @@ void StoreField2Inst::Execute(Frame& frame)
 
 void StoreField2Inst::Accept(MachineFunctionVisitor& visitor)
 {
-    visitor.VisitStoreFieldInst(2, fieldType);
+    visitor.VisitStoreFieldInst(2, fieldOffset, fieldType);
 }
 
-StoreField3Inst::StoreField3Inst() : Instruction("storefield.3"), fieldType(ValueType::none)
+StoreField3Inst::StoreField3Inst() : Instruction("storefield.3"), fieldType(ValueType::none), fieldOffset(-1)
 {
 }
 
@@ -1026,12 +1049,14 @@ void StoreField3Inst::Encode(Writer& writer)
 {
     Instruction::Encode(writer);
     writer.Put(uint8_t(fieldType));
+    writer.Put(fieldOffset);
 }
 
 Instruction* StoreField3Inst::Decode(Reader& reader)
 {
     Instruction::Decode(reader);
     fieldType = ValueType(reader.GetByte());
+    fieldOffset = reader.GetInt();
     return this;
 }
 
@@ -1057,10 +1082,10 @@ void StoreField3Inst::Execute(Frame& frame)
 
 void StoreField3Inst::Accept(MachineFunctionVisitor& visitor)
 {
-    visitor.VisitStoreFieldInst(3, fieldType);
+    visitor.VisitStoreFieldInst(3, fieldOffset, fieldType);
 }
 
-StoreFieldBInst::StoreFieldBInst() : ByteParamInst("storefield.b"), fieldType(ValueType::none)
+StoreFieldBInst::StoreFieldBInst() : ByteParamInst("storefield.b"), fieldType(ValueType::none), fieldOffset(-1)
 {
 }
 
@@ -1068,12 +1093,14 @@ void StoreFieldBInst::Encode(Writer& writer)
 {
     ByteParamInst::Encode(writer);
     writer.Put(uint8_t(fieldType));
+    writer.Put(fieldOffset);
 }
 
 Instruction* StoreFieldBInst::Decode(Reader& reader)
 {
     ByteParamInst::Decode(reader);
     fieldType = ValueType(reader.GetByte());
+    fieldOffset = reader.GetInt();
     return this;
 }
 
@@ -1099,10 +1126,10 @@ void StoreFieldBInst::Execute(Frame& frame)
 
 void StoreFieldBInst::Accept(MachineFunctionVisitor& visitor)
 {
-    visitor.VisitStoreFieldInst(Index(), fieldType);
+    visitor.VisitStoreFieldInst(Index(), fieldOffset, fieldType);
 }
 
-StoreFieldSInst::StoreFieldSInst() : UShortParamInst("storefield.s"), fieldType(ValueType::none)
+StoreFieldSInst::StoreFieldSInst() : UShortParamInst("storefield.s"), fieldType(ValueType::none), fieldOffset(-1)
 {
 }
 
@@ -1110,12 +1137,14 @@ void StoreFieldSInst::Encode(Writer& writer)
 {
     UShortParamInst::Encode(writer);
     writer.Put(uint8_t(fieldType));
+    writer.Put(fieldOffset);
 }
 
 Instruction* StoreFieldSInst::Decode(Reader& reader)
 {
     UShortParamInst::Decode(reader);
     fieldType = ValueType(reader.GetByte());
+    fieldOffset = reader.GetInt();
     return this;
 }
 
@@ -1141,7 +1170,7 @@ void StoreFieldSInst::Execute(Frame& frame)
 
 void StoreFieldSInst::Accept(MachineFunctionVisitor& visitor)
 {
-    visitor.VisitStoreFieldInst(Index(), fieldType);
+    visitor.VisitStoreFieldInst(Index(), fieldOffset, fieldType);
 }
 
 LoadElemInst::LoadElemInst() : Instruction("loadarrayelem"), elemType(ValueType::none)
@@ -1359,6 +1388,10 @@ void JumpTrueInst::Execute(Frame& frame)
 {
     IntegralValue value = frame.OpStack().Pop();
     Assert(value.GetType() == ValueType::boolType, "bool operand expected");
+    if (executionProfilingEnabled)
+    {
+        RecordBranch(frame.Fun(), frame.PrevPC(), value.AsBool());
+    }
     if (value.AsBool())
     {
         frame.SetPC(Index());
@@ -1397,6 +1430,10 @@ void JumpFalseInst::Execute(Frame& frame)
 {
     IntegralValue value = frame.OpStack().Pop();
     Assert(value.GetType() == ValueType::boolType, "bool operand expected");
+    if (executionProfilingEnabled)
+    {
+        RecordBranch(frame.Fun(), frame.PrevPC(), !value.AsBool());
+    }
     if (!value.AsBool())
     {
         frame.SetPC(Index());
@@ -1525,12 +1562,20 @@ void ContinuousSwitchInst::Execute(Frame& frame)
     IntegralValue cond = frame.OpStack().Pop();
     if (cond.Value() < begin.Value() || cond.Value() > end.Value())
     {
+        if (executionProfilingEnabled)
+        {
+            RecordSwitch(frame.Fun(), frame.PrevPC(), int32_t(targets.size()), int32_t(targets.size()));
+        }
         frame.SetPC(defaultTarget);
     }
     else
     {
         uint64_t index = cond.Value() - begin.Value();
         Assert(index >= 0 && index < targets.size(), "invalid switch index");
+        if (executionProfilingEnabled)
+        {
+            RecordSwitch(frame.Fun(), frame.PrevPC(), int32_t(index), int32_t(targets.size()));
+        }
         frame.SetPC(targets[index]);
     }
 }
@@ -1626,10 +1671,18 @@ void BinarySearchSwitchInst::Execute(Frame& frame)
     const auto& it = std::lower_bound(targets.cbegin(), targets.cend(), x, IntegralValueLess());
     if (it != targets.cend() && it->first.Value() == cond.Value())
     {
+        if (executionProfilingEnabled)
+        {
+            RecordSwitch(frame.Fun(), frame.PrevPC(), int32_t(it - targets.cbegin()), int32_t(targets.size()));
+        }
         frame.SetPC(it->second);
     }
     else
     {
+        if (executionProfilingEnabled)
+        {
+            RecordSwitch(frame.Fun(), frame.PrevPC(), int32_t(targets.size()), int32_t(targets.size()));
+        }
         frame.SetPC(defaultTarget);
     }
 }
@@ -1802,6 +1855,7 @@ void VirtualCallInst::Clear()
 {
     numArgs = 0;
     vmtIndex = -1;
+    className = Constant();
 }
 
 void VirtualCallInst::SetFunctionType(const FunctionType& functionType_)
@@ -1809,6 +1863,18 @@ void VirtualCallInst::SetFunctionType(const FunctionType& functionType_)
     functionType = functionType_;
 }
 
+void VirtualCallInst::SetClassName(Constant className_)
+{
+    Assert(className_.Value().GetType() == ValueType::stringLiteral, "string literal expected");
+    className = className_;
+}
+
+StringPtr VirtualCallInst::GetClassName() const
+{
+    Assert(className.Value().GetType() == ValueType::stringLiteral, "string literal expected");
+    return StringPtr(className.Value().AsStringLiteral());
+}
+
 void VirtualCallInst::Encode(Writer& writer)
 {
     Instruction::Encode(writer);
@@ -1817,6 +1883,9 @@ void VirtualCallInst::Encode(Writer& writer)
     Assert(vmtIndex != -1, "invalid vmt index");
     writer.PutEncodedUInt(vmtIndex);
     functionType.Write(writer);
+    ConstantId classNameId = writer.GetConstantPool()->GetIdFor(className);
+    Assert(classNameId != noConstantId, "id for class name not found");
+    classNameId.Write(writer);
 }
 
 Instruction* VirtualCallInst::Decode(Reader& reader)
@@ -1825,6 +1894,9 @@ Instruction* VirtualCallInst::Decode(Reader& reader)
     numArgs = reader.GetEncodedUInt();
     vmtIndex = reader.GetEncodedUInt();
     functionType.Read(reader);
+    ConstantId classNameId;
+    classNameId.Read(reader);
+    className = reader.GetConstantPool()->GetConstant(classNameId);
     return this;
 }
 
@@ -1897,6 +1969,7 @@ void InterfaceCallInst::Clear()
 {
     numArgs = 0;
     imtIndex = -1;
+    interfaceName = Constant();
 }
 
 void InterfaceCallInst::SetFunctionType(const FunctionType& functionType_)
@@ -1904,6 +1977,18 @@ void InterfaceCallInst::SetFunctionType(const FunctionType& functionType_)
     functionType = functionType_;
 }
 
+void InterfaceCallInst::SetInterfaceName(Constant interfaceName_)
+{
+    Assert(interfaceName_.Value().GetType() == ValueType::stringLiteral, "string literal expected");
+    interfaceName = interfaceName_;
+}
+
+StringPtr InterfaceCallInst::GetInterfaceName() const
+{
+    Assert(interfaceName.Value().GetType() == ValueType::stringLiteral, "string literal expected");
+    return StringPtr(interfaceName.Value().AsStringLiteral());
+}
+
 void InterfaceCallInst::Encode(Writer& writer)
 {
     Instruction::Encode(writer);
@@ -1912,6 +1997,9 @@ void InterfaceCallInst::Encode(Writer& writer)
     Assert(imtIndex != -1, "invalid imt index");
     writer.PutEncodedUInt(imtIndex);
     functionType.Write(writer);
+    ConstantId interfaceNameId = writer.GetConstantPool()->GetIdFor(interfaceName);
+    Assert(interfaceNameId != noConstantId, "id for interface name not found");
+    interfaceNameId.Write(writer);
 }
 
 Instruction* InterfaceCallInst::Decode(Reader& reader)
@@ -1920,6 +2008,9 @@ Instruction* InterfaceCallInst::Decode(Reader& reader)
     numArgs = reader.GetEncodedUInt();
     imtIndex = reader.GetEncodedUInt();
     functionType.Read(reader);
+    ConstantId interfaceNameId;
+    interfaceNameId.Read(reader);
+    interfaceName = reader.GetConstantPool()->GetConstant(interfaceNameId);
     return this;
 }
 
@@ -2391,15 +2482,7 @@ void StrLitToStringInst::Execute(Frame& frame)
         IntegralValue value = frame.OpStack().Pop();
         Assert(value.GetType() == ValueType::stringLiteral, "string literal expected");
         const char32_t* strLit = value.AsStringLiteral();
-        uint32_t len = static_cast<uint32_t>(StringLen(strLit));
-        ClassData* classData = ClassDataTable::GetSystemStringClassData();
-        ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
-        std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
-        ObjectReference objectReference = memoryPool.CreateObject(frame.GetThread(), classData->Type(), lock);
-        AllocationHandle charsHandle = memoryPool.CreateStringCharsFromLiteral(frame.GetThread(), strLit, len, lock);
-        memoryPool.SetField(objectReference, 0, IntegralValue(classData), lock);
-        memoryPool.SetField(objectReference, 1, MakeIntegralValue<int32_t>(static_cast<int32_t>(len), ValueType::intType), lock);
-        memoryPool.SetField(objectReference, 2, charsHandle, lock);
+        ObjectReference objectReference = GetManagedMemoryPool().InternStringLiteral(frame.GetThread(), strLit);
         frame.OpStack().Push(objectReference);
     }
     catch (const NullReferenceException& ex)
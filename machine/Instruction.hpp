@@ -450,6 +450,7 @@ class MACHINE_API LoadFieldInst : public IndexParamInst
 public:
     LoadFieldInst();
     void SetFieldType(ValueType fieldType_) { fieldType = fieldType_; }
+    void SetFieldOffset(int32_t fieldOffset_) { fieldOffset = fieldOffset_; }
     Instruction* Clone() const override { return new LoadFieldInst(*this); }
     void Encode(Writer& writer) override;
     Instruction* Decode(Reader& reader) override;
@@ -457,6 +458,7 @@ public:
     void Accept(MachineFunctionVisitor& visitor) override;
 private:
     ValueType fieldType;
+    int32_t fieldOffset;
 };
 
 class MACHINE_API LoadField0Inst : public Instruction
@@ -464,6 +466,7 @@ class MACHINE_API LoadField0Inst : public Instruction
 public:
     LoadField0Inst();
     void SetFieldType(ValueType fieldType_) { fieldType = fieldType_; }
+    void SetFieldOffset(int32_t fieldOffset_) { fieldOffset = fieldOffset_; }
     Instruction* Clone() const override { return new LoadField0Inst(*this); }
     void Encode(Writer& writer) override;
     Instruction* Decode(Reader& reader) override;
@@ -471,6 +474,7 @@ public:
     void Accept(MachineFunctionVisitor& visitor) override;
 private:
     ValueType fieldType;
+    int32_t fieldOffset;
 };
 
 class MACHINE_API LoadField1Inst : public Instruction
@@ -478,6 +482,7 @@ class MACHINE_API LoadField1Inst : public Instruction
 public:
     LoadField1Inst();
     void SetFieldType(ValueType fieldType_) { fieldType = fieldType_; }
+    void SetFieldOffset(int32_t fieldOffset_) { fieldOffset = fieldOffset_; }
     Instruction* Clone() const override { return new LoadField1Inst(*this); }
     void Encode(Writer& writer) override;
     Instruction* Decode(Reader& reader) override;
@@ -485,6 +490,7 @@ public:
     void Accept(MachineFunctionVisitor& visitor) override;
 private:
     ValueType fieldType;
+    int32_t fieldOffset;
 };
 
 class MACHINE_API LoadField2Inst : public Instruction
@@ -492,6 +498,7 @@ class MACHINE_API LoadField2Inst : public Instruction
 public:
     LoadField2Inst();
     void SetFieldType(ValueType fieldType_) { fieldType = fieldType_; }
+    void SetFieldOffset(int32_t fieldOffset_) { fieldOffset = fieldOffset_; }
     Instruction* Clone() const override { return new LoadField2Inst(*this); }
     void Encode(Writer& writer) override;
     Instruction* Decode(Reader& reader) override;
@@ -499,6 +506,7 @@ public:
     void Accept(MachineFunctionVisitor& visitor) override;
 private:
     ValueType fieldType;
+    int32_t fieldOffset;
 };
 
 class MACHINE_API LoadField3Inst : public Instruction
@@ -506,6 +514,7 @@ class MACHINE_API LoadField3Inst : public Instruction
 public:
     LoadField3Inst();
     void SetFieldType(ValueType fieldType_) { fieldType = fieldType_; }
+    void SetFieldOffset(int32_t fieldOffset_) { fieldOffset = fieldOffset_; }
     Instruction* Clone() const override { return new LoadField3Inst(*this); }
     void Encode(Writer& writer) override;
     Instruction* Decode(Reader& reader) override;
@@ -513,6 +522,7 @@ public:
     void Accept(MachineFunctionVisitor& visitor) override;
 private:
     ValueType fieldType;
+    int32_t fieldOffset;
 };
 
 class MACHINE_API LoadFieldBInst : public ByteParamInst
@@ -520,6 +530,7 @@ class MACHINE_API LoadFieldBInst : public ByteParamInst
 public:
     LoadFieldBInst();
     void SetFieldType(ValueType fieldType_) { fieldType = fieldType_; }
+    void SetFieldOffset(int32_t fieldOffset_) { fieldOffset = fieldOffset_; }
     Instruction* Clone() const override { return new LoadFieldBInst(*this); }
     void Encode(Writer& writer) override;
     Instruction* Decode(Reader& reader) override;
@@ -527,6 +538,7 @@ public:
     void Accept(MachineFunctionVisitor& visitor) override;
 private:
     ValueType fieldType;
+    int32_t fieldOffset;
 };
 
 class MACHINE_API LoadFieldSInst : public UShortParamInst
@@ -534,6 +546,7 @@ class MACHINE_API LoadFieldSInst : public UShortParamInst
 public:
     LoadFieldSInst();
     void SetFieldType(ValueType fieldType_) { fieldType = fieldType_; }
+    void SetFieldOffset(int32_t fieldOffset_) { fieldOffset = fieldOffset_; }
     Instruction* Clone() const override { return new LoadFieldSInst(*this); }
     void Encode(Writer& writer) override;
     Instruction* Decode(Reader& reader) override;
@@ -541,6 +554,7 @@ public:
     void Accept(MachineFunctionVisitor& visitor) override;
 private:
     ValueType fieldType;
+    int32_t fieldOffset;
 };
 
 class MACHINE_API StoreFieldInst : public IndexParamInst
@@ -548,6 +562,7 @@ class MACHINE_API StoreFieldInst : public IndexParamInst
 public:
     StoreFieldInst();
     void SetFieldType(ValueType fieldType_) { fieldType = fieldType_; }
+    void SetFieldOffset(int32_t fieldOffset_) { fieldOffset = fieldOffset_; }
     Instruction* Clone() const override { return new StoreFieldInst(*this); }
     void Encode(Writer& writer) override;
     Instruction* Decode(Reader& reader) override;
@@ -555,6 +570,7 @@ public:
     void Accept(MachineFunctionVisitor& visitor) override;
 private:
     ValueType fieldType;
+    int32_t fieldOffset;
 };
 
 class MACHINE_API StoreField0Inst : public Instruction
@@ -562,6 +578,7 @@ class MACHINE_API StoreField0Inst : public Instruction
 public:
     StoreField0Inst();
     void SetFieldType(ValueType fieldType_) { fieldType = fieldType_; }
+    void SetFieldOffset(int32_t fieldOffset_) { fieldOffset = fieldOffset_; }
     Instruction* Clone() const override { return new StoreField0Inst(*this); }
     void Encode(Writer& writer) override;
     Instruction* Decode(Reader& reader) override;
@@ -569,6 +586,7 @@ public:
     void Accept(MachineFunctionVisitor& visitor) override;
 private:
     ValueType fieldType;
+    int32_t fieldOffset;
 };
 
 class MACHINE_API StoreField1Inst : public Instruction
@@ -576,6 +594,7 @@ class MACHINE_API StoreField1Inst : public Instruction
 public:
     StoreField1Inst();
     void SetFieldType(ValueType fieldType_) { fieldType = fieldType_; }
+    void SetFieldOffset(int32_t fieldOffset_) { fieldOffset = fieldOffset_; }
     Instruction* Clone() const override { return new StoreField1Inst(*this); }
     void Encode(Writer& writer) override;
     Instruction* Decode(Reader& reader) override;
@@ -583,6 +602,7 @@ public:
     void Accept(MachineFunctionVisitor& visitor) override;
 private:
     ValueType fieldType;
+    int32_t fieldOffset;
 };
 
 class MACHINE_API StoreField2Inst : public Instruction
@@ -590,6 +610,7 @@ class MACHINE_API StoreField2Inst : public Instruction
 public:
     StoreField2Inst();
     void SetFieldType(ValueType fieldType_) { fieldType = fieldType_; }
+    void SetFieldOffset(int32_t fieldOffset_) { fieldOffset = fieldOffset_; }
     Instruction* Clone() const override { return new StoreField2Inst(*this); }
     void Encode(Writer& writer) override;
     Instruction* Decode(Reader& reader) override;
@@ -597,6 +618,7 @@ public:
     void Accept(MachineFunctionVisitor& visitor) override;
 private:
     ValueType fieldType;
+    int32_t fieldOffset;
 };
 
 class MACHINE_API StoreField3Inst : public Instruction
@@ -604,6 +626,7 @@ class MACHINE_API StoreField3Inst : public Instruction
 public:
     StoreField3Inst();
     void SetFieldType(ValueType fieldType_) { fieldType = fieldType_; }
+    void SetFieldOffset(int32_t fieldOffset_) { fieldOffset = fieldOffset_; }
     Instruction* Clone() const override { return new StoreField3Inst(*this); }
     void Encode(Writer& writer) override;
     Instruction* Decode(Reader& reader) override;
@@ -611,6 +634,7 @@ public:
     void Accept(MachineFunctionVisitor& visitor) override;
 private:
     ValueType fieldType;
+    int32_t fieldOffset;
 };
 
 class MACHINE_API StoreFieldBInst : public ByteParamInst
@@ -618,6 +642,7 @@ class MACHINE_API StoreFieldBInst : public ByteParamInst
 public:
     StoreFieldBInst();
     void SetFieldType(ValueType fieldType_) { fieldType = fieldType_; }
+    void SetFieldOffset(int32_t fieldOffset_) { fieldOffset = fieldOffset_; }
     Instruction* Clone() const override { return new StoreFieldBInst(*this); }
     void Encode(Writer& writer) override;
     Instruction* Decode(Reader& reader) override;
@@ -625,6 +650,7 @@ public:
     void Accept(MachineFunctionVisitor& visitor) override;
 private:
     ValueType fieldType;
+    int32_t fieldOffset;
 };
 
 class MACHINE_API StoreFieldSInst : public UShortParamInst
@@ -632,6 +658,7 @@ class MACHINE_API StoreFieldSInst : public UShortParamInst
 public:
     StoreFieldSInst();
     void SetFieldType(ValueType fieldType_) { fieldType = fieldType_; }
+    void SetFieldOffset(int32_t fieldOffset_) { fieldOffset = fieldOffset_; }
     Instruction* Clone() const override { return new StoreFieldSInst(*this); }
     void Encode(Writer& writer) override;
     Instruction* Decode(Reader& reader) override;
@@ -639,6 +666,7 @@ public:
     void Accept(MachineFunctionVisitor& visitor) override;
 private:
     ValueType fieldType;
+    int32_t fieldOffset;
 };
 
 class MACHINE_API LoadElemInst : public Instruction
@@ -900,6 +928,8 @@ public:
     uint32_t VmtIndex() const { return vmtIndex; }
     void SetFunctionType(const FunctionType& functionType_);
     const FunctionType& GetFunctionType() const { return functionType; }
+    void SetClassName(Constant className_);
+    StringPtr GetClassName() const;
     Instruction* Clone() const override { return new VirtualCallInst(*this); }
     void Encode(Writer& writer) override;
     Instruction* Decode(Reader& reader) override;
@@ -911,6 +941,7 @@ private:
     uint32_t numArgs;
     uint32_t vmtIndex;
     FunctionType functionType;
+    Constant className;
 };
 
 class MACHINE_API InterfaceCallInst : public Instruction
@@ -927,6 +958,8 @@ public:
     uint32_t ImtIndex() const { return imtIndex; }
     void SetFunctionType(const FunctionType& functionType_);
     const FunctionType& GetFunctionType() const { return functionType; }
+    void SetInterfaceName(Constant interfaceName_);
+    StringPtr GetInterfaceName() const;
     void Execute(Frame& frame) override;
     void Dump(CodeFormatter& formatter) override;
     bool CreatesTemporaryObject(Function* function) const override;
@@ -935,6 +968,7 @@ private:
     uint32_t numArgs;
     uint32_t imtIndex;
     FunctionType functionType;
+    Constant interfaceName;
 };
 
 class MACHINE_API VmCallInst : public IndexParamInst
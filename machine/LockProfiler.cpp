@@ -0,0 +1,337 @@
+// =================================
+// Copyright (c) 2017 Seppo Laakko
+// Distributed under the MIT license
+// =================================
+
+#include <cminor/machine/LockProfiler.hpp>
+#include <cminor/machine/Machine.hpp>
+#include <cminor/machine/Runtime.hpp>
+#include <cminor/machine/Thread.hpp>
+#include <cminor/machine/Function.hpp>
+#include <cminor/util/Unicode.hpp>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace cminor { namespace machine {
+
+using namespace cminor::unicode;
+
+const int numReportedCallSites = 3;
+const int numReportedLocks = 20;
+
+struct CallSiteStats
+{
+    CallSiteStats() : waitCount(0), totalWaitNs(0), maxWaitNs(0) {}
+    int64_t waitCount;
+    int64_t totalWaitNs;
+    int64_t maxWaitNs;
+};
+
+struct LockStats
+{
+    LockStats() : kind(LockKind::monitor), acquireCount(0), contendedCount(0), totalWaitNs(0), maxWaitNs(0) {}
+    LockKind kind;
+    std::string typeName;
+    int64_t acquireCount;
+    int64_t contendedCount;
+    int64_t totalWaitNs;
+    int64_t maxWaitNs;
+    std::map<std::string, CallSiteStats> callSites;
+};
+
+//  Each thread records its lock statistics in its own table, so recording does not serialize the threads. The per-thread mutex is contended only
+//  when the statistics are reported. Thread tables are kept after their thread exits and merged when the statistics are reported.
+
+typedef std::map<std::pair<LockKind, uint64_t>, LockStats> LockStatsMap;
+
+struct ThreadLockStats
+{
+    std::mutex mtx;
+    LockStatsMap lockStatsMap;
+};
+
+std::atomic<bool> lockProfilingEnabled(false);
+std::mutex lockStatsMutex;
+std::vector<std::unique_ptr<ThreadLockStats>> threadLockStats;
+
+#ifdef _WIN32
+    __declspec(thread) ThreadLockStats* currentThreadLockStats = nullptr;
+#else
+    __thread ThreadLockStats* currentThreadLockStats = nullptr;
+#endif
+
+ThreadLockStats& GetThreadLockStats()
+{
+    if (!currentThreadLockStats)
+    {
+        std::lock_guard<std::mutex> lock(lockStatsMutex);
+        threadLockStats.push_back(std::unique_ptr<ThreadLockStats>(new ThreadLockStats()));
+        currentThreadLockStats = threadLockStats.back().get();
+    }
+    return *currentThreadLockStats;
+}
+
+MACHINE_API void EnableLockProfiling()
+{
+    lockProfilingEnabled = true;
+}
+
+MACHINE_API bool LockProfilingEnabled()
+{
+    return lockProfilingEnabled;
+}
+
+std::string GetManagedCallSite(Thread& thread)
+{
+#ifdef STACK_WALK_GC
+    if (RunningNativeCode())
+    {
+        for (NativeFrameWalker walker(thread); walker.CurrentFunction(); walker.Next())
+        {
+            Function* fun = walker.CurrentFunction();
+            int32_t lineNumberVarOffset = fun->LineNumberVarOffset();
+            if (lineNumberVarOffset != -1)
+            {
+                int32_t lineNumber = *reinterpret_cast<int32_t*>(walker.FramePtr() + lineNumberVarOffset);
+                if (lineNumber > 0)
+                {
+                    return ToUtf8(fun->FullName().Value().AsStringLiteral()) + ":" + std::to_string(lineNumber);
+                }
+            }
+        }
+        return "<native>";
+    }
+#elif defined(SHADOW_STACK_GC)
+    if (RunningNativeCode())
+    {
+        FunctionStackEntry* entry = thread.GetFunctionStack();
+        while (entry)
+        {
+            if (entry->function && entry->lineNumber > 0)
+            {
+                return ToUtf8(entry->function->FullName().Value().AsStringLiteral()) + ":" + std::to_string(entry->lineNumber);
+            }
+            entry = entry->next;
+        }
+        return "<native>";
+    }
+#endif
+    const std::vector<Frame*>& frames = thread.GetStack().Frames();
+    for (int i = int(frames.size()) - 1; i >= 0; --i)
+    {
+        Frame* frame = frames[i];
+        uint32_t line = frame->Fun().GetSourceLine(frame->PrevPC());
+        if (line != -1)
+        {
+            return ToUtf8(frame->Fun().FullName().Value().AsStringLiteral()) + ":" + std::to_string(line);
+        }
+    }
+    return "<unknown>";
+}
+
+//  A monitor acquire records wait time and a call site only when it is contended. A condition variable wait always records its wait time and call site,
+//  but it is not a contended acquire.
+
+MACHINE_API void RecordLockWait(LockKind kind, uint64_t lockObject, const char32_t* lockObjectTypeName, bool contended, int64_t waitNs, Thread& thread)
+{
+    bool waited = contended || kind == LockKind::conditionVariable;
+    std::string callSite;
+    if (waited)
+    {
+        callSite = GetManagedCallSite(thread);
+    }
+    ThreadLockStats& threadStats = GetThreadLockStats();
+    std::lock_guard<std::mutex> lock(threadStats.mtx);
+    LockStats& stats = threadStats.lockStatsMap[std::make_pair(kind, lockObject)];
+    if (stats.acquireCount == 0)
+    {
+        stats.kind = kind;
+        stats.typeName = ToUtf8(lockObjectTypeName);
+    }
+    ++stats.acquireCount;
+    if (contended)
+    {
+        ++stats.contendedCount;
+    }
+    if (waited)
+    {
+        stats.totalWaitNs += waitNs;
+        stats.maxWaitNs = std::max(stats.maxWaitNs, waitNs);
+        CallSiteStats& siteStats = stats.callSites[callSite];
+        ++siteStats.waitCount;
+        siteStats.totalWaitNs += waitNs;
+        siteStats.maxWaitNs = std::max(siteStats.maxWaitNs, waitNs);
+    }
+}
+
+void MergeLockStats(LockStats& to, const LockStats& from)
+{
+    if (to.acquireCount == 0)
+    {
+        to.kind = from.kind;
+        to.typeName = from.typeName;
+    }
+    to.acquireCount += from.acquireCount;
+    to.contendedCount += from.contendedCount;
+    to.totalWaitNs += from.totalWaitNs;
+    to.maxWaitNs = std::max(to.maxWaitNs, from.maxWaitNs);
+    for (const auto& p : from.callSites)
+    {
+        CallSiteStats& siteStats = to.callSites[p.first];
+        siteStats.waitCount += p.second.waitCount;
+        siteStats.totalWaitNs += p.second.totalWaitNs;
+        siteStats.maxWaitNs = std::max(siteStats.maxWaitNs, p.second.maxWaitNs);
+    }
+}
+
+LockStatsMap MergedLockStats()
+{
+    LockStatsMap merged;
+    std::lock_guard<std::mutex> lock(lockStatsMutex);
+    for (const std::unique_ptr<ThreadLockStats>& threadStats : threadLockStats)
+    {
+        std::lock_guard<std::mutex> threadLock(threadStats->mtx);
+        for (const auto& p : threadStats->lockStatsMap)
+        {
+            MergeLockStats(merged[p.first], p.second);
+        }
+    }
+    return merged;
+}
+
+std::string LockKindStr(LockKind kind)
+{
+    switch (kind)
+    {
+        case LockKind::monitor: return "monitor";
+        case LockKind::conditionVariable: return "condition variable";
+    }
+    return "";
+}
+
+std::vector<std::pair<std::pair<LockKind, uint64_t>, const LockStats*>> SortedLockStats(const LockStatsMap& lockStatsMap)
+{
+    std::vector<std::pair<std::pair<LockKind, uint64_t>, const LockStats*>> sorted;
+    for (const auto& p : lockStatsMap)
+    {
+        sorted.push_back(std::make_pair(p.first, &p.second));
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const std::pair<std::pair<LockKind, uint64_t>, const LockStats*>& left, const std::pair<std::pair<LockKind, uint64_t>, const LockStats*>& right)
+    {
+        return left.second->totalWaitNs > right.second->totalWaitNs;
+    });
+    return sorted;
+}
+
+std::vector<std::pair<std::string, CallSiteStats>> SortedCallSites(const LockStats& stats)
+{
+    std::vector<std::pair<std::string, CallSiteStats>> sorted(stats.callSites.begin(), stats.callSites.end());
+    std::stable_sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, CallSiteStats>& left, const std::pair<std::string, CallSiteStats>& right)
+    {
+        return left.second.totalWaitNs > right.second.totalWaitNs;
+    });
+    if (sorted.size() > numReportedCallSites)
+    {
+        sorted.resize(numReportedCallSites);
+    }
+    return sorted;
+}
+
+inline int64_t NsToUs(int64_t ns)
+{
+    return ns / 1000;
+}
+
+MACHINE_API void PrintLockStats()
+{
+    LockStatsMap lockStatsMap = MergedLockStats();
+    if (lockStatsMap.empty()) return;
+    std::cout << "LOCK STATISTICS\n\n";
+    std::vector<std::pair<std::pair<LockKind, uint64_t>, const LockStats*>> sorted = SortedLockStats(lockStatsMap);
+    int n = std::min(int(sorted.size()), numReportedLocks);
+    for (int i = 0; i < n; ++i)
+    {
+        const LockStats& stats = *sorted[i].second;
+        std::cout << LockKindStr(stats.kind) << " #" << sorted[i].first.second << " (" << stats.typeName << ")\n";
+        if (stats.kind == LockKind::monitor)
+        {
+            std::cout << "     acquires : " << std::setw(8) << stats.acquireCount << " [" << stats.contendedCount << " contended]\n";
+        }
+        else
+        {
+            std::cout << "        waits : " << std::setw(8) << stats.acquireCount << "\n";
+        }
+        std::cout <<
+            "   total wait : " << std::setw(8) << NsToUs(stats.totalWaitNs) << " us\n" <<
+            "     max wait : " << std::setw(8) << NsToUs(stats.maxWaitNs) << " us\n";
+        for (const auto& site : SortedCallSites(stats))
+        {
+            std::cout << "      waited " << std::setw(8) << NsToUs(site.second.totalWaitNs) << " us (" << site.second.waitCount << " waits) at " << site.first << "\n";
+        }
+        std::cout << "-------------------------------------------------------------------------------\n";
+    }
+    std::cout << std::endl;
+}
+
+std::string JsonStr(const std::string& s)
+{
+    std::string result = "\"";
+    for (char c : s)
+    {
+        switch (c)
+        {
+            case '"': result.append("\\\""); break;
+            case '\\': result.append("\\\\"); break;
+            case '\n': result.append("\\n"); break;
+            default: result.append(1, c); break;
+        }
+    }
+    result.append(1, '"');
+    return result;
+}
+
+MACHINE_API void WriteLockStatsJson(const std::string& filePath)
+{
+    LockStatsMap lockStatsMap = MergedLockStats();
+    std::ofstream file(filePath);
+    if (!file)
+    {
+        throw std::runtime_error("could not create lock statistics file '" + filePath + "'");
+    }
+    file << "{\n  \"locks\": [";
+    bool firstLock = true;
+    for (const auto& p : SortedLockStats(lockStatsMap))
+    {
+        const LockStats& stats = *p.second;
+        file << (firstLock ? "\n" : ",\n");
+        firstLock = false;
+        file << "    {\n" <<
+            "      \"kind\": " << JsonStr(LockKindStr(stats.kind)) << ",\n" <<
+            "      \"object\": " << p.first.second << ",\n" <<
+            "      \"type\": " << JsonStr(stats.typeName) << ",\n" <<
+            "      \"acquires\": " << stats.acquireCount << ",\n" <<
+            "      \"contended\": " << stats.contendedCount << ",\n" <<
+            "      \"totalWaitNs\": " << stats.totalWaitNs << ",\n" <<
+            "      \"maxWaitNs\": " << stats.maxWaitNs << ",\n" <<
+            "      \"callSites\": [";
+        bool firstSite = true;
+        for (const auto& site : SortedCallSites(stats))
+        {
+            file << (firstSite ? "\n" : ",\n");
+            firstSite = false;
+            file << "        { \"site\": " << JsonStr(site.first) << ", \"waits\": " << site.second.waitCount << ", \"totalWaitNs\": " << site.second.totalWaitNs <<
+                ", \"maxWaitNs\": " << site.second.maxWaitNs << " }";
+        }
+        file << (firstSite ? "]\n" : "\n      ]\n") << "    }";
+    }
+    file << (firstLock ? "]\n" : "\n  ]\n") << "}\n";
+}
+
+} } // namespace cminor::machine
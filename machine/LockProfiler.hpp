@@ -0,0 +1,33 @@
+// =================================
+// Copyright (c) 2017 Seppo Laakko
+// Distributed under the MIT license
+// =================================
+
+#ifndef CMINOR_MACHINE_LOCK_PROFILER_INCLUDED
+#define CMINOR_MACHINE_LOCK_PROFILER_INCLUDED
+#include <cminor/machine/MachineApi.hpp>
+#include <stdint.h>
+#include <string>
+
+namespace cminor { namespace machine {
+
+class Thread;
+
+enum class LockKind : uint8_t
+{
+    monitor, conditionVariable
+};
+
+//  Lock profiling is enabled by the --stats and --lock-stats options of the virtual machine. When enabled, entering a monitor and waiting
+//  a condition variable record per lock object the number of acquires, the number of contended acquires, the total and maximum wait time
+//  and the managed call sites that waited longest.
+
+MACHINE_API void EnableLockProfiling();
+MACHINE_API bool LockProfilingEnabled();
+MACHINE_API void RecordLockWait(LockKind kind, uint64_t lockObject, const char32_t* lockObjectTypeName, bool contended, int64_t waitNs, Thread& thread);
+MACHINE_API void PrintLockStats();
+MACHINE_API void WriteLockStatsJson(const std::string& filePath);
+
+} } // namespace cminor::machine
+
+#endif // CMINOR_MACHINE_LOCK_PROFILER_INCLUDED
@@ -25,7 +25,7 @@ MACHINE_API bool RunningNativeCode()
     return runningNativeCode;
 }
 
-Machine::Machine() : rootInst(*this, "<root_instruction>", true), managedMemoryPool(*this), garbageCollector(*this), exiting(), exited(), nextFrameId(0), nextSegmentId(0), 
+Machine::Machine() : rootInst(*this, "<root_instruction>", true), managedMemoryPool(*this), garbageCollector(*this), exiting(), exited(), numNonDaemonThreads(0), nextFrameId(0), nextFiberId(0), nextSegmentId(0), 
     threadMutex('T'), owner('M')
 {
     SetMachine(this);
@@ -625,7 +625,9 @@ void Machine::RunMain(bool runWithArgs, const std::vector<std::u32string>& progr
     MainThread().SetThreadHandle(currentThreadHandle);
     SetCurrentThread(&MainThread());
     RunGarbageCollector();
+    ++numNonDaemonThreads;
     MainThread().RunMain(runWithArgs, programArguments, argsArrayObjectType);
+    --numNonDaemonThreads;
     for (const std::unique_ptr<std::thread>& userThread : userThreads)
     {
         if (userThread->joinable())
@@ -725,6 +727,7 @@ void RunUserThread(Thread* thread, Function* fun, RunThreadKind runThreadKind)
         std::cerr << "unknown exception escaped from user thread " << thread->Id() << std::endl;
         thread->SetExceptionPtr(std::current_exception());
     }
+    thread->GetMachine().UserThreadExited(*thread);
 }
 
 int Machine::StartThread(Function* fun, RunThreadKind runThreadKind, ObjectReference receiver, ObjectReference arg)
@@ -760,10 +763,30 @@ int Machine::StartThread(Function* fun, RunThreadKind runThreadKind, ObjectRefer
     }
     thread->SetNativeId(int32_t(userThreads.size()));
     threads.push_back(std::unique_ptr<Thread>(thread));
+    ++numNonDaemonThreads;
     userThreads.push_back(std::unique_ptr<std::thread>(new std::thread(RunUserThread, thread, fun, runThreadKind)));
     return thread->Id();
 }
 
+//  A daemon thread does not keep the program running: the daemon threads of the thread pools exit when they are idle and only daemon threads are running.
+
+void Machine::MakeDaemon(Thread& thread)
+{
+    if (!thread.IsDaemon())
+    {
+        thread.SetDaemon();
+        --numNonDaemonThreads;
+    }
+}
+
+void Machine::UserThreadExited(Thread& thread)
+{
+    if (!thread.IsDaemon())
+    {
+        --numNonDaemonThreads;
+    }
+}
+
 void Machine::JoinThread(int threadId)
 {
     if (threadId < 0 || threadId >= int(threads.size()))
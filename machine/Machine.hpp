@@ -57,9 +57,13 @@ public:
     Arena& Gen1Arena() { return *gen1Arena; }
     Arena& Gen2Arena() { return *gen2Arena; }
     int32_t GetNextFrameId() { return nextFrameId++; }
+    int32_t GetNextFiberId() { return nextFiberId++; }
     int32_t GetNextSegmentId();
     bool Exiting();
     void Exit();
+    void MakeDaemon(Thread& thread);
+    void UserThreadExited(Thread& thread);
+    bool OnlyDaemonThreadsRunning() const { return numNonDaemonThreads == 0; }
     void AddSegment(Segment* segment);
     void RemoveSegment(int32_t segmentId);
     Segment* GetSegment(int32_t segmentId);
@@ -76,10 +80,12 @@ private:
     std::unique_ptr<GenArena2> gen2Arena;
     std::atomic<bool> exiting;
     std::atomic<bool> exited;
+    std::atomic<int32_t> numNonDaemonThreads;
     std::thread garbageCollectorThread;
     Mutex threadMutex;
     MutexOwner owner;
     std::atomic<int32_t> nextFrameId;
+    std::atomic<int32_t> nextFiberId;
     std::atomic<int32_t> nextSegmentId;
     std::unordered_map<int32_t, Segment*> segmentMap;
 };
@@ -96,8 +96,8 @@ public:
     virtual void VisitLogicalNotInst(LogicalNotInst& instruction) {}
     virtual void VisitLoadLocalInst(int32_t localIndex) {}
     virtual void VisitStoreLocalInst(int32_t localIndex) {}
-    virtual void VisitLoadFieldInst(int32_t fieldIndex, ValueType fieldType) {}
-    virtual void VisitStoreFieldInst(int32_t fieldIndex, ValueType fieldType) {}
+    virtual void VisitLoadFieldInst(int32_t fieldIndex, int32_t fieldOffset, ValueType fieldType) {}
+    virtual void VisitStoreFieldInst(int32_t fieldIndex, int32_t fieldOffset, ValueType fieldType) {}
     virtual void VisitLoadElemInst(LoadElemInst& instruction) {}
     virtual void VisitStoreElemInst(StoreElemInst& instruction) {}
     virtual void VisitLoadConstantInst(int32_t constantIndex) {}
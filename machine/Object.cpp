@@ -12,6 +12,7 @@
 #include <cminor/machine/Class.hpp>
 #include <cminor/util/Random.hpp>
 #include <cminor/machine/Log.hpp>
+#include <cminor/machine/OsInterface.hpp>
 #include <cminor/util/Unicode.hpp>
 #include <cstring>
 #include <iostream>
@@ -399,6 +400,30 @@ uint64_t GetPoolThreshold()
     return poolThreshold;
 }
 
+AllocationTable::AllocationTable() : table(reinterpret_cast<void**>(ReserveMemory(allocationTableReserveSize))), size(0), capacity(0), growSize(GetSystemPageSize())
+{
+}
+
+AllocationTable::~AllocationTable()
+{
+    FreeMemory(reinterpret_cast<uint8_t*>(table), allocationTableReserveSize);
+}
+
+void AllocationTable::Resize(uint64_t newSize)
+{
+    if (newSize > capacity)
+    {
+        uint64_t commitSize = growSize * ((newSize * sizeof(void*) - capacity * sizeof(void*) - 1) / growSize + 1);
+        if (capacity * sizeof(void*) + commitSize > allocationTableReserveSize)
+        {
+            throw SystemException("allocation table full");
+        }
+        CommitMemory(reinterpret_cast<uint8_t*>(table + capacity), commitSize);
+        capacity = capacity + commitSize / sizeof(void*);
+    }
+    size = newSize;
+}
+
 ManagedMemoryPool::ManagedMemoryPool(Machine& machine_) : machine(machine_), nextAllocationHandleValue(firstAllocationHandleValue)
 {
 }
@@ -418,7 +443,7 @@ AllocationHandle ManagedMemoryPool::AddAllocation(Thread& thread, ManagedAllocat
     {
         lock.lock();
     }
-    if (allocationHandle.Value() < uint64_t(allocations.size()))
+    if (allocationHandle.Value() < allocations.Size())
     {
         Assert(!allocations[allocationHandle.Value()], "overwriting existing allocation");
         allocations[allocationHandle.Value()] = GetAllocationPtr(header);
@@ -426,15 +451,37 @@ AllocationHandle ManagedMemoryPool::AddAllocation(Thread& thread, ManagedAllocat
     else
     {
         void* allocationPtr = GetAllocationPtr(header);
-        while (allocationHandle.Value() >= uint64_t(allocations.size()))
-        {
-            allocations.push_back(nullptr);
-        }
+        allocations.Resize(allocationHandle.Value() + 1);
         allocations[allocationHandle.Value()] = allocationPtr;
     }
     return allocationHandle;
 }
 
+//  Fills the allocation context of a thread with handles that natively compiled code can allocate objects with. Handles released to the thread
+//  are used first. The table is grown to cover the new handles here, so that native code never needs to resize the table itself.
+
+void ManagedMemoryPool::ReserveAllocationHandles(Thread& thread, AllocationContext& allocationContext)
+{
+    std::lock_guard<std::recursive_mutex> lock(allocationsMutex);
+    while (allocationContext.HasRoomForHandles())
+    {
+        AllocationHandle allocationHandle;
+        if (thread.HasAllocationHandles())
+        {
+            allocationHandle = thread.PopAllocationHandle();
+        }
+        else
+        {
+            allocationHandle = nextAllocationHandleValue++;
+        }
+        if (allocationHandle.Value() >= allocations.Size())
+        {
+            allocations.Resize(allocationHandle.Value() + 1);
+        }
+        allocationContext.PushHandle(allocationHandle);
+    }
+}
+
 void* ManagedMemoryPool::MoveAllocation(int32_t newSegmentId, void* newAllocWithHeader, ManagedAllocationHeader* header)
 {
     std::memcpy(newAllocWithHeader, header, header->AllocationSize());
@@ -473,7 +520,7 @@ void ManagedMemoryPool::DestroyAllocation(AllocationHandle handle)
     ManagedAllocationHeader* header = GetAllocationHeader(allocation);
     if (header->IsObject())
     {
-        if (header->LockId() != lockNotAllocated)
+        if (header->LockId() >= 0)
         {
             if (destroyLock)
             {
@@ -590,7 +637,7 @@ void* ManagedMemoryPool::GetObject(ObjectReference reference, std::unique_lock<s
     {
         lock.lock();
     }
-    if (index < uint64_t(allocations.size()))
+    if (index < allocations.Size())
     {
         return allocations[index];
     }
@@ -604,7 +651,7 @@ void* ManagedMemoryPool::GetObjectNoThrow(ObjectReference reference, std::unique
     {
         lock.lock();
     }
-    if (index < uint64_t(allocations.size()))
+    if (index < allocations.Size())
     {
         return allocations[index];
     }
@@ -614,7 +661,7 @@ void* ManagedMemoryPool::GetObjectNoThrow(ObjectReference reference, std::unique
 void* ManagedMemoryPool::GetObjectNoThrowNoLock(ObjectReference reference)
 {
     uint64_t index = reference.Value();
-    if (index < uint64_t(allocations.size()))
+    if (index < allocations.Size())
     {
         return allocations[index];
     }
@@ -628,7 +675,7 @@ void* ManagedMemoryPool::GetAllocation(AllocationHandle handle, std::unique_lock
     {
         lock.lock();
     }
-    if (index < uint64_t(allocations.size()))
+    if (index < allocations.Size())
     {
         return allocations[index];
     }
@@ -638,7 +685,7 @@ void* ManagedMemoryPool::GetAllocation(AllocationHandle handle, std::unique_lock
 void* ManagedMemoryPool::GetAllocationNoThrowNoLock(AllocationHandle handle)
 {
     uint64_t index = handle.Value();
-    if (index < uint64_t(allocations.size()))
+    if (index < allocations.Size())
     {
         return allocations[index];
     }
@@ -799,6 +846,65 @@ ObjectReference ManagedMemoryPool::CreateString(Thread& thread, const std::u32st
     return str;
 }
 
+ObjectReference ManagedMemoryPool::InternStringLiteral(Thread& thread, const char32_t* strLit)
+{
+    std::unique_lock<std::recursive_mutex> lock(allocationsMutex, std::defer_lock_t());
+    return InternStringLiteral(thread, strLit, lock);
+}
+
+ObjectReference ManagedMemoryPool::InternStringLiteral(Thread& thread, const char32_t* strLit, std::unique_lock<std::recursive_mutex>& lock)
+{
+    if (!lock.owns_lock())
+    {
+        lock.lock();
+    }
+    auto it = internedLiterals.find(strLit);
+    if (it != internedLiterals.cend())
+    {
+        return it->second;
+    }
+    uint32_t len = static_cast<uint32_t>(StringLen(strLit));
+    std::u32string value(strLit, len);
+    auto sit = internedStrings.find(value);
+    if (sit != internedStrings.cend())
+    {
+        ObjectReference str = sit->second;
+        internedLiterals[strLit] = str;
+        return str;
+    }
+    ClassData* classData = ClassDataTable::GetSystemStringClassData();
+    ObjectReference str = CreateObject(thread, classData->Type(), lock);
+    internedStrings[value] = str;
+    internedLiterals[strLit] = str;
+    AllocationHandle charsHandle = CreateStringCharsFromLiteral(thread, strLit, len, lock);
+    SetField(str, 0, IntegralValue(classData), lock);
+    SetField(str, 1, MakeIntegralValue<int32_t>(static_cast<int32_t>(len), ValueType::intType), lock);
+    SetField(str, 2, charsHandle, lock);
+    return str;
+}
+
+ObjectReference ManagedMemoryPool::InternString(Thread& thread, ObjectReference str)
+{
+    if (str.IsNull())
+    {
+        throw NullReferenceException("cannot intern a null string");
+    }
+    std::unique_lock<std::recursive_mutex> lock(allocationsMutex);
+    IntegralValue charsHandleValue = GetField(str, 2, lock);
+    Assert(charsHandleValue.GetType() == ValueType::allocationHandle, "allocation handle expected");
+    AllocationHandle handle(charsHandleValue.Value());
+    void* stringChars = GetAllocation(handle, lock);
+    StringCharactersHeader* stringCharsHeader = &GetAllocationHeader(stringChars)->stringCharactersHeader;
+    std::u32string value(stringCharsHeader->Str(), stringCharsHeader->NumChars());
+    auto it = internedStrings.find(value);
+    if (it != internedStrings.cend())
+    {
+        return it->second;
+    }
+    internedStrings[value] = str;
+    return str;
+}
+
 IntegralValue ManagedMemoryPool::GetStringChar(ObjectReference str, int32_t index)
 {
     std::unique_lock<std::recursive_mutex> lock(allocationsMutex, std::defer_lock_t());
@@ -884,6 +990,90 @@ void ManagedMemoryPool::SetBytes(ObjectReference arr, const std::vector<uint8_t>
     }
 }
 
+void* ManagedMemoryPool::PinArrayElements(Thread& thread, ObjectReference arr, AllocationHandle& elementsHandle)
+{
+    if (arr.IsNull())
+    {
+        throw NullReferenceException("cannot pin a null array");
+    }
+    std::unique_lock<std::recursive_mutex> lock(allocationsMutex);
+    IntegralValue elementsHandleValue = GetField(arr, 2, lock);
+    Assert(elementsHandleValue.GetType() == ValueType::allocationHandle, "allocation handle expected");
+    elementsHandle = AllocationHandle(elementsHandleValue.Value());
+    void* arrayElements = GetAllocation(elementsHandle, lock);
+    ManagedAllocationHeader* header = GetAllocationHeader(arrayElements);
+    if (machine.GetSegment(header->SegmentId())->GetArenaId() == ArenaId::gen1Arena)
+    {
+        uint32_t n = header->AllocationSize();
+        void* newAllocWithHeader = nullptr;
+        int32_t newSegmentId = -1;
+        machine.Gen2Arena().Allocate(thread, n, newAllocWithHeader, newSegmentId, lock);
+        if (!lock.owns_lock())
+        {
+            lock.lock();
+        }
+        arrayElements = GetAllocation(elementsHandle, lock);
+        header = GetAllocationHeader(arrayElements);
+        if (machine.GetSegment(header->SegmentId())->GetArenaId() == ArenaId::gen1Arena)
+        {
+            arrayElements = MoveAllocation(newSegmentId, newAllocWithHeader, header);
+            allocations[elementsHandle.Value()] = arrayElements;
+        }
+    }
+    std::lock_guard<std::mutex> pinLock(pinMutex);
+    ++pinnedAllocations[elementsHandle];
+    return arrayElements;
+}
+
+void ManagedMemoryPool::UnpinArrayElements(AllocationHandle elementsHandle)
+{
+    std::lock_guard<std::mutex> pinLock(pinMutex);
+    auto it = pinnedAllocations.find(elementsHandle);
+    Assert(it != pinnedAllocations.cend(), "allocation not pinned");
+    if (--it->second == 0)
+    {
+        pinnedAllocations.erase(it);
+    }
+}
+
+std::unordered_set<int32_t> ManagedMemoryPool::GetPinnedSegments()
+{
+    std::unordered_set<int32_t> pinnedSegments;
+    std::lock_guard<std::mutex> pinLock(pinMutex);
+    for (const auto& p : pinnedAllocations)
+    {
+        void* allocation = allocations[p.first.Value()];
+        if (allocation)
+        {
+            pinnedSegments.insert(GetAllocationHeader(allocation)->SegmentId());
+        }
+    }
+    return pinnedSegments;
+}
+
+PinnedByteArray::PinnedByteArray(Thread& thread, ObjectReference arr) : elementsHandle(), bytes(nullptr), length(0)
+{
+    void* arrayElements = GetManagedMemoryPool().PinArrayElements(thread, arr, elementsHandle);
+    ArrayElementsHeader* arrayElementsHeader = &GetAllocationHeader(arrayElements)->arrayElementsHeader;
+    Assert(arrayElementsHeader->GetElementType() == TypeTable::GetType(StringPtr(U"System.UInt8")), "byte array expected");
+    bytes = static_cast<uint8_t*>(arrayElements);
+    length = arrayElementsHeader->NumElements();
+}
+
+PinnedByteArray::~PinnedByteArray()
+{
+    GetManagedMemoryPool().UnpinArrayElements(elementsHandle);
+}
+
+void PinnedByteArray::CheckRange(int32_t offset, int32_t count) const
+{
+    if (offset < 0 || count < 0 || offset > length || count > length - offset)
+    {
+        throw IndexOutOfRangeException("invalid buffer range: offset " + std::to_string(offset) + ", count " + std::to_string(count) + ", length " + 
+            std::to_string(length));
+    }
+}
+
 void ManagedMemoryPool::AllocateArrayElements(Thread& thread, ObjectReference arr, Type* elementType, int32_t length)
 {
     std::unique_lock<std::recursive_mutex> lock(allocationsMutex);
@@ -983,8 +1173,9 @@ ObjectReference ManagedMemoryPool::CreateStringArray(Thread& thread, const std::
 
 void ManagedMemoryPool::ResetLiveFlags()
 {
-    for (void* allocation : allocations)
+    for (uint64_t i = firstAllocationHandleValue; i < allocations.Size(); ++i)
     {
+        void* allocation = allocations[i];
         if (allocation)
         {
             ManagedAllocationHeader* header = GetAllocationHeader(allocation);
@@ -997,7 +1188,7 @@ void ManagedMemoryPool::MoveLiveAllocationsToArena(ArenaId fromArenaId, Arena& t
 {
     std::unordered_map<void*, void*> moveMap;
     std::vector<AllocationHandle> toBeDestroyed;
-    for (uint64_t i = firstAllocationHandleValue; i < uint64_t(allocations.size()); ++i)
+    for (uint64_t i = firstAllocationHandleValue; i < allocations.Size(); ++i)
     {
         AllocationHandle allocationHandle = i;
         void* allocation = allocations[i];
@@ -1099,7 +1290,7 @@ void ManagedMemoryPool::MoveLiveAllocationsToNewSegments(Arena& arena)
     std::vector<AllocationHandle> liveAllocations;
     std::vector<AllocationHandle> toBeDestroyed;
     std::unordered_set<int32_t> liveSegments;
-    for (uint64_t i = firstAllocationHandleValue; i < uint64_t(allocations.size()); ++i)
+    for (uint64_t i = firstAllocationHandleValue; i < allocations.Size(); ++i)
     {
         AllocationHandle allocationHandle = i;
         void* allocation = allocations[i];
@@ -1129,6 +1320,7 @@ void ManagedMemoryPool::MoveLiveAllocationsToNewSegments(Arena& arena)
     }
     DestroyAllocations(toBeDestroyed);
     arena.RemoveEmptySegments(liveSegments);
+    std::unordered_set<int32_t> pinnedSegments = GetPinnedSegments();
     std::sort(liveAllocations.begin(), liveAllocations.end(), SegmentIdLess());
     int32_t currentSegmentId = -1;
     auto segmentBegin = liveAllocations.begin();
@@ -1156,7 +1348,7 @@ void ManagedMemoryPool::MoveLiveAllocationsToNewSegments(Arena& arena)
                             moveSegment = false;
                         }
                     }
-                    if (moveSegment)
+                    if (moveSegment && pinnedSegments.find(currentSegmentId) == pinnedSegments.cend())
                     {
                         MoveSegment(arena, moveMap, currentSegmentId, segmentBegin, it, firstMove, toBeDestroyed);
                         firstMove = false;
@@ -1184,7 +1376,7 @@ void ManagedMemoryPool::MoveLiveAllocationsToNewSegments(Arena& arena)
             }
         }
     }
-    if (moveSegment)
+    if (moveSegment && pinnedSegments.find(currentSegmentId) == pinnedSegments.cend())
     {
         MoveSegment(arena, moveMap, currentSegmentId, segmentBegin, end, firstMove, toBeDestroyed);
         firstMove = false;
@@ -9,8 +9,10 @@
 #include <cminor/machine/Error.hpp>
 #include <cminor/util/CodeFormatter.hpp>
 #include <stdint.h>
+#include <cstddef>
 #include <atomic>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -28,6 +30,7 @@ class ClassData;
 class Type;
 class ObjectType;
 class ManagedMemoryPool;
+class AllocationContext;
 struct FunctionStackEntry;
 
 enum class ArenaId : uint8_t
@@ -151,7 +154,8 @@ enum class AllocationFlags : uint8_t
     arrayElements = 1 << 3,
     stringChars = 1 << 4,
     stringLiteral = 1 << 5,
-    conditionVariable = 1 << 6
+    conditionVariable = 1 << 6,
+    hashCodeCached = 1 << 7
 };
 
 inline AllocationFlags operator|(AllocationFlags left, AllocationFlags right)
@@ -169,6 +173,7 @@ inline AllocationFlags operator~(AllocationFlags flag)
     return AllocationFlags(~uint8_t(flag));
 }
 
+//  lockNotAllocated denotes an unlocked monitor. A nonnegative lock id denotes an inflated monitor, other negative values a thin lock held by a thread.
 const int32_t lockNotAllocated = -1;
 
 struct MACHINE_API ObjectHeader
@@ -225,6 +230,8 @@ struct MACHINE_API ManagedAllocationHeader
     void SetStringLiteral() { SetFlag(AllocationFlags::stringLiteral); }
     bool IsConditionVariable() const { return GetFlag(AllocationFlags::conditionVariable); }
     void SetConditionVariable() { SetFlag(AllocationFlags::conditionVariable); }
+    bool IsHashCodeCached() const { return GetFlag(AllocationFlags::hashCodeCached); }
+    void SetHashCodeCached() { SetFlag(AllocationFlags::hashCodeCached); }
     int32_t LockId() const { return lockId; }
     void SetLockId(int32_t lockId_) { lockId = lockId_; }
     bool GetFlag(AllocationFlags flag) const { return (flags & flag) != AllocationFlags::none; }
@@ -247,6 +254,13 @@ struct MACHINE_API ManagedAllocationHeader
 inline ManagedAllocationHeader* GetAllocationHeader(void* allocation) { return static_cast<ManagedAllocationHeader*>(allocation) - 1; }
 inline void* GetAllocationPtr(ManagedAllocationHeader* header) { return header + 1; }
 
+//  Offset of the number of elements of an array elements allocation relative to the allocation pointer. Natively compiled code reads it for bounds checks.
+
+inline int64_t NumArrayElementsOffset() 
+{ 
+    return int64_t(offsetof(ManagedAllocationHeader, arrayElementsHeader) + offsetof(ArrayElementsHeader, numElements)) - int64_t(sizeof(ManagedAllocationHeader)); 
+}
+
 IntegralValue GetObjectField(void* object, int index);
 void SetObjectField(void* object, IntegralValue fieldValue, int index);
 int32_t ObjectFieldCount(void* object);
@@ -269,11 +283,35 @@ MACHINE_API uint64_t GetPoolThreshold();
 
 constexpr uint64_t firstAllocationHandleValue = 1;
 
+constexpr uint64_t allocationTableReserveSize = static_cast<uint64_t>(4) * 1024 * 1024 * 1024;
+
+//  The allocation table maps allocation handles to allocations. Its address space is reserved once and committed as the table grows, so
+//  the table never moves. Natively compiled code reads the allocation of a handle directly from the table without holding the allocations mutex.
+
+class MACHINE_API AllocationTable
+{
+public:
+    AllocationTable();
+    ~AllocationTable();
+    AllocationTable(const AllocationTable&) = delete;
+    AllocationTable& operator=(const AllocationTable&) = delete;
+    uint64_t Size() const { return size; }
+    void Resize(uint64_t newSize);
+    void*& operator[](uint64_t index) { return table[index]; }
+    void** Table() const { return table; }
+private:
+    void** table;
+    uint64_t size;
+    uint64_t capacity;
+    uint64_t growSize;
+};
+
 class MACHINE_API ManagedMemoryPool
 {
 public:
     ManagedMemoryPool(Machine& machine_);
     AllocationHandle AddAllocation(Thread& thread, ManagedAllocationHeader* header, std::unique_lock<std::recursive_mutex>& lock);
+    void ReserveAllocationHandles(Thread& thread, AllocationContext& allocationContext);
     void SetAllocation(AllocationHandle handle, void* allocation) { allocations[handle.Value()] = allocation; }
     void* MoveAllocation(int32_t newSegmentId, void* newAllocWithHeader, ManagedAllocationHeader* header);
     void DestroyAllocation(AllocationHandle handle);
@@ -298,11 +336,17 @@ public:
     std::pair<AllocationHandle, int32_t> CreateStringCharsFromCharArray(Thread& thread, ObjectReference charArray, std::unique_lock<std::recursive_mutex>& lock);
     ObjectReference CreateString(Thread& thread, const std::u32string& s);
     ObjectReference CreateString(Thread& thread, const std::u32string& s, std::unique_lock<std::recursive_mutex>& lock);
+    ObjectReference InternStringLiteral(Thread& thread, const char32_t* strLit);
+    ObjectReference InternStringLiteral(Thread& thread, const char32_t* strLit, std::unique_lock<std::recursive_mutex>& lock);
+    ObjectReference InternString(Thread& thread, ObjectReference str);
+    const std::unordered_map<std::u32string, ObjectReference>& InternedStrings() const { return internedStrings; }
     IntegralValue GetStringChar(ObjectReference str, int32_t index);
     IntegralValue GetStringChar(ObjectReference str, int32_t index, std::unique_lock<std::recursive_mutex>& lock);
     std::string GetUtf8String(ObjectReference str);
     std::vector<uint8_t> GetBytes(ObjectReference arr);
     void SetBytes(ObjectReference arr, const std::vector<uint8_t>& bytes, int32_t count);
+    void* PinArrayElements(Thread& thread, ObjectReference arr, AllocationHandle& elementsHandle);
+    void UnpinArrayElements(AllocationHandle elementsHandle);
     void AllocateArrayElements(Thread& thread, ObjectReference arr, Type* elementType, int32_t length);
     void AllocateArrayElements(Thread& thread, ObjectReference arr, Type* elementType, int32_t length, std::unique_lock<std::recursive_mutex>& lock);
     IntegralValue GetArrayElement(ObjectReference reference, int32_t index);
@@ -314,11 +358,37 @@ public:
     void MoveLiveAllocationsToArena(ArenaId fromArenaId, Arena& toArena);
     void MoveLiveAllocationsToNewSegments(Arena& arena);
     std::recursive_mutex& AllocationsMutex() { return allocationsMutex; }
+    void** AllocationTableAddress() const { return allocations.Table(); }
 private:
     Machine& machine;
-    std::vector<void*> allocations;
+    AllocationTable allocations;
     std::atomic<uint64_t> nextAllocationHandleValue;
     std::recursive_mutex allocationsMutex;
+    std::unordered_map<const char32_t*, ObjectReference> internedLiterals;
+    std::unordered_map<std::u32string, ObjectReference> internedStrings;
+    std::mutex pinMutex;
+    std::unordered_map<AllocationHandle, int32_t, AllocationHandleHash> pinnedAllocations;
+    std::unordered_set<int32_t> GetPinnedSegments();
+};
+
+//  PinnedByteArray pins the elements of a byte array for the duration of a native I/O call, so that the call can read and write the
+//  elements in place, also while the thread is waiting and a garbage collection runs. Pinning promotes the elements from generation 1
+//  to generation 2, and a full collection does not compact a segment that contains pinned allocations.
+
+class MACHINE_API PinnedByteArray
+{
+public:
+    PinnedByteArray(Thread& thread, ObjectReference arr);
+    PinnedByteArray(const PinnedByteArray&) = delete;
+    PinnedByteArray& operator=(const PinnedByteArray&) = delete;
+    ~PinnedByteArray();
+    uint8_t* Bytes() const { return bytes; }
+    int32_t Length() const { return length; }
+    void CheckRange(int32_t offset, int32_t count) const;
+private:
+    AllocationHandle elementsHandle;
+    uint8_t* bytes;
+    int32_t length;
 };
 
 typedef void(*DestroyLockFn)(uint32_t);
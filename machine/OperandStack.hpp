@@ -50,6 +50,10 @@ public:
         Assert(s.size() - index >= 0 && s.size() - index <= s.size(), "invalid insert index");
         s.insert(s.end() - index, value);
     }
+    void Exchange(OperandStack& that)
+    {
+        s.swap(that.s);
+    }
 private:
     std::vector<IntegralValue> s;
 };
@@ -22,6 +22,8 @@
     #include <unistd.h>
     #include <sys/mman.h>
     #include <dlfcn.h>
+    #include <link.h>
+    #include <sys/syscall.h>
 #endif
 
 namespace cminor { namespace machine {
@@ -161,6 +163,21 @@ MACHINE_API void SetHandleToTextMode(int handle)
     _setmode(handle, _O_TEXT);
 }
 
+uint64_t GetSymbolSize(void* symbolAddress)
+{
+    return 0;
+}
+
+uint64_t GetCurrentProcessNumber()
+{
+    return GetCurrentProcessId();
+}
+
+uint64_t GetCurrentOsThreadId()
+{
+    return GetCurrentThreadId();
+}
+
 #else
 
 uint64_t GetSystemPageSize()
@@ -257,6 +274,29 @@ void SetHandleToTextMode(int handle)
 {
 }
 
+//  Returns the size of the ELF symbol at symbolAddress in the symbol table of the loaded shared object, or zero if not known.
+
+uint64_t GetSymbolSize(void* symbolAddress)
+{
+    Dl_info info;
+    void* symbolInfo = nullptr;
+    if (dladdr1(symbolAddress, &info, &symbolInfo, RTLD_DL_SYMENT) != 0 && symbolInfo != nullptr && info.dli_saddr == symbolAddress)
+    {
+        return static_cast<const ElfW(Sym)*>(symbolInfo)->st_size;
+    }
+    return 0;
+}
+
+uint64_t GetCurrentProcessNumber()
+{
+    return getpid();
+}
+
+uint64_t GetCurrentOsThreadId()
+{
+    return syscall(SYS_gettid);
+}
+
 #endif 
 
 } } // namespace cminor::machine
@@ -28,6 +28,9 @@ MACHINE_API void FreeSharedLibrary(void* sharedLibraryHandle);
 MACHINE_API void* ResolveSymbolAddress(void* sharedLibraryHandle, const std::string& sharedLibraryFilePath, const std::string& symbolName);
 MACHINE_API void SetHandleToBinaryMode(int handle);
 MACHINE_API void SetHandleToTextMode(int handle);
+uint64_t GetSymbolSize(void* symbolAddress);
+uint64_t GetCurrentProcessNumber();
+uint64_t GetCurrentOsThreadId();
 
 } } // namespace cminor::machine
 
@@ -0,0 +1,139 @@
+// =================================
+// Copyright (c) 2017 Seppo Laakko
+// Distributed under the MIT license
+// =================================
+
+#include <cminor/machine/PerfMap.hpp>
+#include <cminor/machine/Function.hpp>
+#include <cminor/machine/OsInterface.hpp>
+#include <cminor/machine/Thread.hpp>
+#include <cminor/util/Unicode.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace cminor { namespace machine {
+
+using namespace cminor::unicode;
+
+bool perfMapEnabled = false;
+
+MACHINE_API void EnablePerfMap()
+{
+    perfMapEnabled = true;
+}
+
+MACHINE_API bool PerfMapEnabled()
+{
+    return perfMapEnabled;
+}
+
+//  Native functions are sorted by address. When the symbol table does not tell the size of a function, the function is assumed to extend to the next one.
+
+MACHINE_API void WritePerfMap()
+{
+    std::string perfMapFilePath = "/tmp/perf-" + std::to_string(GetCurrentProcessNumber()) + ".map";
+    std::ofstream perfMap(perfMapFilePath, std::ios_base::app);
+    if (!perfMap)
+    {
+        throw std::runtime_error("could not open perf map file '" + perfMapFilePath + "'");
+    }
+    const std::vector<Function*>& nativeFunctions = FunctionTable::NativeFunctions();
+    int n = int(nativeFunctions.size());
+    for (int i = 0; i < n; ++i)
+    {
+        Function* function = nativeFunctions[i];
+        uint64_t start = reinterpret_cast<uint64_t>(function->Address());
+        uint64_t size = GetSymbolSize(function->Address());
+        if (size == 0 && i < n - 1)
+        {
+            size = reinterpret_cast<uint64_t>(nativeFunctions[i + 1]->Address()) - start;
+        }
+        if (size == 0) continue;
+        perfMap << std::hex << start << " " << size << std::dec << " " << function->MangledName() << "\n";
+    }
+}
+
+std::atomic<uint64_t> managedStackSampleCount(0);
+
+std::mutex managedStackSamplesMutex;
+std::unique_ptr<std::ofstream> managedStackSamples;
+std::condition_variable managedStackSamplerStop;
+bool managedStackSamplerStopping = false;
+std::thread managedStackSampler;
+
+void RunManagedStackSampler()
+{
+    std::chrono::nanoseconds period(1000000000 / managedStackSampleFrequency);
+    std::unique_lock<std::mutex> lock(managedStackSamplesMutex);
+    while (!managedStackSamplerStop.wait_for(lock, period, [] { return managedStackSamplerStopping; }))
+    {
+        ++managedStackSampleCount;
+    }
+}
+
+MACHINE_API void StartManagedStackSampling(const std::string& filePath)
+{
+    managedStackSamples.reset(new std::ofstream(filePath));
+    if (!*managedStackSamples)
+    {
+        throw std::runtime_error("could not create managed stack sample file '" + filePath + "'");
+    }
+    managedStackSampler = std::thread(RunManagedStackSampler);
+}
+
+MACHINE_API void StopManagedStackSampling()
+{
+    if (!managedStackSampler.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(managedStackSamplesMutex);
+        managedStackSamplerStopping = true;
+    }
+    managedStackSamplerStop.notify_one();
+    managedStackSampler.join();
+    managedStackSamples.reset();
+}
+
+//  Stops the sampler thread also when the program exits by an exception.
+
+struct ManagedStackSamplerStopper
+{
+    ~ManagedStackSamplerStopper() { StopManagedStackSampling(); }
+};
+
+ManagedStackSamplerStopper managedStackSamplerStopper;
+
+//  The sample is formatted before taking the lock, so that the interpreter threads do not wait each other while walking their stacks.
+
+MACHINE_API void WriteManagedStackSample(Thread& thread)
+{
+    thread.SetManagedStackSample(managedStackSampleCount);
+    uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    std::ostringstream sample;
+    sample << "sample " << GetCurrentOsThreadId() << " " << time << "\n";
+    const std::vector<Frame*>& frames = thread.GetStack().Frames();
+    for (int i = int(frames.size()) - 1; i >= 0; --i)
+    {
+        Frame* frame = frames[i];
+        sample << ToUtf8(frame->Fun().FullName().Value().AsStringLiteral());
+        uint32_t line = frame->Fun().GetSourceLine(frame->PrevPC());
+        if (line != -1)
+        {
+            sample << ":" << line;
+        }
+        sample << "\n";
+    }
+    sample << "\n";
+    std::lock_guard<std::mutex> lock(managedStackSamplesMutex);
+    if (managedStackSamples)
+    {
+        *managedStackSamples << sample.str();
+    }
+}
+
+} } // namespace cminor::machine
@@ -0,0 +1,40 @@
+// =================================
+// Copyright (c) 2017 Seppo Laakko
+// Distributed under the MIT license
+// =================================
+
+#ifndef CMINOR_MACHINE_PERF_MAP_INCLUDED
+#define CMINOR_MACHINE_PERF_MAP_INCLUDED
+#include <cminor/machine/MachineApi.hpp>
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+namespace cminor { namespace machine {
+
+class Thread;
+
+//  Writing a perf map is enabled by the --perf-map option of the virtual machine. When a program compiled to native code is prepared for execution, 
+//  a line 'START SIZE NAME' is appended to /tmp/perf-PID.map for each native function, where START and SIZE are hexadecimal and NAME is the mangled name 
+//  of the function. Linux perf reads the map to symbolize samples that hit the native shared libraries.
+
+MACHINE_API void EnablePerfMap();
+MACHINE_API bool PerfMapEnabled();
+MACHINE_API void WritePerfMap();
+
+//  Managed stack sampling is enabled by the --perf-stacks option of the virtual machine for programs run by interpreting the intermediate code.
+//  A sampler thread requests a sample managedStackSampleFrequency times per second. Each interpreter thread takes the sample at the next instruction 
+//  boundary and writes a record 'sample TID TIME' followed by one line 'FUNCTION:LINE' for each frame, innermost frame first. TID is the thread id of 
+//  the operating system and TIME is the monotonic clock time in nanoseconds, so that the records can be matched to the samples of 'perf record -k mono'.
+
+const int managedStackSampleFrequency = 99;
+
+extern std::atomic<uint64_t> managedStackSampleCount;
+
+MACHINE_API void StartManagedStackSampling(const std::string& filePath);
+MACHINE_API void StopManagedStackSampling();
+MACHINE_API void WriteManagedStackSample(Thread& thread);
+
+} } // namespace cminor::machine
+
+#endif // CMINOR_MACHINE_PERF_MAP_INCLUDED
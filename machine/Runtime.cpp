@@ -4,6 +4,8 @@
 // =================================
 
 #include <cminor/machine/Runtime.hpp>
+#include <cminor/machine/StringOps.hpp>
+#include <cminor/machine/ArrayOps.hpp>
 #include <cminor/machine/Machine.hpp>
 #include <cminor/machine/Instruction.hpp>
 #include <cminor/machine/Function.hpp>
@@ -17,8 +19,26 @@
 #include <intrin.h>
 #endif
 #endif
+#include <cstring>
 #include <iostream>
 
+//  RT_RECORD_FRAME records the stack pointer and the frame pointer of the native caller of the runtime function in the thread,
+//  so that a garbage collection triggered inside the runtime function can walk the frames of native code.
+//  Every runtime function that can allocate, wait for a lock or throw a managed exception records the frame.
+//  Must be expanded directly in the body of the extern "C" runtime function, not in a helper called by it.
+
+#ifdef STACK_WALK_GC
+#ifdef _WIN32
+#define RT_RECORD_FRAME(thread) do { Thread& rtFrameThread = (thread); rtFrameThread.SetStackPtr(_AddressOfReturnAddress()); rtFrameThread.SetFramePtr(getrbp()); } while (false)
+#else
+#define RT_RECORD_FRAME(thread) do { Thread& rtFrameThread = (thread); \
+    rtFrameThread.SetStackPtr(static_cast<void**>(__builtin_frame_address(0)) + 1); \
+    rtFrameThread.SetFramePtr(*static_cast<void**>(__builtin_frame_address(0))); } while (false)
+#endif
+#else
+#define RT_RECORD_FRAME(thread) do { } while (false)
+#endif
+
 namespace cminor { namespace machine {
 
 using namespace cminor::unicode;
@@ -62,13 +82,9 @@ std::u32string GetStackTrace()
     Thread& thread = GetCurrentThread();
     std::u32string stackTrace;
     bool first = true;
-    void* stackPtr = thread.StackPtr();
-    void* framePtr = thread.FramePtr();
-    void* instructionPtr = *reinterpret_cast<void**>(stackPtr);
-    const Function* threadMain = thread.ThreadMain();
-    Function* fun = FunctionTable::GetNativeFunction(instructionPtr);
-    while (fun)
+    for (NativeFrameWalker walker(thread); walker.CurrentFunction(); walker.Next())
     {
+        Function* fun = walker.CurrentFunction();
         if (first)
         {
             first = false;
@@ -85,7 +101,7 @@ std::u32string GetStackTrace()
             int32_t lineNumberVarOffset = fun->LineNumberVarOffset();
             if (lineNumberVarOffset != -1)
             {
-                uint32_t* lineNumberVarPtr = reinterpret_cast<uint32_t*>(reinterpret_cast<uint8_t*>(framePtr) + lineNumberVarOffset);
+                uint32_t* lineNumberVarPtr = reinterpret_cast<uint32_t*>(walker.FramePtr() + lineNumberVarOffset);
                 lineNumber = *lineNumberVarPtr;
             }
             if (lineNumber != -1)
@@ -95,15 +111,6 @@ std::u32string GetStackTrace()
             }
         }
         stackTrace.append(funStr);
-        if (fun == threadMain)
-        {
-            break;
-        }
-        stackPtr = reinterpret_cast<uint8_t*>(stackPtr) + fun->FrameSize();
-        framePtr = *reinterpret_cast<void**>(stackPtr);
-        stackPtr = reinterpret_cast<uint8_t*>(stackPtr) + 8;
-        instructionPtr = *reinterpret_cast<void**>(stackPtr);
-        fun = FunctionTable::GetNativeFunction(instructionPtr);
     }
     return stackTrace;
 }
@@ -222,6 +229,34 @@ void RtThrowThreadingException(const ThreadingException& ex)
     RtThrowCminorException(ex.Message(), U"System.Threading.ThreadingException");
 }
 
+//  Calls fn and translates a machine exception thrown by it to the corresponding cminor exception.
+
+template<typename Fn>
+auto RtInvoke(Fn fn) -> decltype(fn())
+{
+    try
+    {
+        return fn();
+    }
+    catch (const NullReferenceException& ex)
+    {
+        RtThrowNullReferenceException(ex);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        RtThrowIndexOutOfRangeException(ex);
+    }
+    catch (const InvalidCastException& ex)
+    {
+        RtThrowInvalidCastException(ex);
+    }
+    catch (const SystemException& ex)
+    {
+        RtThrowSystemException(ex);
+    }
+    return decltype(fn())();
+}
+
 extern "C" MACHINE_API void RtThrowException(uint64_t exceptionObjectReference)
 {
     if (exceptionObjectReference == 0)
@@ -229,19 +264,8 @@ extern "C" MACHINE_API void RtThrowException(uint64_t exceptionObjectReference)
         RtThrowSystemException(SystemException("tried to throw null reference"));
         return;
     }
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
     Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(thread);
     currentException = exceptionObjectReference;
     ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
     std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
@@ -255,6 +279,7 @@ extern "C" MACHINE_API void RtThrowException(uint64_t exceptionObjectReference)
 
 extern "C" MACHINE_API bool RtHandleException(void* classDataPtr)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     ObjectReference exceptionObjectReference = currentException;
     if (exceptionObjectReference.IsNull())
     {
@@ -274,12 +299,14 @@ extern "C" MACHINE_API bool RtHandleException(void* classDataPtr)
 
 extern "C" MACHINE_API uint64_t RtGetException()
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     ObjectReference exceptionObjectReference = currentException;
     return exceptionObjectReference.Value();
 }
 
 extern "C" MACHINE_API void RtDisposeException()
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     ObjectReference exceptionObjectReference = currentException;
     currentException = 0;
     if (exceptionObjectReference.IsNull())
@@ -318,19 +345,7 @@ extern "C" MACHINE_API void RtUnwindFunctionStack(void* functionStackEntry)
 
 extern "C" MACHINE_API int8_t RtLoadFieldSb(uint64_t objectReference, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -346,19 +361,7 @@ extern "C" MACHINE_API int8_t RtLoadFieldSb(uint64_t objectReference, int32_t fi
 
 extern "C" MACHINE_API uint8_t RtLoadFieldBy(uint64_t objectReference, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -374,19 +377,7 @@ extern "C" MACHINE_API uint8_t RtLoadFieldBy(uint64_t objectReference, int32_t f
 
 extern "C" MACHINE_API int16_t RtLoadFieldSh(uint64_t objectReference, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -402,19 +393,7 @@ extern "C" MACHINE_API int16_t RtLoadFieldSh(uint64_t objectReference, int32_t f
 
 extern "C" MACHINE_API uint16_t RtLoadFieldUs(uint64_t objectReference, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -430,19 +409,7 @@ extern "C" MACHINE_API uint16_t RtLoadFieldUs(uint64_t objectReference, int32_t
 
 extern "C" MACHINE_API int32_t RtLoadFieldIn(uint64_t objectReference, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -458,19 +425,7 @@ extern "C" MACHINE_API int32_t RtLoadFieldIn(uint64_t objectReference, int32_t f
 
 extern "C" MACHINE_API uint32_t RtLoadFieldUi(uint64_t objectReference, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -486,19 +441,7 @@ extern "C" MACHINE_API uint32_t RtLoadFieldUi(uint64_t objectReference, int32_t
 
 extern "C" MACHINE_API int64_t RtLoadFieldLo(uint64_t objectReference, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -514,19 +457,7 @@ extern "C" MACHINE_API int64_t RtLoadFieldLo(uint64_t objectReference, int32_t f
 
 extern "C" MACHINE_API uint64_t RtLoadFieldUl(uint64_t objectReference, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -542,19 +473,7 @@ extern "C" MACHINE_API uint64_t RtLoadFieldUl(uint64_t objectReference, int32_t
 
 extern "C" MACHINE_API float RtLoadFieldFl(uint64_t objectReference, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -570,19 +489,7 @@ extern "C" MACHINE_API float RtLoadFieldFl(uint64_t objectReference, int32_t fie
 
 extern "C" MACHINE_API double RtLoadFieldDo(uint64_t objectReference, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -598,19 +505,7 @@ extern "C" MACHINE_API double RtLoadFieldDo(uint64_t objectReference, int32_t fi
 
 extern "C" MACHINE_API uint32_t RtLoadFieldCh(uint64_t objectReference, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -626,19 +521,7 @@ extern "C" MACHINE_API uint32_t RtLoadFieldCh(uint64_t objectReference, int32_t
 
 extern "C" MACHINE_API bool RtLoadFieldBo(uint64_t objectReference, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -654,19 +537,7 @@ extern "C" MACHINE_API bool RtLoadFieldBo(uint64_t objectReference, int32_t fiel
 
 extern "C" MACHINE_API uint64_t RtLoadFieldOb(uint64_t objectReference, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -682,19 +553,7 @@ extern "C" MACHINE_API uint64_t RtLoadFieldOb(uint64_t objectReference, int32_t
 
 extern "C" MACHINE_API void RtStoreFieldSb(uint64_t objectReference, int8_t fieldValue, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -708,19 +567,7 @@ extern "C" MACHINE_API void RtStoreFieldSb(uint64_t objectReference, int8_t fiel
 
 extern "C" MACHINE_API void RtStoreFieldBy(uint64_t objectReference, uint8_t fieldValue, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -734,19 +581,7 @@ extern "C" MACHINE_API void RtStoreFieldBy(uint64_t objectReference, uint8_t fie
 
 extern "C" MACHINE_API void RtStoreFieldSh(uint64_t objectReference, int16_t fieldValue, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -760,19 +595,7 @@ extern "C" MACHINE_API void RtStoreFieldSh(uint64_t objectReference, int16_t fie
 
 extern "C" MACHINE_API void RtStoreFieldUs(uint64_t objectReference, uint16_t fieldValue, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -786,19 +609,7 @@ extern "C" MACHINE_API void RtStoreFieldUs(uint64_t objectReference, uint16_t fi
 
 extern "C" MACHINE_API void RtStoreFieldIn(uint64_t objectReference, int32_t fieldValue, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -812,19 +623,7 @@ extern "C" MACHINE_API void RtStoreFieldIn(uint64_t objectReference, int32_t fie
 
 extern "C" MACHINE_API void RtStoreFieldUi(uint64_t objectReference, uint32_t fieldValue, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -838,19 +637,7 @@ extern "C" MACHINE_API void RtStoreFieldUi(uint64_t objectReference, uint32_t fi
 
 extern "C" MACHINE_API void RtStoreFieldLo(uint64_t objectReference, int64_t fieldValue, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -864,19 +651,7 @@ extern "C" MACHINE_API void RtStoreFieldLo(uint64_t objectReference, int64_t fie
 
 extern "C" MACHINE_API void RtStoreFieldUl(uint64_t objectReference, uint64_t fieldValue, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -890,19 +665,7 @@ extern "C" MACHINE_API void RtStoreFieldUl(uint64_t objectReference, uint64_t fi
 
 extern "C" MACHINE_API void RtStoreFieldFl(uint64_t objectReference, float fieldValue, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -916,19 +679,7 @@ extern "C" MACHINE_API void RtStoreFieldFl(uint64_t objectReference, float field
 
 extern "C" MACHINE_API void RtStoreFieldDo(uint64_t objectReference, double fieldValue, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -942,19 +693,7 @@ extern "C" MACHINE_API void RtStoreFieldDo(uint64_t objectReference, double fiel
 
 extern "C" MACHINE_API void RtStoreFieldCh(uint64_t objectReference, uint32_t fieldValue, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -968,19 +707,7 @@ extern "C" MACHINE_API void RtStoreFieldCh(uint64_t objectReference, uint32_t fi
 
 extern "C" MACHINE_API void RtStoreFieldBo(uint64_t objectReference, bool fieldValue, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -994,19 +721,7 @@ extern "C" MACHINE_API void RtStoreFieldBo(uint64_t objectReference, bool fieldV
 
 extern "C" MACHINE_API void RtStoreFieldOb(uint64_t objectReference, uint64_t fieldValue, int32_t fieldIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -1020,19 +735,7 @@ extern "C" MACHINE_API void RtStoreFieldOb(uint64_t objectReference, uint64_t fi
 
 extern "C" MACHINE_API int8_t RtLoadElemSb(uint64_t arrayReference, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1052,19 +755,7 @@ extern "C" MACHINE_API int8_t RtLoadElemSb(uint64_t arrayReference, int32_t elem
 
 extern "C" MACHINE_API uint8_t RtLoadElemBy(uint64_t arrayReference, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1084,19 +775,7 @@ extern "C" MACHINE_API uint8_t RtLoadElemBy(uint64_t arrayReference, int32_t ele
 
 extern "C" MACHINE_API int16_t RtLoadElemSh(uint64_t arrayReference, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1116,19 +795,7 @@ extern "C" MACHINE_API int16_t RtLoadElemSh(uint64_t arrayReference, int32_t ele
 
 extern "C" MACHINE_API uint16_t RtLoadElemUs(uint64_t arrayReference, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1148,19 +815,7 @@ extern "C" MACHINE_API uint16_t RtLoadElemUs(uint64_t arrayReference, int32_t el
 
 extern "C" MACHINE_API int32_t RtLoadElemIn(uint64_t arrayReference, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1180,19 +835,7 @@ extern "C" MACHINE_API int32_t RtLoadElemIn(uint64_t arrayReference, int32_t ele
 
 extern "C" MACHINE_API uint32_t RtLoadElemUi(uint64_t arrayReference, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1212,19 +855,7 @@ extern "C" MACHINE_API uint32_t RtLoadElemUi(uint64_t arrayReference, int32_t el
 
 extern "C" MACHINE_API int64_t RtLoadElemLo(uint64_t arrayReference, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1244,19 +875,7 @@ extern "C" MACHINE_API int64_t RtLoadElemLo(uint64_t arrayReference, int32_t ele
 
 extern "C" MACHINE_API uint64_t RtLoadElemUl(uint64_t arrayReference, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1276,19 +895,7 @@ extern "C" MACHINE_API uint64_t RtLoadElemUl(uint64_t arrayReference, int32_t el
 
 extern "C" MACHINE_API float RtLoadElemFl(uint64_t arrayReference, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1308,19 +915,7 @@ extern "C" MACHINE_API float RtLoadElemFl(uint64_t arrayReference, int32_t eleme
 
 extern "C" MACHINE_API double RtLoadElemDo(uint64_t arrayReference, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1340,19 +935,7 @@ extern "C" MACHINE_API double RtLoadElemDo(uint64_t arrayReference, int32_t elem
 
 extern "C" MACHINE_API uint32_t RtLoadElemCh(uint64_t arrayReference, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1372,19 +955,7 @@ extern "C" MACHINE_API uint32_t RtLoadElemCh(uint64_t arrayReference, int32_t el
 
 extern "C" MACHINE_API bool RtLoadElemBo(uint64_t arrayReference, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1404,19 +975,7 @@ extern "C" MACHINE_API bool RtLoadElemBo(uint64_t arrayReference, int32_t elemen
 
 extern "C" MACHINE_API uint64_t RtLoadElemOb(uint64_t arrayReference, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1436,19 +995,7 @@ extern "C" MACHINE_API uint64_t RtLoadElemOb(uint64_t arrayReference, int32_t el
 
 extern "C" MACHINE_API void RtStoreElemSb(uint64_t arrayReference, int8_t elementValue, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1466,19 +1013,7 @@ extern "C" MACHINE_API void RtStoreElemSb(uint64_t arrayReference, int8_t elemen
 
 extern "C" MACHINE_API void RtStoreElemBy(uint64_t arrayReference, uint8_t elementValue, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1496,19 +1031,7 @@ extern "C" MACHINE_API void RtStoreElemBy(uint64_t arrayReference, uint8_t eleme
 
 extern "C" MACHINE_API void RtStoreElemSh(uint64_t arrayReference, int16_t elementValue, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1526,19 +1049,7 @@ extern "C" MACHINE_API void RtStoreElemSh(uint64_t arrayReference, int16_t eleme
 
 extern "C" MACHINE_API void RtStoreElemUs(uint64_t arrayReference, uint16_t elementValue, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1556,19 +1067,7 @@ extern "C" MACHINE_API void RtStoreElemUs(uint64_t arrayReference, uint16_t elem
 
 extern "C" MACHINE_API void RtStoreElemIn(uint64_t arrayReference, int32_t elementValue, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1586,19 +1085,7 @@ extern "C" MACHINE_API void RtStoreElemIn(uint64_t arrayReference, int32_t eleme
 
 extern "C" MACHINE_API void RtStoreElemUi(uint64_t arrayReference, uint32_t elementValue, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1616,19 +1103,7 @@ extern "C" MACHINE_API void RtStoreElemUi(uint64_t arrayReference, uint32_t elem
 
 extern "C" MACHINE_API void RtStoreElemLo(uint64_t arrayReference, int64_t elementValue, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1646,19 +1121,7 @@ extern "C" MACHINE_API void RtStoreElemLo(uint64_t arrayReference, int64_t eleme
 
 extern "C" MACHINE_API void RtStoreElemUl(uint64_t arrayReference, uint64_t elementValue, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1676,19 +1139,7 @@ extern "C" MACHINE_API void RtStoreElemUl(uint64_t arrayReference, uint64_t elem
 
 extern "C" MACHINE_API void RtStoreElemFl(uint64_t arrayReference, float elementValue, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1706,19 +1157,7 @@ extern "C" MACHINE_API void RtStoreElemFl(uint64_t arrayReference, float element
 
 extern "C" MACHINE_API void RtStoreElemDo(uint64_t arrayReference, double elementValue, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1736,19 +1175,7 @@ extern "C" MACHINE_API void RtStoreElemDo(uint64_t arrayReference, double elemen
 
 extern "C" MACHINE_API void RtStoreElemCh(uint64_t arrayReference, uint32_t elementValue, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1766,19 +1193,7 @@ extern "C" MACHINE_API void RtStoreElemCh(uint64_t arrayReference, uint32_t elem
 
 extern "C" MACHINE_API void RtStoreElemBo(uint64_t arrayReference, bool elementValue, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1796,19 +1211,7 @@ extern "C" MACHINE_API void RtStoreElemBo(uint64_t arrayReference, bool elementV
 
 extern "C" MACHINE_API void RtStoreElemOb(uint64_t arrayReference, uint64_t elementValue, int32_t elementIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(arrayReference);
@@ -1826,19 +1229,7 @@ extern "C" MACHINE_API void RtStoreElemOb(uint64_t arrayReference, uint64_t elem
 
 extern "C" MACHINE_API void* RtResolveVirtualFunctionCallAddress(uint64_t objectReference, uint32_t vmtIndex)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference receiver(objectReference);
@@ -1881,19 +1272,7 @@ extern "C" MACHINE_API void* RtResolveVirtualFunctionCallAddress(uint64_t object
 
 extern "C" MACHINE_API void* RtResolveInterfaceCallAddress(uint64_t objectReference, uint32_t imtIndex, uint64_t* receiver)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference interfaceObject(objectReference);
@@ -1990,19 +1369,8 @@ extern "C" MACHINE_API void RtVmCall(void* function, void* constantPool, uint32_
 {
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
         Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
+        RT_RECORD_FRAME(thread);
         Function* fun = static_cast<Function*>(function);
         int numLocals = vmCallContext->numLocals;
         uint64_t frameSize = Align(sizeof(Frame), 8) + numLocals * Align(sizeof(LocalVariable), 8);
@@ -2060,19 +1428,7 @@ extern "C" MACHINE_API void RtVmCall(void* function, void* constantPool, uint32_
 
 extern "C" MACHINE_API void* RtResolveDelegateCallAddress(void* function)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         Function* fun = static_cast<Function*>(function);
@@ -2105,19 +1461,7 @@ extern "C" MACHINE_API void* RtResolveDelegateCallAddress(void* function)
 
 extern "C" MACHINE_API void* RtResolveClassDelegateCallAddress(uint64_t classDlg, uint64_t* classObject)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference classDelegateRef(classDlg);
@@ -2155,181 +1499,475 @@ extern "C" MACHINE_API void* RtResolveClassDelegateCallAddress(uint64_t classDlg
     {
         RtThrowSystemException(ex);
     }
-    return nullptr;
+    return nullptr;
+}
+
+extern "C" MACHINE_API void RtSetClassDataPtr(uint64_t objectReference, void* classDataPtr)
+{
+    RT_RECORD_FRAME(GetCurrentThread());
+    try
+    {
+        ObjectReference reference(objectReference);
+        ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+        std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+        IntegralValue classDataFieldValue = memoryPool.GetField(reference, 0, lock);
+        if (!classDataFieldValue.AsClassDataPtr())
+        {
+            ClassData* cd = static_cast<ClassData*>(classDataPtr);
+            IntegralValue classDataFieldValue = IntegralValue(cd);
+            memoryPool.SetField(reference, 0, classDataFieldValue, lock);
+        }
+    }
+    catch (const NullReferenceException& ex)
+    {
+        RtThrowNullReferenceException(ex);
+    }
+}
+
+AllocationContext emptyAllocationContext;
+
+//  Natively compiled code allocates objects inline using the allocation context returned by this function and calls RtCreateObject when the 
+//  context has no room or no handles left. A thread without an allocation context gets an empty context, so that it always takes the slow path.
+
+extern "C" MACHINE_API void* RtGetAllocationContext()
+{
+    AllocationContext* allocationContext = GetCurrentThread().GetAllocationContext();
+    if (allocationContext)
+    {
+        return allocationContext;
+    }
+    return &emptyAllocationContext;
+}
+
+extern "C" MACHINE_API uint64_t RtCreateObject(void* classDataPtr)
+{
+    try
+    {
+        Thread& thread = GetCurrentThread();
+        RT_RECORD_FRAME(thread);
+        ClassData* cd = static_cast<ClassData*>(classDataPtr);
+        ObjectReference objectReference = GetManagedMemoryPool().CreateObject(thread, cd->Type());
+        AllocationContext* allocationContext = thread.GetAllocationContext();
+        if (allocationContext && allocationContext->NumHandles() == 0)
+        {
+            GetManagedMemoryPool().ReserveAllocationHandles(thread, *allocationContext);
+        }
+        return objectReference.Value();
+    }
+    catch (const SystemException& ex)
+    {
+        RtThrowSystemException(ex);
+    }
+    return 0;
+}
+
+extern "C" MACHINE_API uint64_t RtCopyObject(uint64_t objectReference)
+{
+    try
+    {
+        Thread& thread = GetCurrentThread();
+        RT_RECORD_FRAME(thread);
+        ObjectReference reference(objectReference);
+        ObjectReference copy = GetManagedMemoryPool().CopyObject(thread, reference);
+        return copy.Value();
+    }
+    catch (const SystemException& ex)
+    {
+        RtThrowSystemException(ex);
+    }
+    return 0;
+}
+
+extern "C" MACHINE_API uint64_t RtStrLitToString(const char32_t* strLitValue)
+{
+    try
+    {
+        Thread& thread = GetCurrentThread();
+        RT_RECORD_FRAME(thread);
+        ObjectReference objectReference = GetManagedMemoryPool().InternStringLiteral(thread, strLitValue);
+        return objectReference.Value();
+    }
+    catch (const SystemException& ex)
+    {
+        RtThrowSystemException(ex);
+    }
+    return 0;
+}
+
+extern "C" MACHINE_API uint32_t RtLoadStringChar(int32_t index, uint64_t str)
+{
+    RT_RECORD_FRAME(GetCurrentThread());
+    try
+    {
+        ObjectReference strReference(str);
+        IntegralValue value = GetManagedMemoryPool().GetStringChar(strReference, index);
+        return value.AsUInt();
+    }
+    catch (const NullReferenceException& ex)
+    {
+        RtThrowNullReferenceException(ex);
+    }
+    catch (const SystemException& ex)
+    {
+        RtThrowSystemException(ex);
+    }
+    return 0;
+}
+
+extern "C" MACHINE_API int32_t RtStringIndexOf(uint64_t str, uint32_t c, int32_t start)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    return RtInvoke([&]() -> int32_t
+    {
+        ObjectReference strReference(str);
+        return StringIndexOf(strReference, static_cast<char32_t>(c), start);
+    });
+}
+
+extern "C" MACHINE_API int32_t RtStringLastIndexOf(uint64_t str, uint32_t c, int32_t start)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    return RtInvoke([&]() -> int32_t
+    {
+        ObjectReference strReference(str);
+        return StringLastIndexOf(strReference, static_cast<char32_t>(c), start);
+    });
+}
+
+extern "C" MACHINE_API int32_t RtStringIndexOfAny(uint64_t str, uint64_t chars, int32_t start)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    return RtInvoke([&]() -> int32_t
+    {
+        ObjectReference strReference(str);
+        ObjectReference charsReference(chars);
+        return StringIndexOfAny(strReference, charsReference, start);
+    });
+}
+
+extern "C" MACHINE_API int32_t RtStringLastIndexOfAny(uint64_t str, uint64_t chars, int32_t start)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    return RtInvoke([&]() -> int32_t
+    {
+        ObjectReference strReference(str);
+        ObjectReference charsReference(chars);
+        return StringLastIndexOfAny(strReference, charsReference, start);
+    });
+}
+
+extern "C" MACHINE_API bool RtStringStartsWith(uint64_t str, uint64_t prefix)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    return RtInvoke([&]() -> bool
+    {
+        ObjectReference strReference(str);
+        ObjectReference prefixReference(prefix);
+        return StringStartsWith(strReference, prefixReference);
+    });
+}
+
+extern "C" MACHINE_API bool RtStringEndsWith(uint64_t str, uint64_t suffix)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    return RtInvoke([&]() -> bool
+    {
+        ObjectReference strReference(str);
+        ObjectReference suffixReference(suffix);
+        return StringEndsWith(strReference, suffixReference);
+    });
+}
+
+extern "C" MACHINE_API bool RtStringEqual(uint64_t left, uint64_t right)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    return RtInvoke([&]() -> bool
+    {
+        ObjectReference leftReference(left);
+        ObjectReference rightReference(right);
+        return StringEqual(leftReference, rightReference);
+    });
+}
+
+extern "C" MACHINE_API bool RtStringLess(uint64_t left, uint64_t right)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    return RtInvoke([&]() -> bool
+    {
+        ObjectReference leftReference(left);
+        ObjectReference rightReference(right);
+        return StringLess(leftReference, rightReference);
+    });
+}
+
+extern "C" MACHINE_API uint64_t RtStringGetHashCode(uint64_t str)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    return RtInvoke([&]() -> uint64_t
+    {
+        ObjectReference strReference(str);
+        return StringHashCode(strReference);
+    });
+}
+
+extern "C" MACHINE_API uint64_t RtStringSubstring(uint64_t str, int32_t start, int32_t length)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    return RtInvoke([&]() -> uint64_t
+    {
+        ObjectReference strReference(str);
+        return StringSubstring(thread, strReference, start, length).Value();
+    });
+}
+
+extern "C" MACHINE_API uint64_t RtStringTrim(uint64_t str)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    return RtInvoke([&]() -> uint64_t
+    {
+        ObjectReference strReference(str);
+        return StringTrim(thread, strReference).Value();
+    });
+}
+
+extern "C" MACHINE_API uint64_t RtStringConcat(uint64_t left, uint64_t right)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    return RtInvoke([&]() -> uint64_t
+    {
+        ObjectReference leftReference(left);
+        ObjectReference rightReference(right);
+        return StringConcat(thread, leftReference, rightReference).Value();
+    });
+}
+
+extern "C" MACHINE_API uint64_t RtStringFromUtf8(uint64_t bytes, int32_t offset, int32_t count)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    return RtInvoke([&]() -> uint64_t
+    {
+        ObjectReference bytesReference(bytes);
+        return StringFromUtf8(thread, bytesReference, offset, count).Value();
+    });
+}
+
+extern "C" MACHINE_API int32_t RtStringUtf8Length(uint64_t str)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    return RtInvoke([&]() -> int32_t
+    {
+        ObjectReference strReference(str);
+        return StringUtf8Length(strReference);
+    });
+}
+
+extern "C" MACHINE_API int32_t RtStringToUtf8(uint64_t str, uint64_t bytes, int32_t offset)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    return RtInvoke([&]() -> int32_t
+    {
+        ObjectReference strReference(str);
+        ObjectReference bytesReference(bytes);
+        return StringToUtf8(strReference, bytesReference, offset);
+    });
+}
+
+extern "C" MACHINE_API void RtArrayCopy(uint64_t source, int32_t sourceIndex, uint64_t destination, int32_t destinationIndex, int32_t length)
+{
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
+    try
+    {
+        ObjectReference sourceReference(source);
+        ObjectReference destinationReference(destination);
+        ArrayCopy(sourceReference, sourceIndex, destinationReference, destinationIndex, length);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        RtThrowNullReferenceException(ex);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        RtThrowIndexOutOfRangeException(ex);
+    }
+    catch (const InvalidCastException& ex)
+    {
+        RtThrowInvalidCastException(ex);
+    }
+    catch (const SystemException& ex)
+    {
+        RtThrowSystemException(ex);
+    }
 }
 
-extern "C" MACHINE_API void RtSetClassDataPtr(uint64_t objectReference, void* classDataPtr)
+extern "C" MACHINE_API void RtArrayFill(uint64_t arr, uint64_t value, int32_t index, int32_t count)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
     Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(thread);
     try
     {
-        ObjectReference reference(objectReference);
-        ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
-        std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
-        IntegralValue classDataFieldValue = memoryPool.GetField(reference, 0, lock);
-        if (!classDataFieldValue.AsClassDataPtr())
-        {
-            ClassData* cd = static_cast<ClassData*>(classDataPtr);
-            IntegralValue classDataFieldValue = IntegralValue(cd);
-            memoryPool.SetField(reference, 0, classDataFieldValue, lock);
-        }
+        ObjectReference arrayReference(arr);
+        ArrayFill(arrayReference, value, index, count);
     }
     catch (const NullReferenceException& ex)
     {
         RtThrowNullReferenceException(ex);
     }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        RtThrowIndexOutOfRangeException(ex);
+    }
+    catch (const InvalidCastException& ex)
+    {
+        RtThrowInvalidCastException(ex);
+    }
+    catch (const SystemException& ex)
+    {
+        RtThrowSystemException(ex);
+    }
 }
 
-extern "C" MACHINE_API uint64_t RtCreateObject(void* classDataPtr)
+extern "C" MACHINE_API bool RtArrayEqual(uint64_t left, uint64_t right)
 {
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
-        Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
-        ClassData* cd = static_cast<ClassData*>(classDataPtr);
-        ObjectReference objectReference = GetManagedMemoryPool().CreateObject(thread, cd->Type());
-        return objectReference.Value();
+        ObjectReference leftReference(left);
+        ObjectReference rightReference(right);
+        return ArrayEqual(leftReference, rightReference);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        RtThrowNullReferenceException(ex);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        RtThrowIndexOutOfRangeException(ex);
+    }
+    catch (const InvalidCastException& ex)
+    {
+        RtThrowInvalidCastException(ex);
     }
     catch (const SystemException& ex)
     {
         RtThrowSystemException(ex);
     }
-    return 0;
+    return false;
 }
 
-extern "C" MACHINE_API uint64_t RtCopyObject(uint64_t objectReference)
+extern "C" MACHINE_API int32_t RtArrayIndexOf(uint64_t arr, uint64_t value, int32_t start, int32_t count)
 {
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
-        Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
-        ObjectReference reference(objectReference);
-        ObjectReference copy = GetManagedMemoryPool().CopyObject(thread, reference);
-        return copy.Value();
+        ObjectReference arrayReference(arr);
+        return ArrayIndexOf(arrayReference, value, start, count);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        RtThrowNullReferenceException(ex);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        RtThrowIndexOutOfRangeException(ex);
+    }
+    catch (const InvalidCastException& ex)
+    {
+        RtThrowInvalidCastException(ex);
     }
     catch (const SystemException& ex)
     {
         RtThrowSystemException(ex);
     }
-    return 0;
+    return -1;
 }
 
-extern "C" MACHINE_API uint64_t RtStrLitToString(const char32_t* strLitValue)
+extern "C" MACHINE_API void RtArrayReverse(uint64_t arr, int32_t index, int32_t count)
 {
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
-        Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
-        uint32_t len = static_cast<uint32_t>(StringLen(strLitValue));
-        ClassData* classData = ClassDataTable::GetSystemStringClassData();
-        ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
-        std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
-        ObjectReference objectReference = memoryPool.CreateObject(thread, classData->Type(), lock);
-        AllocationHandle charsHandle = memoryPool.CreateStringCharsFromLiteral(thread, strLitValue, len, lock);
-        memoryPool.SetField(objectReference, 0, IntegralValue(classData), lock);
-        memoryPool.SetField(objectReference, 1, MakeIntegralValue<int32_t>(len, ValueType::intType), lock);
-        memoryPool.SetField(objectReference, 2, charsHandle, lock);
-        return objectReference.Value();
+        ObjectReference arrayReference(arr);
+        ArrayReverse(arrayReference, index, count);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        RtThrowNullReferenceException(ex);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        RtThrowIndexOutOfRangeException(ex);
+    }
+    catch (const InvalidCastException& ex)
+    {
+        RtThrowInvalidCastException(ex);
     }
     catch (const SystemException& ex)
     {
         RtThrowSystemException(ex);
     }
-    return 0;
 }
 
-extern "C" MACHINE_API uint32_t RtLoadStringChar(int32_t index, uint64_t str)
+extern "C" MACHINE_API bool RtArraySort(uint64_t arr, int32_t index, int32_t count, bool parallel)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
     Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(thread);
     try
     {
-        ObjectReference strReference(str);
-        IntegralValue value = GetManagedMemoryPool().GetStringChar(strReference, index);
-        return value.AsUInt();
+        ObjectReference arrayReference(arr);
+        return ArraySort(thread, arrayReference, index, count, parallel);
     }
     catch (const NullReferenceException& ex)
     {
         RtThrowNullReferenceException(ex);
     }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        RtThrowIndexOutOfRangeException(ex);
+    }
     catch (const SystemException& ex)
     {
         RtThrowSystemException(ex);
     }
-    return 0;
+    return false;
+}
+
+//  Natively compiled MemoryMappedFile accessors read from the cached address of the mapping directly. They neither allocate nor throw, 
+//  so they do not record the frame.
+
+extern "C" MACHINE_API uint8_t RtLoadMappedByte(uint64_t address, int64_t index)
+{
+    return reinterpret_cast<const uint8_t*>(address)[index];
+}
+
+extern "C" MACHINE_API int32_t RtLoadMappedInt(uint64_t address, int64_t index)
+{
+    int32_t value = 0;
+    std::memcpy(&value, reinterpret_cast<const uint8_t*>(address) + index, sizeof(value));
+    return value;
 }
 
 extern "C" MACHINE_API uint64_t RtDownCast(uint64_t objectReference, void* classDataPtr)
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
-#ifdef STACK_WALK_GC
-    Thread& thread = GetCurrentThread();
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -2368,6 +2006,7 @@ extern "C" MACHINE_API uint64_t RtDownCast(uint64_t objectReference, void* class
 
 extern "C" MACHINE_API void* RtStaticInit(void* classDataPtr)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2413,6 +2052,7 @@ extern "C" MACHINE_API void* RtStaticInit(void* classDataPtr)
 
 extern "C" MACHINE_API void RtDoneStaticInit(void* classDataPtr)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2437,6 +2077,7 @@ extern "C" MACHINE_API void RtDoneStaticInit(void* classDataPtr)
 
 extern "C" MACHINE_API int8_t RtLoadStaticFieldSb(void* classDataPtr, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2461,6 +2102,7 @@ extern "C" MACHINE_API int8_t RtLoadStaticFieldSb(void* classDataPtr, int32_t fi
 
 extern "C" MACHINE_API uint8_t RtLoadStaticFieldBy(void* classDataPtr, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2485,6 +2127,7 @@ extern "C" MACHINE_API uint8_t RtLoadStaticFieldBy(void* classDataPtr, int32_t f
 
 extern "C" MACHINE_API int16_t RtLoadStaticFieldSh(void* classDataPtr, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2509,6 +2152,7 @@ extern "C" MACHINE_API int16_t RtLoadStaticFieldSh(void* classDataPtr, int32_t f
 
 extern "C" MACHINE_API uint16_t RtLoadStaticFieldUs(void* classDataPtr, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2533,6 +2177,7 @@ extern "C" MACHINE_API uint16_t RtLoadStaticFieldUs(void* classDataPtr, int32_t
 
 extern "C" MACHINE_API int32_t RtLoadStaticFieldIn(void* classDataPtr, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2557,6 +2202,7 @@ extern "C" MACHINE_API int32_t RtLoadStaticFieldIn(void* classDataPtr, int32_t f
 
 extern "C" MACHINE_API uint32_t RtLoadStaticFieldUi(void* classDataPtr, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2581,6 +2227,7 @@ extern "C" MACHINE_API uint32_t RtLoadStaticFieldUi(void* classDataPtr, int32_t
 
 extern "C" MACHINE_API int64_t RtLoadStaticFieldLo(void* classDataPtr, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2605,6 +2252,7 @@ extern "C" MACHINE_API int64_t RtLoadStaticFieldLo(void* classDataPtr, int32_t f
 
 extern "C" MACHINE_API uint64_t RtLoadStaticFieldUl(void* classDataPtr, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2629,6 +2277,7 @@ extern "C" MACHINE_API uint64_t RtLoadStaticFieldUl(void* classDataPtr, int32_t
 
 extern "C" MACHINE_API float RtLoadStaticFieldFl(void* classDataPtr, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2653,6 +2302,7 @@ extern "C" MACHINE_API float RtLoadStaticFieldFl(void* classDataPtr, int32_t fie
 
 extern "C" MACHINE_API double RtLoadStaticFieldDo(void* classDataPtr, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2677,6 +2327,7 @@ extern "C" MACHINE_API double RtLoadStaticFieldDo(void* classDataPtr, int32_t fi
 
 extern "C" MACHINE_API uint32_t RtLoadStaticFieldCh(void* classDataPtr, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2701,6 +2352,7 @@ extern "C" MACHINE_API uint32_t RtLoadStaticFieldCh(void* classDataPtr, int32_t
 
 extern "C" MACHINE_API bool RtLoadStaticFieldBo(void* classDataPtr, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2725,6 +2377,7 @@ extern "C" MACHINE_API bool RtLoadStaticFieldBo(void* classDataPtr, int32_t fiel
 
 extern "C" MACHINE_API uint64_t RtLoadStaticFieldOb(void* classDataPtr, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2749,6 +2402,7 @@ extern "C" MACHINE_API uint64_t RtLoadStaticFieldOb(void* classDataPtr, int32_t
 
 extern "C" MACHINE_API void RtStoreStaticFieldSb(void* classDataPtr, int8_t fieldValue, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2771,6 +2425,7 @@ extern "C" MACHINE_API void RtStoreStaticFieldSb(void* classDataPtr, int8_t fiel
 
 extern "C" MACHINE_API void RtStoreStaticFieldBy(void* classDataPtr, uint8_t fieldValue, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2793,6 +2448,7 @@ extern "C" MACHINE_API void RtStoreStaticFieldBy(void* classDataPtr, uint8_t fie
 
 extern "C" MACHINE_API void RtStoreStaticFieldSh(void* classDataPtr, int16_t fieldValue, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2815,6 +2471,7 @@ extern "C" MACHINE_API void RtStoreStaticFieldSh(void* classDataPtr, int16_t fie
 
 extern "C" MACHINE_API void RtStoreStaticFieldUs(void* classDataPtr, uint16_t fieldValue, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2837,6 +2494,7 @@ extern "C" MACHINE_API void RtStoreStaticFieldUs(void* classDataPtr, uint16_t fi
 
 extern "C" MACHINE_API void RtStoreStaticFieldIn(void* classDataPtr, int32_t fieldValue, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2859,6 +2517,7 @@ extern "C" MACHINE_API void RtStoreStaticFieldIn(void* classDataPtr, int32_t fie
 
 extern "C" MACHINE_API void RtStoreStaticFieldUI(void* classDataPtr, uint32_t fieldValue, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2881,6 +2540,7 @@ extern "C" MACHINE_API void RtStoreStaticFieldUI(void* classDataPtr, uint32_t fi
 
 extern "C" MACHINE_API void RtStoreStaticFieldLo(void* classDataPtr, int64_t fieldValue, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2903,6 +2563,7 @@ extern "C" MACHINE_API void RtStoreStaticFieldLo(void* classDataPtr, int64_t fie
 
 extern "C" MACHINE_API void RtStoreStaticFieldUl(void* classDataPtr, uint64_t fieldValue, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2925,6 +2586,7 @@ extern "C" MACHINE_API void RtStoreStaticFieldUl(void* classDataPtr, uint64_t fi
 
 extern "C" MACHINE_API void RtStoreStaticFieldFl(void* classDataPtr, float fieldValue, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2947,6 +2609,7 @@ extern "C" MACHINE_API void RtStoreStaticFieldFl(void* classDataPtr, float field
 
 extern "C" MACHINE_API void RtStoreStaticFieldDo(void* classDataPtr, double fieldValue, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2969,6 +2632,7 @@ extern "C" MACHINE_API void RtStoreStaticFieldDo(void* classDataPtr, double fiel
 
 extern "C" MACHINE_API void RtStoreStaticFieldCh(void* classDataPtr, uint32_t fieldValue, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -2991,6 +2655,7 @@ extern "C" MACHINE_API void RtStoreStaticFieldCh(void* classDataPtr, uint32_t fi
 
 extern "C" MACHINE_API void RtStoreStaticFieldBo(void* classDataPtr, bool fieldValue, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -3013,6 +2678,7 @@ extern "C" MACHINE_API void RtStoreStaticFieldBo(void* classDataPtr, bool fieldV
 
 extern "C" MACHINE_API void RtStoreStaticFieldOb(void* classDataPtr, uint64_t fieldValue, int32_t fieldIndex)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ClassData* classData = static_cast<ClassData*>(classDataPtr);
@@ -3037,19 +2703,8 @@ extern "C" MACHINE_API uint64_t RtBoxSb(int8_t value)
 {
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
         Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
+        RT_RECORD_FRAME(thread);
         ObjectType* objectType = GetBoxedType(ValueType::sbyteType);
         ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
         std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
@@ -3075,19 +2730,8 @@ extern "C" MACHINE_API uint64_t RtBoxBy(uint8_t value)
 {
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
         Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
+        RT_RECORD_FRAME(thread);
         ObjectType* objectType = GetBoxedType(ValueType::byteType);
         ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
         std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
@@ -3113,19 +2757,8 @@ extern "C" MACHINE_API uint64_t RtBoxSh(int16_t value)
 {
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
         Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
+        RT_RECORD_FRAME(thread);
         ObjectType* objectType = GetBoxedType(ValueType::shortType);
         ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
         std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
@@ -3151,19 +2784,8 @@ extern "C" MACHINE_API uint64_t RtBoxUs(uint16_t value)
 {
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
         Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
+        RT_RECORD_FRAME(thread);
         ObjectType* objectType = GetBoxedType(ValueType::ushortType);
         ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
         std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
@@ -3189,19 +2811,8 @@ extern "C" MACHINE_API uint64_t RtBoxIn(int32_t value)
 {
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
         Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
+        RT_RECORD_FRAME(thread);
         ObjectType* objectType = GetBoxedType(ValueType::intType);
         ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
         std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
@@ -3227,19 +2838,8 @@ extern "C" MACHINE_API uint64_t RtBoxUi(uint32_t value)
 {
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
         Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
+        RT_RECORD_FRAME(thread);
         ObjectType* objectType = GetBoxedType(ValueType::uintType);
         ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
         std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
@@ -3265,19 +2865,8 @@ extern "C" MACHINE_API uint64_t RtBoxLo(int64_t value)
 {
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
         Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
+        RT_RECORD_FRAME(thread);
         ObjectType* objectType = GetBoxedType(ValueType::longType);
         ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
         std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
@@ -3303,19 +2892,8 @@ extern "C" MACHINE_API uint64_t RtBoxUl(uint64_t value)
 {
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
         Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
+        RT_RECORD_FRAME(thread);
         ObjectType* objectType = GetBoxedType(ValueType::ulongType);
         ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
         std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
@@ -3341,19 +2919,8 @@ extern "C" MACHINE_API uint64_t RtBoxFl(float value)
 {
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
         Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
+        RT_RECORD_FRAME(thread);
         ObjectType* objectType = GetBoxedType(ValueType::floatType);
         ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
         std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
@@ -3379,19 +2946,8 @@ extern "C" MACHINE_API uint64_t RtBoxDo(double value)
 {
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
         Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
+        RT_RECORD_FRAME(thread);
         ObjectType* objectType = GetBoxedType(ValueType::doubleType);
         ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
         std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
@@ -3417,19 +2973,8 @@ extern "C" MACHINE_API uint64_t RtBoxCh(uint32_t value)
 {
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
         Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
+        RT_RECORD_FRAME(thread);
         ObjectType* objectType = GetBoxedType(ValueType::charType);
         ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
         std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
@@ -3455,19 +3000,8 @@ extern "C" MACHINE_API uint64_t RtBoxBo(bool value)
 {
     try
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
         Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
+        RT_RECORD_FRAME(thread);
         ObjectType* objectType = GetBoxedType(ValueType::boolType);
         ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
         std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
@@ -3491,6 +3025,7 @@ extern "C" MACHINE_API uint64_t RtBoxBo(bool value)
 
 extern "C" MACHINE_API int8_t RtUnboxSb(uint64_t objectReference)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -3514,6 +3049,7 @@ extern "C" MACHINE_API int8_t RtUnboxSb(uint64_t objectReference)
 
 extern "C" MACHINE_API uint8_t RtUnboxBy(uint64_t objectReference)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -3537,6 +3073,7 @@ extern "C" MACHINE_API uint8_t RtUnboxBy(uint64_t objectReference)
 
 extern "C" MACHINE_API int16_t RtUnboxSh(uint64_t objectReference)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -3560,6 +3097,7 @@ extern "C" MACHINE_API int16_t RtUnboxSh(uint64_t objectReference)
 
 extern "C" MACHINE_API uint16_t RtUnboxUs(uint64_t objectReference)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -3583,6 +3121,7 @@ extern "C" MACHINE_API uint16_t RtUnboxUs(uint64_t objectReference)
 
 extern "C" MACHINE_API int32_t RtUnboxIn(uint64_t objectReference)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -3606,6 +3145,7 @@ extern "C" MACHINE_API int32_t RtUnboxIn(uint64_t objectReference)
 
 extern "C" MACHINE_API uint32_t RtUnboxUi(uint64_t objectReference)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -3629,6 +3169,7 @@ extern "C" MACHINE_API uint32_t RtUnboxUi(uint64_t objectReference)
 
 extern "C" MACHINE_API int64_t RtUnboxLo(uint64_t objectReference)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -3652,6 +3193,7 @@ extern "C" MACHINE_API int64_t RtUnboxLo(uint64_t objectReference)
 
 extern "C" MACHINE_API uint64_t RtUnboxUl(uint64_t objectReference)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -3675,6 +3217,7 @@ extern "C" MACHINE_API uint64_t RtUnboxUl(uint64_t objectReference)
 
 extern "C" MACHINE_API float RtUnboxFl(uint64_t objectReference)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -3698,6 +3241,7 @@ extern "C" MACHINE_API float RtUnboxFl(uint64_t objectReference)
 
 extern "C" MACHINE_API double RtUnboxDo(uint64_t objectReference)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -3721,6 +3265,7 @@ extern "C" MACHINE_API double RtUnboxDo(uint64_t objectReference)
 
 extern "C" MACHINE_API uint32_t RtUnboxCh(uint64_t objectReference)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -3744,6 +3289,7 @@ extern "C" MACHINE_API uint32_t RtUnboxCh(uint64_t objectReference)
 
 extern "C" MACHINE_API bool RtUnboxBo(uint64_t objectReference)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -3767,6 +3313,8 @@ extern "C" MACHINE_API bool RtUnboxBo(uint64_t objectReference)
 
 extern "C" MACHINE_API void RtAllocateArrayElements(uint64_t arr, int32_t length, void* elementTypePtr)
 {
+    Thread& thread = GetCurrentThread();
+    RT_RECORD_FRAME(thread);
     try
     {
         Type* elementType = static_cast<Type*>(elementTypePtr);
@@ -3775,7 +3323,7 @@ extern "C" MACHINE_API void RtAllocateArrayElements(uint64_t arr, int32_t length
             throw SystemException("element type is null");
         }
         ObjectReference arrayReference(arr);
-        GetManagedMemoryPool().AllocateArrayElements(GetCurrentThread(), arrayReference, elementType, length);
+        GetManagedMemoryPool().AllocateArrayElements(thread, arrayReference, elementType, length);
     }
     catch (const ArgumentOutOfRangeException& ex)
     {
@@ -3793,6 +3341,7 @@ extern "C" MACHINE_API void RtAllocateArrayElements(uint64_t arr, int32_t length
 
 extern "C" MACHINE_API bool RtIs(uint64_t objectReference, void* classDataPtr)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -3821,6 +3370,7 @@ extern "C" MACHINE_API bool RtIs(uint64_t objectReference, void* classDataPtr)
 
 extern "C" MACHINE_API uint64_t RtAs(uint64_t objectReference, void* classDataPtr)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference reference(objectReference);
@@ -3853,6 +3403,7 @@ extern "C" MACHINE_API uint64_t RtAs(uint64_t objectReference, void* classDataPt
 
 extern "C" MACHINE_API const char32_t* RtLoadStringLiteral(void* constantPool, uint32_t constantId)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     ConstantPool* pool = static_cast<ConstantPool*>(constantPool);
     ConstantId id(constantId);
     Constant constant = pool->GetConstant(id);
@@ -3861,6 +3412,7 @@ extern "C" MACHINE_API const char32_t* RtLoadStringLiteral(void* constantPool, u
 
 extern "C" MACHINE_API void RtMemFun2ClassDelegate(uint64_t classObjectRererence, uint64_t classDelegateObjectReference, void* memberFunction)
 {
+    RT_RECORD_FRAME(GetCurrentThread());
     try
     {
         ObjectReference classDelegateReference(classDelegateObjectReference);
@@ -3885,19 +3437,8 @@ extern "C" MACHINE_API void RtMemFun2ClassDelegate(uint64_t classObjectRererence
 
 extern "C" MACHINE_API void RtRequestGc()
 {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-    void* stackPtr = _AddressOfReturnAddress();
-    void* framePtr = getrbp();
-#else
-    // todo Linux
-#endif
-#endif
     Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-    thread.SetStackPtr(stackPtr);
-    thread.SetFramePtr(framePtr);
-#endif
+    RT_RECORD_FRAME(thread);
     thread.RequestGc(false);
     thread.WaitUntilGarbageCollected();
 }
@@ -3906,19 +3447,8 @@ extern "C" MACHINE_API void RtPollGc()
 {
     if (wantToCollectGarbage)
     {
-#ifdef STACK_WALK_GC
-#ifdef _WIN32
-        void* stackPtr = _AddressOfReturnAddress();
-        void* framePtr = getrbp();
-#else
-        // todo Linux
-#endif
-#endif
         Thread& thread = GetCurrentThread();
-#ifdef STACK_WALK_GC
-        thread.SetStackPtr(stackPtr);
-        thread.SetFramePtr(framePtr);
-#endif
+        RT_RECORD_FRAME(thread);
         thread.WaitUntilGarbageCollected();
     }
 }
@@ -120,6 +120,8 @@ extern "C" MACHINE_API void* RtResolveClassDelegateCallAddress(uint64_t classDlg
 
 extern "C" MACHINE_API void RtSetClassDataPtr(uint64_t objectReference, void* classDataPtr);
 
+extern "C" MACHINE_API void* RtGetAllocationContext();
+
 extern "C" MACHINE_API uint64_t RtCreateObject(void* classDataPtr);
 
 extern "C" MACHINE_API uint64_t RtCopyObject(uint64_t objectReference);
@@ -128,6 +130,52 @@ extern "C" MACHINE_API uint64_t RtStrLitToString(const char32_t* strLitValue);
 
 extern "C" MACHINE_API uint32_t RtLoadStringChar(int32_t index, uint64_t str);
 
+extern "C" MACHINE_API int32_t RtStringIndexOf(uint64_t str, uint32_t c, int32_t start);
+
+extern "C" MACHINE_API int32_t RtStringLastIndexOf(uint64_t str, uint32_t c, int32_t start);
+
+extern "C" MACHINE_API int32_t RtStringIndexOfAny(uint64_t str, uint64_t chars, int32_t start);
+
+extern "C" MACHINE_API int32_t RtStringLastIndexOfAny(uint64_t str, uint64_t chars, int32_t start);
+
+extern "C" MACHINE_API bool RtStringStartsWith(uint64_t str, uint64_t prefix);
+
+extern "C" MACHINE_API bool RtStringEndsWith(uint64_t str, uint64_t suffix);
+
+extern "C" MACHINE_API bool RtStringEqual(uint64_t left, uint64_t right);
+
+extern "C" MACHINE_API bool RtStringLess(uint64_t left, uint64_t right);
+
+extern "C" MACHINE_API uint64_t RtStringGetHashCode(uint64_t str);
+
+extern "C" MACHINE_API uint64_t RtStringSubstring(uint64_t str, int32_t start, int32_t length);
+
+extern "C" MACHINE_API uint64_t RtStringTrim(uint64_t str);
+
+extern "C" MACHINE_API uint64_t RtStringConcat(uint64_t left, uint64_t right);
+
+extern "C" MACHINE_API uint64_t RtStringFromUtf8(uint64_t bytes, int32_t offset, int32_t count);
+
+extern "C" MACHINE_API int32_t RtStringUtf8Length(uint64_t str);
+
+extern "C" MACHINE_API int32_t RtStringToUtf8(uint64_t str, uint64_t bytes, int32_t offset);
+
+extern "C" MACHINE_API void RtArrayCopy(uint64_t source, int32_t sourceIndex, uint64_t destination, int32_t destinationIndex, int32_t length);
+
+extern "C" MACHINE_API void RtArrayFill(uint64_t arr, uint64_t value, int32_t index, int32_t count);
+
+extern "C" MACHINE_API bool RtArrayEqual(uint64_t left, uint64_t right);
+
+extern "C" MACHINE_API int32_t RtArrayIndexOf(uint64_t arr, uint64_t value, int32_t start, int32_t count);
+
+extern "C" MACHINE_API void RtArrayReverse(uint64_t arr, int32_t index, int32_t count);
+
+extern "C" MACHINE_API bool RtArraySort(uint64_t arr, int32_t index, int32_t count, bool parallel);
+
+extern "C" MACHINE_API uint8_t RtLoadMappedByte(uint64_t address, int64_t index);
+
+extern "C" MACHINE_API int32_t RtLoadMappedInt(uint64_t address, int64_t index);
+
 extern "C" MACHINE_API uint64_t RtDownCast(uint64_t objectReference, void* classDataPtr);
 
 extern "C" MACHINE_API void* RtStaticInit(void* classDataPtr);
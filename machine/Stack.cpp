@@ -6,6 +6,7 @@
 #include <cminor/machine/Stack.hpp>
 #include <cminor/machine/Function.hpp>
 #include <cminor/machine/Thread.hpp>
+#include <cminor/machine/ExecutionProfile.hpp>
 #include <cminor/util/Util.hpp>
 #include <cminor/machine/OsInterface.hpp>
 #include <cstring>
@@ -67,9 +68,27 @@ Stack::Stack(Thread& thread_) :
     frames.reserve(GetMaxFrames());
 }
 
+Stack::Stack(Thread& thread_, uint64_t reserveSize, uint64_t growSize_, int initialFrames) :
+    thread(thread_), pageSize(GetSystemPageSize()), size(reserveSize), growSize(0), mem(nullptr), commit(nullptr), free(nullptr), end(nullptr)
+{
+    if (size > 0)
+    {
+        mem = ReserveMemory(size);
+        free = mem;
+        end = mem + size;
+        growSize = growSize_ * ((pageSize - 1) / growSize_ + 1);
+        uint8_t* commitBase = CommitMemory(mem, growSize);
+        commit = commitBase + growSize;
+    }
+    frames.reserve(initialFrames);
+}
+
 Stack::~Stack()
 {
-    FreeMemory(mem, size);
+    if (mem)
+    {
+        FreeMemory(mem, size);
+    }
 }
 
 void Stack::AllocateFrame(Function& fun)
@@ -98,6 +117,10 @@ void Stack::AllocateFrame(Function& fun)
         std::memset(frame->Locals(), 0, sizeOfLocals);
         frames.push_back(frame);
         thread.MapFrame(frame);
+        if (executionProfilingEnabled)
+        {
+            RecordFunctionEntry(fun);
+        }
     }
     else
     {
@@ -105,6 +128,19 @@ void Stack::AllocateFrame(Function& fun)
     }
 }
 
+void Stack::Exchange(Stack& that)
+{
+    Assert(&thread == &that.thread, "stacks of different threads cannot be exchanged");
+    std::swap(frames, that.frames);
+    std::swap(pageSize, that.pageSize);
+    std::swap(size, that.size);
+    std::swap(growSize, that.growSize);
+    std::swap(mem, that.mem);
+    std::swap(commit, that.commit);
+    std::swap(free, that.free);
+    std::swap(end, that.end);
+}
+
 void Stack::FreeFrame()
 {
     Assert(!frames.empty(), "no frames");
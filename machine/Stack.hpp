@@ -38,6 +38,7 @@ class Stack
 {
 public:
     Stack(Thread& thread_);
+    Stack(Thread& thread_, uint64_t reserveSize, uint64_t growSize_, int initialFrames);
     ~Stack();
     void AllocateFrame(Function& fun);
     void FreeFrame();
@@ -45,6 +46,7 @@ public:
     bool IsEmpty() const { return frames.empty(); }
     const std::vector<Frame*>& Frames() const { return frames; }
     std::vector<Frame*>& Frames() { return frames; }
+    void Exchange(Stack& that);
 private:
     Thread& thread;
     std::vector<Frame*> frames;
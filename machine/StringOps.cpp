@@ -0,0 +1,845 @@
+// =================================
+// Copyright (c) 2017 Seppo Laakko
+// Distributed under the MIT license
+// =================================
+
+#include <cminor/machine/StringOps.hpp>
+#include <cminor/machine/Machine.hpp>
+#include <cminor/machine/Error.hpp>
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#if defined(__x86_64__) || defined(_M_X64)
+    #define STRING_OPS_SSE2 1
+    #include <emmintrin.h>
+    #if defined(__GNUC__)
+        #define STRING_OPS_AVX2 1
+        #include <immintrin.h>
+    #endif
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace cminor { namespace machine {
+
+#ifdef STRING_OPS_SSE2
+
+inline int32_t LowestSetBit(uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return static_cast<int32_t>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+inline int32_t HighestSetBit(uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanReverse(&index, mask);
+    return static_cast<int32_t>(index);
+#else
+    return 31 - __builtin_clz(mask);
+#endif
+}
+
+inline uint32_t EqualMask(__m128i chunk, __m128i needle)
+{
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(chunk, needle))));
+}
+
+inline __m128i Load4(const char32_t* p)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+const int32_t maxSimdAnyChars = 16;
+
+#endif
+
+#ifdef STRING_OPS_AVX2
+
+bool HasAvx2()
+{
+    static bool hasAvx2 = __builtin_cpu_supports("avx2");
+    return hasAvx2;
+}
+
+__attribute__((target("avx2"))) int32_t IndexOfAvx2(const char32_t* s, int32_t n, char32_t c, int32_t& i)
+{
+    __m256i needle = _mm256_set1_epi32(static_cast<int>(c));
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(chunk, needle))));
+        if (mask != 0)
+        {
+            return i + LowestSetBit(mask);
+        }
+    }
+    return -1;
+}
+
+__attribute__((target("avx2"))) int32_t LastIndexOfAvx2(const char32_t* s, char32_t c, int32_t& i)
+{
+    __m256i needle = _mm256_set1_epi32(static_cast<int>(c));
+    for (; i >= 7; i -= 8)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i - 7));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(chunk, needle))));
+        if (mask != 0)
+        {
+            return i - 7 + HighestSetBit(mask);
+        }
+    }
+    return -1;
+}
+
+__attribute__((target("avx2"))) int32_t MismatchAvx2(const char32_t* left, const char32_t* right, int32_t n, int32_t& i)
+{
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + i));
+        __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + i));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(l, r))));
+        if (mask != 0xFF)
+        {
+            return i + LowestSetBit(~mask & 0xFF);
+        }
+    }
+    return -1;
+}
+
+#endif
+
+MACHINE_API int32_t StrIndexOf(const char32_t* s, int32_t n, char32_t c, int32_t start)
+{
+    int32_t i = start;
+#ifdef STRING_OPS_AVX2
+    if (HasAvx2())
+    {
+        int32_t index = IndexOfAvx2(s, n, c, i);
+        if (index != -1)
+        {
+            return index;
+        }
+    }
+#endif
+#ifdef STRING_OPS_SSE2
+    __m128i needle = _mm_set1_epi32(static_cast<int>(c));
+    for (; i + 4 <= n; i += 4)
+    {
+        uint32_t mask = EqualMask(Load4(s + i), needle);
+        if (mask != 0)
+        {
+            return i + LowestSetBit(mask);
+        }
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        if (s[i] == c)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+MACHINE_API int32_t StrLastIndexOf(const char32_t* s, int32_t n, char32_t c, int32_t start)
+{
+    int32_t i = start;
+#ifdef STRING_OPS_AVX2
+    if (HasAvx2())
+    {
+        int32_t index = LastIndexOfAvx2(s, c, i);
+        if (index != -1)
+        {
+            return index;
+        }
+    }
+#endif
+#ifdef STRING_OPS_SSE2
+    __m128i needle = _mm_set1_epi32(static_cast<int>(c));
+    for (; i >= 3; i -= 4)
+    {
+        uint32_t mask = EqualMask(Load4(s + i - 3), needle);
+        if (mask != 0)
+        {
+            return i - 3 + HighestSetBit(mask);
+        }
+    }
+#endif
+    for (; i >= 0; --i)
+    {
+        if (s[i] == c)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+inline bool IsAnyOf(char32_t c, const char32_t* chars, int32_t m)
+{
+    for (int32_t k = 0; k < m; ++k)
+    {
+        if (chars[k] == c)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+MACHINE_API int32_t StrIndexOfAny(const char32_t* s, int32_t n, const char32_t* chars, int32_t m, int32_t start)
+{
+    int32_t i = start;
+#ifdef STRING_OPS_SSE2
+    if (m > 0 && m <= maxSimdAnyChars)
+    {
+        __m128i needles[maxSimdAnyChars];
+        for (int32_t k = 0; k < m; ++k)
+        {
+            needles[k] = _mm_set1_epi32(static_cast<int>(chars[k]));
+        }
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128i chunk = Load4(s + i);
+            uint32_t mask = 0;
+            for (int32_t k = 0; k < m; ++k)
+            {
+                mask |= EqualMask(chunk, needles[k]);
+            }
+            if (mask != 0)
+            {
+                return i + LowestSetBit(mask);
+            }
+        }
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        if (IsAnyOf(s[i], chars, m))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+MACHINE_API int32_t StrLastIndexOfAny(const char32_t* s, int32_t n, const char32_t* chars, int32_t m, int32_t start)
+{
+    int32_t i = start;
+#ifdef STRING_OPS_SSE2
+    if (m > 0 && m <= maxSimdAnyChars)
+    {
+        __m128i needles[maxSimdAnyChars];
+        for (int32_t k = 0; k < m; ++k)
+        {
+            needles[k] = _mm_set1_epi32(static_cast<int>(chars[k]));
+        }
+        for (; i >= 3; i -= 4)
+        {
+            __m128i chunk = Load4(s + i - 3);
+            uint32_t mask = 0;
+            for (int32_t k = 0; k < m; ++k)
+            {
+                mask |= EqualMask(chunk, needles[k]);
+            }
+            if (mask != 0)
+            {
+                return i - 3 + HighestSetBit(mask);
+            }
+        }
+    }
+#endif
+    for (; i >= 0; --i)
+    {
+        if (IsAnyOf(s[i], chars, m))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+MACHINE_API int32_t StrMismatch(const char32_t* left, const char32_t* right, int32_t n)
+{
+    int32_t i = 0;
+#ifdef STRING_OPS_AVX2
+    if (HasAvx2())
+    {
+        int32_t index = MismatchAvx2(left, right, n, i);
+        if (index != -1)
+        {
+            return index;
+        }
+    }
+#endif
+#ifdef STRING_OPS_SSE2
+    for (; i + 4 <= n; i += 4)
+    {
+        uint32_t mask = EqualMask(Load4(left + i), Load4(right + i));
+        if (mask != 0xF)
+        {
+            return i + LowestSetBit(~mask & 0xF);
+        }
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        if (left[i] != right[i])
+        {
+            return i;
+        }
+    }
+    return n;
+}
+
+MACHINE_API bool StrEqual(const char32_t* left, int32_t leftLength, const char32_t* right, int32_t rightLength)
+{
+    if (leftLength != rightLength)
+    {
+        return false;
+    }
+    if (left == right)
+    {
+        return true;
+    }
+    return StrMismatch(left, right, leftLength) == leftLength;
+}
+
+MACHINE_API bool StrLess(const char32_t* left, int32_t leftLength, const char32_t* right, int32_t rightLength)
+{
+    int32_t n = std::min(leftLength, rightLength);
+    int32_t i = StrMismatch(left, right, n);
+    if (i < n)
+    {
+        return left[i] < right[i];
+    }
+    return leftLength < rightLength;
+}
+
+const uint64_t hashOffset = 14695981039346656037u;
+const uint64_t hashPrime = 1099511628211u;
+
+MACHINE_API uint64_t StrHash(const char32_t* s, int32_t n)
+{
+    uint64_t hashCode = hashOffset;
+    for (int32_t i = 0; i < n; ++i)
+    {
+        hashCode = hashCode ^ static_cast<uint64_t>(s[i]);
+        hashCode = hashCode * hashPrime;
+    }
+    return hashCode;
+}
+
+//  Overlong sequences, surrogate code points and values above U+10FFFF are rejected as invalid input. utf8MinCodePoint[n] is the smallest 
+//  code point that needs an n-byte sequence.
+
+const uint32_t utf8MinCodePoint[5] = { 0u, 0u, 0x80u, 0x800u, 0x10000u };
+
+MACHINE_API bool Utf8Decode(const uint8_t* begin, const uint8_t* end, std::u32string& result)
+{
+    size_t start = result.length();
+    result.resize(start + (end - begin));
+    char32_t* out = &result[0] + start;
+    const uint8_t* p = begin;
+    while (p != end)
+    {
+#ifdef STRING_OPS_SSE2
+        __m128i zero = _mm_setzero_si128();
+        while (end - p >= 16)
+        {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            if (_mm_movemask_epi8(chunk) != 0)
+            {
+                break;
+            }
+            __m128i lo = _mm_unpacklo_epi8(chunk, zero);
+            __m128i hi = _mm_unpackhi_epi8(chunk, zero);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm_unpackhi_epi16(hi, zero));
+            out += 16;
+            p += 16;
+        }
+        if (p == end)
+        {
+            break;
+        }
+#endif
+        uint8_t b0 = *p;
+        if ((b0 & 0x80u) == 0u)
+        {
+            *out++ = static_cast<char32_t>(b0);
+            ++p;
+            continue;
+        }
+        int n = 0;
+        uint32_t u = 0;
+        if ((b0 & 0xE0u) == 0xC0u)
+        {
+            n = 2;
+            u = b0 & 0x1Fu;
+        }
+        else if ((b0 & 0xF0u) == 0xE0u)
+        {
+            n = 3;
+            u = b0 & 0x0Fu;
+        }
+        else if ((b0 & 0xF8u) == 0xF0u)
+        {
+            n = 4;
+            u = b0 & 0x07u;
+        }
+        else
+        {
+            return false;
+        }
+        if (end - p < n)
+        {
+            return false;
+        }
+        for (int i = 1; i < n; ++i)
+        {
+            uint8_t b = p[i];
+            if ((b & 0xC0u) != 0x80u)
+            {
+                return false;
+            }
+            u = (u << 6) | (b & 0x3Fu);
+        }
+        if (u < utf8MinCodePoint[n] || u > 0x10FFFFu || (u >= 0xD800u && u <= 0xDFFFu))
+        {
+            return false;
+        }
+        *out++ = static_cast<char32_t>(u);
+        p += n;
+    }
+    result.resize(out - result.c_str());
+    return true;
+}
+
+MACHINE_API int64_t Utf8Length(const char32_t* s, int32_t n)
+{
+    int64_t length = 0;
+    for (int32_t i = 0; i < n; ++i)
+    {
+        uint32_t c = static_cast<uint32_t>(s[i]);
+        if (c < 0x80u)
+        {
+            length += 1;
+        }
+        else if (c < 0x800u)
+        {
+            length += 2;
+        }
+        else if (c < 0x10000u)
+        {
+            length += 3;
+        }
+        else if (c < 0x110000u)
+        {
+            length += 4;
+        }
+        else
+        {
+            return -1;
+        }
+    }
+    return length;
+}
+
+MACHINE_API uint8_t* Utf8Encode(const char32_t* s, int32_t n, uint8_t* out)
+{
+    int32_t i = 0;
+    while (i < n)
+    {
+#ifdef STRING_OPS_SSE2
+        __m128i nonAscii = _mm_set1_epi32(~0x7F);
+        __m128i zero = _mm_setzero_si128();
+        while (i + 8 <= n)
+        {
+            __m128i a = Load4(s + i);
+            __m128i b = Load4(s + i + 4);
+            __m128i high = _mm_and_si128(_mm_or_si128(a, b), nonAscii);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, zero)) != 0xFFFF)
+            {
+                break;
+            }
+            __m128i words = _mm_packs_epi32(a, b);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(words, words));
+            out += 8;
+            i += 8;
+        }
+        if (i == n)
+        {
+            break;
+        }
+#endif
+        uint32_t c = static_cast<uint32_t>(s[i]);
+        if (c < 0x80u)
+        {
+            *out++ = static_cast<uint8_t>(c);
+        }
+        else if (c < 0x800u)
+        {
+            *out++ = static_cast<uint8_t>(0xC0u | (c >> 6));
+            *out++ = static_cast<uint8_t>(0x80u | (c & 0x3Fu));
+        }
+        else if (c < 0x10000u)
+        {
+            *out++ = static_cast<uint8_t>(0xE0u | (c >> 12));
+            *out++ = static_cast<uint8_t>(0x80u | ((c >> 6) & 0x3Fu));
+            *out++ = static_cast<uint8_t>(0x80u | (c & 0x3Fu));
+        }
+        else
+        {
+            *out++ = static_cast<uint8_t>(0xF0u | (c >> 18));
+            *out++ = static_cast<uint8_t>(0x80u | ((c >> 12) & 0x3Fu));
+            *out++ = static_cast<uint8_t>(0x80u | ((c >> 6) & 0x3Fu));
+            *out++ = static_cast<uint8_t>(0x80u | (c & 0x3Fu));
+        }
+        ++i;
+    }
+    return out;
+}
+
+void GetStringChars(ManagedMemoryPool& memoryPool, ObjectReference str, std::unique_lock<std::recursive_mutex>& lock, const char32_t*& chars, int32_t& numChars)
+{
+    IntegralValue charsHandleValue = memoryPool.GetField(str, 2, lock);
+    Assert(charsHandleValue.GetType() == ValueType::allocationHandle, "allocation handle expected");
+    AllocationHandle handle(charsHandleValue.Value());
+    if (handle.Value() == 0)
+    {
+        chars = U"";
+        numChars = 0;
+        return;
+    }
+    void* stringChars = memoryPool.GetAllocation(handle, lock);
+    StringCharactersHeader* header = &GetAllocationHeader(stringChars)->stringCharactersHeader;
+    chars = header->Str();
+    numChars = header->NumChars();
+}
+
+void GetCharArrayElements(ManagedMemoryPool& memoryPool, ObjectReference charArray, std::unique_lock<std::recursive_mutex>& lock, const char32_t*& chars, int32_t& numChars)
+{
+    IntegralValue elementsHandleValue = memoryPool.GetField(charArray, 2, lock);
+    Assert(elementsHandleValue.GetType() == ValueType::allocationHandle, "allocation handle expected");
+    AllocationHandle handle(elementsHandleValue.Value());
+    void* arrayElements = memoryPool.GetAllocation(handle, lock);
+    ArrayElementsHeader* header = &GetAllocationHeader(arrayElements)->arrayElementsHeader;
+    Assert(header->GetElementType()->GetValueType() == ValueType::charType, "char array expected");
+    chars = static_cast<const char32_t*>(arrayElements);
+    numChars = header->NumElements();
+}
+
+void GetByteArrayElements(ManagedMemoryPool& memoryPool, ObjectReference byteArray, std::unique_lock<std::recursive_mutex>& lock, uint8_t*& bytes, int32_t& numBytes)
+{
+    if (byteArray.IsNull())
+    {
+        throw NullReferenceException("byte array is null");
+    }
+    IntegralValue elementsHandleValue = memoryPool.GetField(byteArray, 2, lock);
+    Assert(elementsHandleValue.GetType() == ValueType::allocationHandle, "allocation handle expected");
+    AllocationHandle handle(elementsHandleValue.Value());
+    void* arrayElements = memoryPool.GetAllocation(handle, lock);
+    ArrayElementsHeader* header = &GetAllocationHeader(arrayElements)->arrayElementsHeader;
+    Assert(header->GetElementType()->GetValueType() == ValueType::byteType, "byte array expected");
+    bytes = static_cast<uint8_t*>(arrayElements);
+    numBytes = header->NumElements();
+}
+
+MACHINE_API int32_t StringIndexOf(ObjectReference str, char32_t c, int32_t start)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    const char32_t* s = nullptr;
+    int32_t n = 0;
+    GetStringChars(memoryPool, str, lock, s, n);
+    if (start < 0)
+    {
+        throw IndexOutOfRangeException("string index out of range");
+    }
+    return StrIndexOf(s, n, c, start);
+}
+
+MACHINE_API int32_t StringLastIndexOf(ObjectReference str, char32_t c, int32_t start)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    const char32_t* s = nullptr;
+    int32_t n = 0;
+    GetStringChars(memoryPool, str, lock, s, n);
+    if (start >= n)
+    {
+        throw IndexOutOfRangeException("string index out of range");
+    }
+    return StrLastIndexOf(s, n, c, start);
+}
+
+MACHINE_API int32_t StringIndexOfAny(ObjectReference str, ObjectReference charArray, int32_t start)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    const char32_t* s = nullptr;
+    int32_t n = 0;
+    GetStringChars(memoryPool, str, lock, s, n);
+    const char32_t* chars = nullptr;
+    int32_t m = 0;
+    GetCharArrayElements(memoryPool, charArray, lock, chars, m);
+    if (start < 0)
+    {
+        throw IndexOutOfRangeException("string index out of range");
+    }
+    return StrIndexOfAny(s, n, chars, m, start);
+}
+
+MACHINE_API int32_t StringLastIndexOfAny(ObjectReference str, ObjectReference charArray, int32_t start)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    const char32_t* s = nullptr;
+    int32_t n = 0;
+    GetStringChars(memoryPool, str, lock, s, n);
+    const char32_t* chars = nullptr;
+    int32_t m = 0;
+    GetCharArrayElements(memoryPool, charArray, lock, chars, m);
+    if (start >= n)
+    {
+        throw IndexOutOfRangeException("string index out of range");
+    }
+    return StrLastIndexOfAny(s, n, chars, m, start);
+}
+
+MACHINE_API bool StringStartsWith(ObjectReference str, ObjectReference prefix)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    const char32_t* s = nullptr;
+    int32_t n = 0;
+    GetStringChars(memoryPool, str, lock, s, n);
+    const char32_t* p = nullptr;
+    int32_t m = 0;
+    GetStringChars(memoryPool, prefix, lock, p, m);
+    if (n < m)
+    {
+        return false;
+    }
+    return StrMismatch(s, p, m) == m;
+}
+
+MACHINE_API bool StringEndsWith(ObjectReference str, ObjectReference suffix)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    const char32_t* s = nullptr;
+    int32_t n = 0;
+    GetStringChars(memoryPool, str, lock, s, n);
+    const char32_t* p = nullptr;
+    int32_t m = 0;
+    GetStringChars(memoryPool, suffix, lock, p, m);
+    if (n < m)
+    {
+        return false;
+    }
+    return StrMismatch(s + n - m, p, m) == m;
+}
+
+MACHINE_API bool StringEqual(ObjectReference left, ObjectReference right)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    const char32_t* l = U"";
+    int32_t leftLength = 0;
+    if (!left.IsNull())
+    {
+        GetStringChars(memoryPool, left, lock, l, leftLength);
+    }
+    const char32_t* r = U"";
+    int32_t rightLength = 0;
+    if (!right.IsNull())
+    {
+        GetStringChars(memoryPool, right, lock, r, rightLength);
+    }
+    return StrEqual(l, leftLength, r, rightLength);
+}
+
+MACHINE_API bool StringLess(ObjectReference left, ObjectReference right)
+{
+    if (left.IsNull() && right.IsNull()) return false;
+    if (left.IsNull()) return true;
+    if (right.IsNull()) return false;
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    const char32_t* l = nullptr;
+    int32_t leftLength = 0;
+    GetStringChars(memoryPool, left, lock, l, leftLength);
+    const char32_t* r = nullptr;
+    int32_t rightLength = 0;
+    GetStringChars(memoryPool, right, lock, r, rightLength);
+    return StrLess(l, leftLength, r, rightLength);
+}
+
+MACHINE_API uint64_t StringHashCode(ObjectReference str)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    void* object = memoryPool.GetObject(str, lock);
+    ManagedAllocationHeader* header = GetAllocationHeader(object);
+    ObjectHeader* objectHeader = &header->objectHeader;
+    if (header->IsHashCodeCached())
+    {
+        return objectHeader->HashCode();
+    }
+    const char32_t* s = nullptr;
+    int32_t n = 0;
+    GetStringChars(memoryPool, str, lock, s, n);
+    uint64_t hashCode = StrHash(s, n);
+    objectHeader->SetHashCode(hashCode);
+    header->SetHashCodeCached();
+    return hashCode;
+}
+
+MACHINE_API ObjectReference StringSubstring(Thread& thread, ObjectReference str, int32_t start, int32_t length)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    const char32_t* s = nullptr;
+    int32_t n = 0;
+    GetStringChars(memoryPool, str, lock, s, n);
+    if (start < 0 || start > n)
+    {
+        throw IndexOutOfRangeException("string index out of range");
+    }
+    if (length <= 0)
+    {
+        return memoryPool.CreateString(thread, std::u32string(), lock);
+    }
+    if (length > n - start)
+    {
+        throw IndexOutOfRangeException("string index out of range");
+    }
+    std::u32string substring(s + start, length);
+    return memoryPool.CreateString(thread, substring, lock);
+}
+
+inline bool IsCSpace(char32_t c)
+{
+    return c < 256 && std::isspace(static_cast<unsigned char>(c));
+}
+
+MACHINE_API ObjectReference StringTrim(Thread& thread, ObjectReference str)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    const char32_t* s = nullptr;
+    int32_t n = 0;
+    GetStringChars(memoryPool, str, lock, s, n);
+    int32_t b = 0;
+    while (b < n && IsCSpace(s[b]))
+    {
+        ++b;
+    }
+    int32_t e = n - 1;
+    while (e >= b && IsCSpace(s[e]))
+    {
+        --e;
+    }
+    std::u32string trimmed(s + b, e - b + 1);
+    return memoryPool.CreateString(thread, trimmed, lock);
+}
+
+MACHINE_API ObjectReference StringConcat(Thread& thread, ObjectReference left, ObjectReference right)
+{
+    if (left.IsNull() || right.IsNull())
+    {
+        throw NullReferenceException("cannot concatenate a null string");
+    }
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    const char32_t* l = nullptr;
+    int32_t ln = 0;
+    GetStringChars(memoryPool, left, lock, l, ln);
+    const char32_t* r = nullptr;
+    int32_t rn = 0;
+    GetStringChars(memoryPool, right, lock, r, rn);
+    std::u32string s;
+    s.reserve(ln + rn);
+    s.append(l, ln).append(r, rn);
+    return memoryPool.CreateString(thread, s, lock);
+}
+
+MACHINE_API ObjectReference StringFromUtf8(Thread& thread, ObjectReference byteArray, int32_t offset, int32_t count)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    uint8_t* bytes = nullptr;
+    int32_t n = 0;
+    GetByteArrayElements(memoryPool, byteArray, lock, bytes, n);
+    if (offset < 0 || count < 0 || offset > n || count > n - offset)
+    {
+        throw IndexOutOfRangeException("byte array index out of range");
+    }
+    std::u32string s;
+    if (!Utf8Decode(bytes + offset, bytes + offset + count, s))
+    {
+        return ObjectReference(0);
+    }
+    return memoryPool.CreateString(thread, s, lock);
+}
+
+MACHINE_API int32_t StringUtf8Length(ObjectReference str)
+{
+    if (str.IsNull())
+    {
+        throw NullReferenceException("cannot encode a null string");
+    }
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    const char32_t* s = nullptr;
+    int32_t n = 0;
+    GetStringChars(memoryPool, str, lock, s, n);
+    int64_t length = Utf8Length(s, n);
+    if (length > std::numeric_limits<int32_t>::max())
+    {
+        return -1;
+    }
+    return static_cast<int32_t>(length);
+}
+
+MACHINE_API int32_t StringToUtf8(ObjectReference str, ObjectReference byteArray, int32_t offset)
+{
+    if (str.IsNull())
+    {
+        throw NullReferenceException("cannot encode a null string");
+    }
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    const char32_t* s = nullptr;
+    int32_t n = 0;
+    GetStringChars(memoryPool, str, lock, s, n);
+    uint8_t* bytes = nullptr;
+    int32_t m = 0;
+    GetByteArrayElements(memoryPool, byteArray, lock, bytes, m);
+    int64_t length = Utf8Length(s, n);
+    if (length == -1)
+    {
+        throw SystemException("could not encode: invalid Unicode code point");
+    }
+    if (offset < 0 || offset > m || length > m - offset)
+    {
+        throw IndexOutOfRangeException("byte array index out of range");
+    }
+    Utf8Encode(s, n, bytes + offset);
+    return static_cast<int32_t>(length);
+}
+
+} } // namespace cminor::machine
@@ -0,0 +1,54 @@
+// =================================
+// Copyright (c) 2017 Seppo Laakko
+// Distributed under the MIT license
+// =================================
+
+#ifndef CMINOR_MACHINE_STRING_OPS_INCLUDED
+#define CMINOR_MACHINE_STRING_OPS_INCLUDED
+#include <cminor/machine/Object.hpp>
+
+namespace cminor { namespace machine {
+
+//  Character buffer kernels. They operate directly on UTF-32 character data and use SSE2/AVX2 where available.
+
+MACHINE_API int32_t StrIndexOf(const char32_t* s, int32_t n, char32_t c, int32_t start);
+MACHINE_API int32_t StrLastIndexOf(const char32_t* s, int32_t n, char32_t c, int32_t start);
+MACHINE_API int32_t StrIndexOfAny(const char32_t* s, int32_t n, const char32_t* chars, int32_t m, int32_t start);
+MACHINE_API int32_t StrLastIndexOfAny(const char32_t* s, int32_t n, const char32_t* chars, int32_t m, int32_t start);
+MACHINE_API int32_t StrMismatch(const char32_t* left, const char32_t* right, int32_t n);
+MACHINE_API bool StrEqual(const char32_t* left, int32_t leftLength, const char32_t* right, int32_t rightLength);
+MACHINE_API bool StrLess(const char32_t* left, int32_t leftLength, const char32_t* right, int32_t rightLength);
+MACHINE_API uint64_t StrHash(const char32_t* s, int32_t n);
+
+//  UTF-8 kernels. Runs of ASCII characters are converted sixteen bytes (decoding) or eight characters (encoding) at a time with SSE2.
+//  Utf8Decode appends to result and returns false if the bytes are not a complete valid UTF-8 sequence. Utf8Length returns -1 for an invalid code point.
+
+MACHINE_API bool Utf8Decode(const uint8_t* begin, const uint8_t* end, std::u32string& result);
+MACHINE_API int64_t Utf8Length(const char32_t* s, int32_t n);
+MACHINE_API uint8_t* Utf8Encode(const char32_t* s, int32_t n, uint8_t* out);
+
+//  Managed string operations used by both the System.String VM functions and the corresponding Rt entry points of native code.
+
+MACHINE_API int32_t StringIndexOf(ObjectReference str, char32_t c, int32_t start);
+MACHINE_API int32_t StringLastIndexOf(ObjectReference str, char32_t c, int32_t start);
+MACHINE_API int32_t StringIndexOfAny(ObjectReference str, ObjectReference charArray, int32_t start);
+MACHINE_API int32_t StringLastIndexOfAny(ObjectReference str, ObjectReference charArray, int32_t start);
+MACHINE_API bool StringStartsWith(ObjectReference str, ObjectReference prefix);
+MACHINE_API bool StringEndsWith(ObjectReference str, ObjectReference suffix);
+MACHINE_API bool StringEqual(ObjectReference left, ObjectReference right);
+MACHINE_API bool StringLess(ObjectReference left, ObjectReference right);
+//  Computes the hash code of a string once and caches it in the object header of the string.
+MACHINE_API uint64_t StringHashCode(ObjectReference str);
+MACHINE_API ObjectReference StringSubstring(Thread& thread, ObjectReference str, int32_t start, int32_t length);
+MACHINE_API ObjectReference StringTrim(Thread& thread, ObjectReference str);
+MACHINE_API ObjectReference StringConcat(Thread& thread, ObjectReference left, ObjectReference right);
+//  Decodes count bytes of a byte array starting at offset. Returns a null reference if the bytes are not valid UTF-8.
+MACHINE_API ObjectReference StringFromUtf8(Thread& thread, ObjectReference byteArray, int32_t offset, int32_t count);
+//  Returns the length of the UTF-8 encoding of a string, or -1 if the string contains an invalid code point.
+MACHINE_API int32_t StringUtf8Length(ObjectReference str);
+//  Encodes a string to a byte array starting at offset and returns the number of bytes written.
+MACHINE_API int32_t StringToUtf8(ObjectReference str, ObjectReference byteArray, int32_t offset);
+
+} } // namespace cminor::machine
+
+#endif // CMINOR_MACHINE_STRING_OPS_INCLUDED
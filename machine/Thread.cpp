@@ -7,6 +7,7 @@
 #include <cminor/machine/Machine.hpp>
 #include <cminor/machine/Function.hpp>
 #include <cminor/machine/OsInterface.hpp>
+#include <cminor/machine/PerfMap.hpp>
 #include <cminor/machine/Runtime.hpp>
 #include <cminor/machine/Log.hpp>
 #include <cminor/util/Unicode.hpp>
@@ -53,6 +54,28 @@ void DebugContext::RemoveBreakpointAt(int32_t pc)
     breakpoints.erase(pc);
 }
 
+NativeFrameWalker::NativeFrameWalker(const Thread& thread) : threadMain(thread.ThreadMain()), fun(nullptr), framePtr(static_cast<uint8_t*>(thread.FramePtr()))
+{
+    void* stackPtr = thread.StackPtr();
+    if (stackPtr)
+    {
+        void* instructionPtr = *static_cast<void**>(stackPtr);
+        fun = FunctionTable::GetNativeFunction(instructionPtr);
+    }
+}
+
+void NativeFrameWalker::Next()
+{
+    if (fun == threadMain)
+    {
+        fun = nullptr;
+        return;
+    }
+    void* instructionPtr = *reinterpret_cast<void**>(framePtr + sizeof(void*));
+    framePtr = *reinterpret_cast<uint8_t**>(framePtr);
+    fun = FunctionTable::GetNativeFunction(instructionPtr);
+}
+
 ThreadExitSetter::ThreadExitSetter(Thread& thread_) : thread(thread_) 
 {
 }
@@ -63,10 +86,27 @@ ThreadExitSetter::~ThreadExitSetter()
     thread.SetState(ThreadState::exited);
 }
 
+WaitingSetter::WaitingSetter(Thread& thread_) : thread(thread_)
+{
+    prevState = thread.GetState();
+    if (RunningNativeCode())
+    {
+#ifdef SHADOW_STACK_GC
+        thread.SetFunctionStack(RtGetFunctionStack());
+#endif
+    }
+    thread.SetState(ThreadState::waiting);
+}
+
+WaitingSetter::~WaitingSetter()
+{
+    thread.SetState(prevState);
+}
+
 Thread::Thread(int32_t id_, Machine& machine_, Function& fun_) :
     stack(*this), id(id_), machine(machine_), fun(fun_), handlingException(false), currentExceptionBlock(nullptr), state(ThreadState::paused), 
     exceptionObjectType(nullptr), nextVariableReferenceId(1), threadHandle(0), functionStack(nullptr), nativeId(-1), owner('0' + id), mtx('0' + id), 
-    allocationContext(nullptr), stackPtr(nullptr), framePtr(nullptr)
+    allocationContext(nullptr), stackPtr(nullptr), framePtr(nullptr), fiberSwitchRequested(false), managedStackSample(0), attentionMark(0), daemon(false)
 {
     if (GetNumAllocationContextPages() > 0)
     {
@@ -226,20 +266,61 @@ void Thread::RunToEnd()
         {
             Assert(!stack.IsEmpty(), "stack is empty");
             stack.FreeFrame();
-            if (!stack.IsEmpty())
-            {
-                frame = stack.CurrentFrame();
-                inst = frame->GetNextInst();
-            }
-            else
+            if (stack.IsEmpty())
             {
-                return;
+                if (!fiberScheduler || !fiberScheduler->Switch(true))
+                {
+                    return;
+                }
             }
+            frame = stack.CurrentFrame();
+            inst = frame->GetNextInst();
         }
         inst->Execute(*frame);
+        if (managedStackSampleCount.load(std::memory_order_relaxed) != attentionMark)
+        {
+            Attend();
+        }
     }
 }
 
+//  The interpreter loop compares the sample count of the sampler thread to the attention mark of the thread after each instruction. The mark is the
+//  count of the last sample taken, and a fiber switch request sets it to a value the count never reaches, so one comparison covers both requests.
+
+void Thread::Attend()
+{
+    if (managedStackSampleCount.load(std::memory_order_relaxed) != managedStackSample)
+    {
+        WriteManagedStackSample(*this);
+    }
+    attentionMark = managedStackSample;
+    if (fiberSwitchRequested)
+    {
+        fiberSwitchRequested = false;
+        fiberScheduler->Switch(false);
+    }
+}
+
+FiberScheduler& Thread::GetFiberScheduler()
+{
+    if (!fiberScheduler)
+    {
+        fiberScheduler.reset(new FiberScheduler(*this));
+    }
+    return *fiberScheduler;
+}
+
+void Thread::ExchangeContext(Fiber& fiber)
+{
+    stack.Exchange(fiber.stack);
+    opStack.Exchange(fiber.opStack);
+    std::swap(handlingException, fiber.handlingException);
+    std::swap(handlingExceptionStack, fiber.handlingExceptionStack);
+    std::swap(exception, fiber.exception);
+    std::swap(currentExceptionBlock, fiber.currentExceptionBlock);
+    std::swap(exceptionObjectType, fiber.exceptionObjectType);
+}
+
 void Thread::RunMain(bool runWithArgs, const std::vector<std::u32string>& programArguments, ObjectType* argsArrayObjectType)
 {
     Frame* frame = stack.CurrentFrame();
@@ -7,6 +7,7 @@
 #define CMINOR_MACHINE_THREAD_INCLUDED
 #include <cminor/machine/MachineApi.hpp>
 #include <cminor/machine/Stack.hpp>
+#include <cminor/machine/Fiber.hpp>
 #include <cminor/machine/Object.hpp>
 #include <cminor/machine/OperandStack.hpp>
 #include <cminor/machine/VariableReference.hpp>
@@ -49,6 +50,17 @@ struct MACHINE_API ThreadExitSetter
     Thread& thread;
 };
 
+//  WaitingSetter puts the thread to the waiting state for its lifetime, so that the garbage collector does not wait for the thread to reach a safepoint. 
+//  The thread must not touch the managed heap while it is waiting.
+
+struct MACHINE_API WaitingSetter
+{
+    WaitingSetter(Thread& thread_);
+    ~WaitingSetter();
+    Thread& thread;
+    ThreadState prevState;
+};
+
 class DebugContext
 {
 public:
@@ -126,6 +138,13 @@ public:
     void* FramePtr() const { return framePtr; }
     void SetFramePtr(void* framePtr_) { framePtr = framePtr_; }
     const Function* ThreadMain() const { return &fun; }
+    FiberScheduler& GetFiberScheduler();
+    const FiberScheduler* GetFiberSchedulerIfStarted() const { return fiberScheduler.get(); }
+    void RequestFiberSwitch() { fiberSwitchRequested = true; attentionMark = fiberSwitchAttentionMark; }
+    void SetManagedStackSample(uint64_t managedStackSample_) { managedStackSample = managedStackSample_; }
+    void ExchangeContext(Fiber& fiber);
+    bool IsDaemon() const { return daemon; }
+    void SetDaemon() { daemon = true; }
 private:
     Stack stack;
     int32_t id;
@@ -156,11 +175,35 @@ private:
     std::stack<AllocationHandle> allocationHandleStack;
     void* stackPtr;
     void* framePtr;
+    std::unique_ptr<FiberScheduler> fiberScheduler;
+    bool fiberSwitchRequested;
+    uint64_t managedStackSample;
+    uint64_t attentionMark;
+    static const uint64_t fiberSwitchAttentionMark = ~uint64_t(0);
+    bool daemon;
     void RunToEnd();
+    void Attend();
     void FindExceptionBlock(Frame* frame);
     bool DispatchToHandlerOrFinally(Frame* frame);
 };
 
+//  Walks the frames of the natively compiled functions of a thread, starting from the function that made the latest runtime call and ending 
+//  at the main function of the thread. The runtime entry points record the address of their return address and the frame pointer of their caller. 
+//  Native functions keep the frame pointer, so the caller's frame pointer is found at the frame pointer and the return address just above it.
+
+class MACHINE_API NativeFrameWalker
+{
+public:
+    NativeFrameWalker(const Thread& thread);
+    Function* CurrentFunction() const { return fun; }
+    uint8_t* FramePtr() const { return framePtr; }
+    void Next();
+private:
+    const Function* threadMain;
+    Function* fun;
+    uint8_t* framePtr;
+};
+
 } } // namespace cminor::machine
 
 #endif // CMINOR_MACHINE_THREAD_INCLUDED
@@ -13,6 +13,7 @@
 #include <cminor/machine/Machine.hpp>
 #include <cminor/machine/Runtime.hpp>
 #include <cminor/machine/OsInterface.hpp>
+#include <cminor/machine/PerfMap.hpp>
 #include <cminor/machine/Stats.hpp>
 #include <boost/filesystem.hpp>
 #include <cminor/util/Path.hpp>
@@ -314,6 +315,7 @@ void Assembly::Load(const std::string& assemblyFilePath)
     symbolTable.MergeClassTemplateSpecializations();
     auto startLink = std::chrono::system_clock::now();
     Link(callInstructions, fun2DlgInstructions, memFun2ClassDlgInstructions, typeInstructions, setClassDataInstructions, classTypes);
+    linkedClassTypes = classTypes;
     auto endLink = std::chrono::system_clock::now();
     auto endLoad = std::chrono::system_clock::now();
     auto loadDuration = endLoad - startLoad;
@@ -1580,6 +1582,18 @@ void SetExportedSharedLibraryVariables(Assembly* assembly)
     {
         throw std::runtime_error("resolving address of '__constant_pool_" + assembly->Hash() + "' variable of assembly '" + ToUtf8(assembly->Name().Value()) + "' (" + assembly->FilePathReadFrom() + ") failed: " + ex.what());
     }
+    std::string allocationTableVarName = "__allocation_table_" + assembly->Hash();
+    try
+    {
+        void* symbolAddress = ResolveSymbolAddress(sharedLibraryHandle, assembly->NativeSharedLibraryFilePath(), allocationTableVarName);
+        void* allocationTableAddress = static_cast<void*>(GetManagedMemoryPool().AllocationTableAddress());
+        void** allocationTableVariablePtr = reinterpret_cast<void**>(symbolAddress);
+        *allocationTableVariablePtr = allocationTableAddress;
+    }
+    catch (const std::runtime_error& ex)
+    {
+        throw std::runtime_error("resolving address of '__allocation_table_" + assembly->Hash() + "' variable of assembly '" + ToUtf8(assembly->Name().Value()) + "' (" + assembly->FilePathReadFrom() + ") failed: " + ex.what());
+    }
 }
 
 void ResolveMainEntryPointAddress(Assembly* assembly)
@@ -1600,6 +1614,10 @@ void Assembly::PrepareForNativeExecution()
     LoadSharedLibrariesIntoMemory(this);
     ResolveAddressesOfExportedFunctions(this);
     FunctionTable::SortNativeFunctionsByAddress();
+    if (PerfMapEnabled())
+    {
+        WritePerfMap();
+    }
     ResolveFunctionPtrVarMappings(this);
     ResolveClassDataPtrVarMappings(this);
     ResolveTypePtrVarMappings(this);
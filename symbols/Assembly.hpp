@@ -139,7 +139,9 @@ inline TransientAssemblyFlags operator&(TransientAssemblyFlags left, TransientAs
 
 const uint8_t assemblyFormat_1 = uint8_t('1');
 const uint8_t assemblyFormat_2 = uint8_t('2');
-const uint8_t currentAssemblyFormat = assemblyFormat_2;
+const uint8_t assemblyFormat_3 = uint8_t('3');
+const uint8_t assemblyFormat_4 = uint8_t('4');
+const uint8_t currentAssemblyFormat = assemblyFormat_4;
 
 class Assembly
 {
@@ -238,6 +240,7 @@ public:
     void* SharedLibraryHandle() const { return sharedLibraryHandle; }
     void SetMainEntryPointAddress(void* mainEntryPointAddress_) { mainEntryPointAddress = mainEntryPointAddress_; }
     void* MainEntryPointAddress() const { return mainEntryPointAddress; }
+    const std::vector<ClassTypeSymbol*>& LinkedClassTypes() const { return linkedClassTypes; }
     //void SetStackMapSection(StackMapSection* stackMapSection_) { stackMapSection.reset(stackMapSection_); }
 private:
     Machine& machine;
@@ -265,6 +268,7 @@ private:
     TransientAssemblyFlags transientFlags;
     void* sharedLibraryHandle;
     void* mainEntryPointAddress;
+    std::vector<ClassTypeSymbol*> linkedClassTypes;
     //std::unique_ptr<StackMapSection> stackMapSection;
     void Import(const std::vector<std::string>& assemblyReferences, LoadType loadType, const Assembly* rootAssembly, std::unordered_set<std::string>& importSet, const std::string& currentAssemblyDir,
         std::vector<CallInst*>& callInstructions, std::vector<Fun2DlgInst*>& fun2DlgInstructions,
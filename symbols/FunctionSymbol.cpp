@@ -1105,8 +1105,11 @@ void MemberFunctionSymbol::GenerateVirtualCall(Machine& machine, Assembly& assem
     std::u32string callName = FullName();
     ConstantPool& constantPool = assembly.GetConstantPool();
     Constant callNameConstant = constantPool.GetConstant(constantPool.Install(StringPtr(callName.c_str())));
+    std::u32string className = Parent()->FullName();
+    Constant classNameConstant = constantPool.GetConstant(constantPool.Install(StringPtr(className.c_str())));
     vcall->SetNumArgs(n);
     vcall->SetVmtIndex(vmtIndex);
+    vcall->SetClassName(classNameConstant);
     FunctionType functionType;
     if (ReturnType())
     {
@@ -1137,8 +1140,12 @@ void MemberFunctionSymbol::GenerateInterfaceCall(Machine& machine, Assembly& ass
     std::unique_ptr<Instruction> inst = machine.CreateInst("calli");
     InterfaceCallInst* icall = dynamic_cast<InterfaceCallInst*>(inst.get());
     Assert(icall, "interface call instruction expected");
+    std::u32string interfaceName = Parent()->FullName();
+    ConstantPool& constantPool = assembly.GetConstantPool();
+    Constant interfaceNameConstant = constantPool.GetConstant(constantPool.Install(StringPtr(interfaceName.c_str())));
     icall->SetNumArgs(n);
     icall->SetImtIndex(imtIndex);
+    icall->SetInterfaceName(interfaceNameConstant);
     FunctionType functionType;
     if (ReturnType())
     {
@@ -1253,10 +1260,12 @@ void ClassToInterfaceConversion::GenerateCall(Machine& machine, Assembly& assemb
     std::unique_ptr<Instruction> swap;
     swap = machine.CreateInst("swap");
     function.AddInst(std::move(swap));
+    ObjectType* interfaceObjectType = static_cast<ObjectType*>(targetType->GetMachineType());
     std::unique_ptr<Instruction> storeField;
     storeField = machine.CreateInst("storefield.1");
     StoreField1Inst* storeField1Inst = static_cast<StoreField1Inst*>(storeField.get());
     storeField1Inst->SetFieldType(ValueType::intType);
+    storeField1Inst->SetFieldOffset(static_cast<int32_t>(interfaceObjectType->GetField(1).Offset().Value()));
     function.AddInst(std::move(storeField));
     std::unique_ptr<Instruction> dupInst2;
     dupInst2 = machine.CreateInst("dup");
@@ -1271,6 +1280,7 @@ void ClassToInterfaceConversion::GenerateCall(Machine& machine, Assembly& assemb
     storeField2 = machine.CreateInst("storefield.0");
     StoreField0Inst* storeField0Inst = static_cast<StoreField0Inst*>(storeField2.get());
     storeField0Inst->SetFieldType(ValueType::objectReference);
+    storeField0Inst->SetFieldOffset(static_cast<int32_t>(interfaceObjectType->GetField(0).Offset().Value()));
     function.AddInst(std::move(storeField2));
 }
 
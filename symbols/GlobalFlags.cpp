@@ -12,6 +12,7 @@ int optimizationLevel = -1;
 int inlineLimit = -1;
 int inlineLocals = -1;
 std::string debugPassValue;
+std::string profileFilePath;
 
 inline GlobalFlags operator|(GlobalFlags flags, GlobalFlags flag)
 {
@@ -126,4 +127,14 @@ void SetDebugPassValue(const std::string& value)
     debugPassValue = value;
 }
 
+const std::string& GetProfileFilePath()
+{
+    return profileFilePath;
+}
+
+void SetProfileFilePath(const std::string& filePath)
+{
+    profileFilePath = filePath;
+}
+
 } } // namespace cminor::symbols
@@ -24,7 +24,8 @@ enum class GlobalFlags : uint16_t
     emitOptLlvm = 1 << 8,
     linkWithDebugMachine = 1 << 9,
     useMsLink = 1 << 10,
-    readClassNodes = 1 << 11
+    readClassNodes = 1 << 11,
+    wholeProgram = 1 << 12
 };
 
 void SetGlobalFlag(GlobalFlags flag);
@@ -45,6 +46,9 @@ void SetInlineLocals(int numLocals);
 const std::string& GetDebugPassValue();
 void SetDebugPassValue(const std::string& value);
 
+const std::string& GetProfileFilePath();
+void SetProfileFilePath(const std::string& filePath);
+
 } } // namespace cminor::symbols
 
 #endif // CMINOR_SYMBOLS_GLOBAL_FLAGS_INCLUDED
@@ -20,7 +20,9 @@
     #endif
 #endif 
 
-#define SHADOW_STACK_GC 1
+//  Natively compiled code keeps its GC roots in stack slots that the garbage collector finds by walking the frame pointer chain. 
+//  Define SHADOW_STACK_GC instead to link the frames of native functions to a shadow stack, or both to cross-check the two.
+
 #define STACK_WALK_GC 1
 
 #endif // CMINOR_UTIL_DEFINES_INCLUDED
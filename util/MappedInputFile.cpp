@@ -51,6 +51,16 @@ const char* MappedInputFile::End() const
     return impl->Data() + impl->Size();
 }
 
+const char* MappedInputFile::Data() const
+{
+    return impl->Data();
+}
+
+uint64_t MappedInputFile::Size() const
+{
+    return impl->Size();
+}
+
 std::string ReadFile(const std::string& fileName)
 {
     MappedInputFile mappedFile(fileName);
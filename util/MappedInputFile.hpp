@@ -19,6 +19,8 @@ public:
     ~MappedInputFile();
     const char* Begin() const;
     const char* End() const;
+    const char* Data() const;
+    uint64_t Size() const;
 private:
     MappedInputFileImpl* impl;
 };
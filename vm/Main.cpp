@@ -11,6 +11,9 @@
 #include <cminor/machine/Runtime.hpp>
 #include <cminor/machine/CminorException.hpp>
 #include <cminor/machine/Stats.hpp>
+#include <cminor/machine/LockProfiler.hpp>
+#include <cminor/machine/ExecutionProfile.hpp>
+#include <cminor/machine/PerfMap.hpp>
 #include <cminor/symbols/Symbol.hpp>
 #include <cminor/symbols/Value.hpp>
 #include <cminor/symbols/Assembly.hpp>
@@ -21,6 +24,7 @@
 #include <cminor/vmlib/VmFunction.hpp>
 #include <cminor/vmlib/File.hpp>
 #include <cminor/vmlib/Socket.hpp>
+#include <cminor/vmlib/MemoryMappedFile.hpp>
 #include <cminor/vmlib/Threading.hpp>
 #include <cminor/util/Path.hpp>
 #include <cminor/util/TextUtils.hpp>
@@ -57,6 +61,7 @@ struct InitDone
         InitVmFunctions(vmFunctionNamePool);
         FileInit();
         SocketInit();
+        MappedFileInit();
         ThreadingInit();
         cminor::util::Init();
 #ifdef GC_LOGGING
@@ -70,6 +75,7 @@ struct InitDone
 #endif
         cminor::util::Done();
         ThreadingDone();
+        MappedFileDone();
         SocketDone();
         FileDone();
         DoneVmFunctions();
@@ -105,7 +111,18 @@ void PrintHelp()
         "   --trace (-r)\n" <<
         "       Trace execution of native program to stderr (used with --native).\n" <<
         "   --stats (-a)\n" <<
-        "       Print statistics.\n" <<
+        "       Print statistics. Includes lock contention statistics of managed monitors and condition variables.\n" <<
+        "   --lock-stats=FILE (-k=FILE)\n" <<
+        "       Write lock contention statistics of managed monitors and condition variables to FILE in JSON format.\n" <<
+        "   --profile-out=FILE (-p=FILE)\n" <<
+        "       Write execution profile of the program to FILE (not used with --native).\n" <<
+        "       The profile contains function call counts, branch counts and switch target counts.\n" <<
+        "       It can be given to the native compiler with the --profile-in option.\n" <<
+        "   --perf-map (-m)\n" <<
+        "       Write addresses and mangled names of native functions to /tmp/perf-PID.map for Linux perf (used with --native).\n" <<
+        "   --perf-stacks=FILE (-e=FILE)\n" <<
+        "       Write managed stack of each interpreter thread 99 times per second to FILE (not used with --native).\n" <<
+        "       Each sample has the thread id and monotonic clock time, so it can be matched to samples of 'perf record -k mono'.\n" <<
         "   --gcactions (-g)\n" <<
         "       Print garbage collections actions to stderr.\n" <<
         "       [G]=collecting garbage, [F]=performing full collection.\n" <<
@@ -136,6 +153,9 @@ int main(int argc, const char** argv)
     int programReturnValue = 0;
     bool printStats = false;
     bool printGcActions = false;
+    std::string lockStatsFilePath;
+    std::string profileFilePath;
+    std::string perfStacksFilePath;
     try
     {
         if (argc < 2)
@@ -152,6 +172,7 @@ int main(int argc, const char** argv)
         bool jit = false;
         bool native = false;
         bool trace = false;
+        bool perfMap = false;
         for (int i = 1; i < argc; ++i)
         {
             std::string arg = argv[i];
@@ -185,11 +206,16 @@ int main(int argc, const char** argv)
                         else if (arg == "-a" || arg == "--stats")
                         {
                             printStats = true;
+                            EnableLockProfiling();
                         }
                         else if (arg == "-g" || arg == "--gcactions")
                         {
                             printGcActions = true;
                         }
+                        else if (arg == "-m" || arg == "--perf-map")
+                        {
+                            perfMap = true;
+                        }
                         else if (arg.find('=', 0) != std::string::npos)
                         {
                             std::vector<std::string> components = Split(arg, '=');
@@ -207,6 +233,19 @@ int main(int argc, const char** argv)
                                 int threadPages = boost::lexical_cast<int>(components[1]);
                                 SetNumAllocationContextPages(threadPages);
                             }
+                            else if (components[0] == "-k" || components[0] == "--lock-stats")
+                            {
+                                lockStatsFilePath = components[1];
+                                EnableLockProfiling();
+                            }
+                            else if (components[0] == "-p" || components[0] == "--profile-out")
+                            {
+                                profileFilePath = components[1];
+                            }
+                            else if (components[0] == "-e" || components[0] == "--perf-stacks")
+                            {
+                                perfStacksFilePath = components[1];
+                            }
                             else if (components[0] == "-l" || components[0] == "--gnutls-logging-level")
                             {
                                 int level = boost::lexical_cast<int>(components[1]);
@@ -270,6 +309,30 @@ int main(int argc, const char** argv)
                 std::cout << "tracing enabled" << std::endl;
             }
         }
+        if (!profileFilePath.empty())
+        {
+            if (native)
+            {
+                throw std::runtime_error("--profile-out cannot be used with --native option");
+            }
+            EnableExecutionProfiling();
+        }
+        if (perfMap)
+        {
+            if (!native)
+            {
+                throw std::runtime_error("--perf-map requires --native option");
+            }
+            EnablePerfMap();
+        }
+        if (!perfStacksFilePath.empty())
+        {
+            if (native)
+            {
+                throw std::runtime_error("--perf-stacks cannot be used with --native option");
+            }
+            StartManagedStackSampling(perfStacksFilePath);
+        }
         if (printGcActions)
         {
             machine.GetGarbageCollector().SetPrintActions();
@@ -277,6 +340,15 @@ int main(int argc, const char** argv)
         if (!native)
         {
             programReturnValue = assembly.RunIntermediateCode(programArguments);
+            StopManagedStackSampling();
+            if (!profileFilePath.empty())
+            {
+                WriteExecutionProfile(profileFilePath);
+                if (GetGlobalFlag(GlobalFlags::verbose))
+                {
+                    std::cout << "execution profile written to " << profileFilePath << std::endl;
+                }
+            }
         }
         else
         {
@@ -314,6 +386,22 @@ int main(int argc, const char** argv)
     if (printStats)
     {
         PrintStats();
+        PrintLockStats();
+    }
+    if (!lockStatsFilePath.empty())
+    {
+        try
+        {
+            WriteLockStatsJson(lockStatsFilePath);
+        }
+        catch (const std::exception& ex)
+        {
+            if (!GetGlobalFlag(GlobalFlags::quiet))
+            {
+                std::cerr << ex.what() << std::endl;
+            }
+            return 1;
+        }
     }
     return programReturnValue;
 }
@@ -0,0 +1,195 @@
+// =================================
+// Copyright (c) 2017 Seppo Laakko
+// Distributed under the MIT license
+// =================================
+
+#include <cminor/vmlib/MemoryMappedFile.hpp>
+#include <cminor/machine/Error.hpp>
+#include <cminor/util/MappedInputFile.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace cminor { namespace vmlib {
+
+using namespace cminor::machine;
+using namespace cminor::util;
+
+class MappedFile
+{
+public:
+    MappedFile(const std::string& filePath_);
+    const std::string& FilePath() const { return filePath; }
+    const uint8_t* Data() const { return data; }
+    int64_t Length() const { return length; }
+private:
+    std::string filePath;
+    std::unique_ptr<MappedInputFile> mapping;
+    const uint8_t* data;
+    int64_t length;
+};
+
+MappedFile::MappedFile(const std::string& filePath_) : filePath(filePath_), data(nullptr), length(0)
+{
+    boost::system::error_code ec;
+    uintmax_t fileSize = boost::filesystem::file_size(filePath, ec);
+    if (ec)
+    {
+        throw FileSystemError("could not map file '" + filePath + "': " + ec.message());
+    }
+    if (fileSize > 0)
+    {
+        try
+        {
+            mapping.reset(new MappedInputFile(filePath));
+        }
+        catch (const std::exception& ex)
+        {
+            throw FileSystemError("could not map file '" + filePath + "': " + ex.what());
+        }
+        data = reinterpret_cast<const uint8_t*>(mapping->Data());
+        length = static_cast<int64_t>(mapping->Size());
+    }
+}
+
+class MappedFileTable
+{
+public:
+    static void Init();
+    static void Done();
+    static MappedFileTable& Instance();
+    int32_t OpenMappedFile(const std::string& filePath);
+    void CloseMappedFile(int32_t mappedFileHandle);
+    std::shared_ptr<MappedFile> GetMappedFile(int32_t mappedFileHandle);
+private:
+    static std::unique_ptr<MappedFileTable> instance;
+    std::unordered_map<int32_t, std::shared_ptr<MappedFile>> mappedFileMap;
+    int32_t nextMappedFileHandle;
+    std::mutex mtx;
+    MappedFileTable();
+};
+
+std::unique_ptr<MappedFileTable> MappedFileTable::instance;
+
+void MappedFileTable::Init()
+{
+    instance.reset(new MappedFileTable());
+}
+
+void MappedFileTable::Done()
+{
+    instance.reset();
+}
+
+MappedFileTable& MappedFileTable::Instance()
+{
+    Assert(instance, "mapped file table not initialized");
+    return *instance;
+}
+
+MappedFileTable::MappedFileTable() : nextMappedFileHandle(1)
+{
+}
+
+int32_t MappedFileTable::OpenMappedFile(const std::string& filePath)
+{
+    std::shared_ptr<MappedFile> mappedFile(new MappedFile(filePath));
+    std::lock_guard<std::mutex> lock(mtx);
+    int32_t mappedFileHandle = nextMappedFileHandle++;
+    mappedFileMap[mappedFileHandle] = mappedFile;
+    return mappedFileHandle;
+}
+
+void MappedFileTable::CloseMappedFile(int32_t mappedFileHandle)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = mappedFileMap.find(mappedFileHandle);
+    if (it == mappedFileMap.cend())
+    {
+        throw FileSystemError("invalid mapped file handle " + std::to_string(mappedFileHandle));
+    }
+    mappedFileMap.erase(it);
+}
+
+//  A reader holds a reference to the mapping, so closing the file in another thread unmaps it only after the reader has finished.
+
+std::shared_ptr<MappedFile> MappedFileTable::GetMappedFile(int32_t mappedFileHandle)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = mappedFileMap.find(mappedFileHandle);
+    if (it == mappedFileMap.cend())
+    {
+        throw FileSystemError("invalid mapped file handle " + std::to_string(mappedFileHandle));
+    }
+    return it->second;
+}
+
+int32_t OpenMappedFile(const std::string& filePath)
+{
+    return MappedFileTable::Instance().OpenMappedFile(filePath);
+}
+
+void CloseMappedFile(int32_t mappedFileHandle)
+{
+    MappedFileTable::Instance().CloseMappedFile(mappedFileHandle);
+}
+
+int64_t GetMappedFileLength(int32_t mappedFileHandle)
+{
+    return MappedFileTable::Instance().GetMappedFile(mappedFileHandle)->Length();
+}
+
+//  The mapping stays at the same address until the file is closed, so the managed object caches the address and reads single values from it
+//  without looking up the mapping.
+
+const uint8_t* GetMappedFileData(int32_t mappedFileHandle)
+{
+    return MappedFileTable::Instance().GetMappedFile(mappedFileHandle)->Data();
+}
+
+int32_t ReadMappedFile(int32_t mappedFileHandle, int64_t position, uint8_t* buffer, int32_t count)
+{
+    std::shared_ptr<MappedFile> mappedFile = MappedFileTable::Instance().GetMappedFile(mappedFileHandle);
+    if (position < 0 || position > mappedFile->Length())
+    {
+        throw IndexOutOfRangeException("position " + std::to_string(position) + " out of range of mapped file '" + mappedFile->FilePath() + "' of length " +
+            std::to_string(mappedFile->Length()));
+    }
+    int64_t n = std::min(static_cast<int64_t>(count), mappedFile->Length() - position);
+    if (n > 0)
+    {
+        std::memcpy(buffer, mappedFile->Data() + position, n);
+    }
+    return static_cast<int32_t>(n);
+}
+
+int64_t MappedFileIndexOf(int32_t mappedFileHandle, uint8_t value, int64_t start)
+{
+    std::shared_ptr<MappedFile> mappedFile = MappedFileTable::Instance().GetMappedFile(mappedFileHandle);
+    if (start < 0 || start >= mappedFile->Length())
+    {
+        return -1;
+    }
+    const uint8_t* begin = mappedFile->Data() + start;
+    const void* found = std::memchr(begin, value, mappedFile->Length() - start);
+    if (!found)
+    {
+        return -1;
+    }
+    return start + (static_cast<const uint8_t*>(found) - begin);
+}
+
+void MappedFileInit()
+{
+    MappedFileTable::Init();
+}
+
+void MappedFileDone()
+{
+    MappedFileTable::Done();
+}
+
+} } // namespace cminor::vmlib
@@ -0,0 +1,26 @@
+// =================================
+// Copyright (c) 2017 Seppo Laakko
+// Distributed under the MIT license
+// =================================
+
+#ifndef CMINOR_VMLIB_MEMORY_MAPPED_FILE_INCLUDED
+#define CMINOR_VMLIB_MEMORY_MAPPED_FILE_INCLUDED
+#include <stdint.h>
+#include <string>
+
+namespace cminor { namespace vmlib {
+
+//  A memory mapped file is a read-only view of the whole file. The bytes are read from the mapping; they are never copied to the managed heap.
+
+int32_t OpenMappedFile(const std::string& filePath);
+void CloseMappedFile(int32_t mappedFileHandle);
+int64_t GetMappedFileLength(int32_t mappedFileHandle);
+const uint8_t* GetMappedFileData(int32_t mappedFileHandle);
+int32_t ReadMappedFile(int32_t mappedFileHandle, int64_t position, uint8_t* buffer, int32_t count);
+int64_t MappedFileIndexOf(int32_t mappedFileHandle, uint8_t value, int64_t start);
+void MappedFileInit();
+void MappedFileDone();
+
+} } // namespace cminor::vmlib
+
+#endif // CMINOR_VMLIB_MEMORY_MAPPED_FILE_INCLUDED
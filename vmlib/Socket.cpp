@@ -9,6 +9,9 @@
 #include <memory>
 #include <atomic>
 #include <mutex>
+#include <vector>
+#include <chrono>
+#include <thread>
 #ifdef _WIN32
 #include <winsock2.h>
 #include <ws2tcpip.h>    
@@ -21,6 +24,8 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <poll.h>
 #else
 #error unknown platform
 #endif
@@ -40,6 +45,25 @@ void SetGnuTlsLoggingLevel(int level)
     gnu_tls_logging_level = level;
 }
 
+class Selector
+{
+public:
+    Selector();
+    ~Selector();
+    void Add(int32_t socketHandle, SOCKET s, int32_t events);
+    void Modify(int32_t socketHandle, SOCKET s, int32_t events);
+    void Remove(int32_t socketHandle, SOCKET s);
+    int Wait(int timeoutMs, std::vector<SelectedSocket>& selected, int maxSockets);
+private:
+#ifdef _WIN32
+    std::mutex mtx;
+    std::vector<WSAPOLLFD> pollFds;
+    std::vector<int32_t> socketHandles;
+#else
+    int epollFd;
+#endif
+};
+
 class SocketTable
 {
 public:
@@ -56,6 +80,14 @@ public:
     int32_t ConnectSocket(const std::string& node, const std::string& service);
     int SendSocket(int32_t socketHandle, const char* buf, int len, int flags);
     int ReceiveSocket(int32_t socketHandle, char* buf, int len, int flags);
+    void SetSocketBlocking(int32_t socketHandle, bool blocking);
+    int32_t CreateSelector();
+    void CloseSelector(int32_t selectorHandle);
+    void AddToSelector(int32_t selectorHandle, int32_t socketHandle, int32_t events);
+    void ModifySelector(int32_t selectorHandle, int32_t socketHandle, int32_t events);
+    void RemoveFromSelector(int32_t selectorHandle, int32_t socketHandle);
+    int WaitSelector(int32_t selectorHandle, int timeoutMs, std::vector<SelectedSocket>& selected, int maxSockets);
+    void PollSocketWaits(std::vector<SocketWait>& socketWaits, int timeoutMs);
 private:
     static std::unique_ptr<SocketTable> instance;
     const int32_t maxNoLockSocketHandles = 256;
@@ -63,7 +95,11 @@ private:
     std::unordered_map<int32_t, SOCKET> socketMap;
     std::atomic<int32_t> nextSocketHandle;
     std::mutex mtx;
+    std::unordered_map<int32_t, std::shared_ptr<Selector>> selectorMap;
+    int32_t nextSelectorHandle;
     SocketTable();
+    SOCKET GetSocket(int32_t socketHandle);
+    std::shared_ptr<Selector> GetSelector(int32_t selectorHandle);
     void InitSockets();
     void DoneSockets();
     bool socketsInitialized;
@@ -81,7 +117,7 @@ void SocketTable::Done()
     instance.reset();
 }
 
-SocketTable::SocketTable() : socketsInitialized(false), nextSocketHandle(1)
+SocketTable::SocketTable() : socketsInitialized(false), nextSocketHandle(1), nextSelectorHandle(1)
 {
     sockets.resize(maxNoLockSocketHandles);
 }
@@ -118,6 +154,251 @@ std::string GetSocketErrorMessage(int errorCode)
     return std::string(buf);
 }
 
+bool WouldBlock(int errorCode)
+{
+#ifdef _WIN32
+    return errorCode == WSAEWOULDBLOCK;
+#elif defined(__linux) || defined(__unix) || defined(__posix)
+    return errorCode == EAGAIN || errorCode == EWOULDBLOCK;
+#else
+#error unknown platform
+#endif
+}
+
+void ThrowLastSocketError()
+{
+    int errorCode = GetLastSocketError();
+    SocketError socketError(GetSocketErrorMessage(errorCode));
+    socketError.SetErrorCode(errorCode);
+    throw socketError;
+}
+
+#ifdef _WIN32
+
+short ToPollEvents(int32_t events)
+{
+    short pollEvents = 0;
+    if ((events & selectRead) != 0)
+    {
+        pollEvents |= POLLRDNORM;
+    }
+    if ((events & selectWrite) != 0)
+    {
+        pollEvents |= POLLWRNORM;
+    }
+    return pollEvents;
+}
+
+int32_t FromPollEvents(short pollEvents)
+{
+    int32_t events = 0;
+    if ((pollEvents & (POLLRDNORM | POLLHUP)) != 0)
+    {
+        events |= selectRead;
+    }
+    if ((pollEvents & POLLWRNORM) != 0)
+    {
+        events |= selectWrite;
+    }
+    if ((pollEvents & (POLLERR | POLLHUP | POLLNVAL)) != 0)
+    {
+        events |= selectError;
+    }
+    return events;
+}
+
+Selector::Selector()
+{
+}
+
+Selector::~Selector()
+{
+}
+
+void Selector::Add(int32_t socketHandle, SOCKET s, int32_t events)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    WSAPOLLFD pollFd;
+    pollFd.fd = s;
+    pollFd.events = ToPollEvents(events);
+    pollFd.revents = 0;
+    pollFds.push_back(pollFd);
+    socketHandles.push_back(socketHandle);
+}
+
+void Selector::Modify(int32_t socketHandle, SOCKET s, int32_t events)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    int n = int(socketHandles.size());
+    for (int i = 0; i < n; ++i)
+    {
+        if (socketHandles[i] == socketHandle)
+        {
+            pollFds[i].events = ToPollEvents(events);
+            return;
+        }
+    }
+    throw SocketError("socket " + std::to_string(socketHandle) + " not registered to selector");
+}
+
+void Selector::Remove(int32_t socketHandle, SOCKET s)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    int n = int(socketHandles.size());
+    for (int i = 0; i < n; ++i)
+    {
+        if (socketHandles[i] == socketHandle)
+        {
+            pollFds.erase(pollFds.begin() + i);
+            socketHandles.erase(socketHandles.begin() + i);
+            return;
+        }
+    }
+    throw SocketError("socket " + std::to_string(socketHandle) + " not registered to selector");
+}
+
+int Selector::Wait(int timeoutMs, std::vector<SelectedSocket>& selected, int maxSockets)
+{
+    std::vector<WSAPOLLFD> fds;
+    std::vector<int32_t> handles;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        fds = pollFds;
+        handles = socketHandles;
+    }
+    selected.clear();
+    if (fds.empty())
+    {
+        if (timeoutMs > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+        }
+        return 0;
+    }
+    int result = WSAPoll(&fds[0], ULONG(fds.size()), timeoutMs);
+    if (result == SOCKET_ERROR)
+    {
+        ThrowLastSocketError();
+    }
+    int n = int(fds.size());
+    for (int i = 0; i < n && int(selected.size()) < maxSockets; ++i)
+    {
+        if (fds[i].revents != 0)
+        {
+            selected.push_back(SelectedSocket(handles[i], FromPollEvents(fds[i].revents)));
+        }
+    }
+    return int(selected.size());
+}
+
+#else
+
+uint32_t ToEpollEvents(int32_t events)
+{
+    uint32_t epollEvents = 0;
+    if ((events & selectRead) != 0)
+    {
+        epollEvents |= EPOLLIN | EPOLLRDHUP;
+    }
+    if ((events & selectWrite) != 0)
+    {
+        epollEvents |= EPOLLOUT;
+    }
+    return epollEvents;
+}
+
+int32_t FromEpollEvents(uint32_t epollEvents)
+{
+    int32_t events = 0;
+    if ((epollEvents & (EPOLLIN | EPOLLRDHUP)) != 0)
+    {
+        events |= selectRead;
+    }
+    if ((epollEvents & EPOLLOUT) != 0)
+    {
+        events |= selectWrite;
+    }
+    if ((epollEvents & (EPOLLERR | EPOLLHUP)) != 0)
+    {
+        events |= selectError;
+    }
+    return events;
+}
+
+Selector::Selector() : epollFd(epoll_create1(EPOLL_CLOEXEC))
+{
+    if (epollFd == -1)
+    {
+        ThrowLastSocketError();
+    }
+}
+
+Selector::~Selector()
+{
+    close(epollFd);
+}
+
+void Selector::Add(int32_t socketHandle, SOCKET s, int32_t events)
+{
+    epoll_event event;
+    event.events = ToEpollEvents(events);
+    event.data.u64 = uint32_t(socketHandle);
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, s, &event) == -1)
+    {
+        ThrowLastSocketError();
+    }
+}
+
+void Selector::Modify(int32_t socketHandle, SOCKET s, int32_t events)
+{
+    epoll_event event;
+    event.events = ToEpollEvents(events);
+    event.data.u64 = uint32_t(socketHandle);
+    if (epoll_ctl(epollFd, EPOLL_CTL_MOD, s, &event) == -1)
+    {
+        ThrowLastSocketError();
+    }
+}
+
+void Selector::Remove(int32_t socketHandle, SOCKET s)
+{
+    epoll_event event;
+    event.events = 0;
+    event.data.u64 = uint32_t(socketHandle);
+    if (epoll_ctl(epollFd, EPOLL_CTL_DEL, s, &event) == -1)
+    {
+        ThrowLastSocketError();
+    }
+}
+
+int Selector::Wait(int timeoutMs, std::vector<SelectedSocket>& selected, int maxSockets)
+{
+    selected.clear();
+    if (maxSockets <= 0)
+    {
+        return 0;
+    }
+    std::vector<epoll_event> epollEvents(maxSockets);
+    int result = 0;
+    do
+    {
+        result = epoll_wait(epollFd, &epollEvents[0], maxSockets, timeoutMs);
+    } 
+    while (result == -1 && errno == EINTR);
+    if (result == -1)
+    {
+        ThrowLastSocketError();
+    }
+    for (int i = 0; i < result; ++i)
+    {
+        const epoll_event& event = epollEvents[i];
+        selected.push_back(SelectedSocket(int32_t(event.data.u64), FromEpollEvents(event.events)));
+    }
+    return result;
+}
+
+#endif
+
 void SocketTable::InitSockets()
 {
     if (socketsInitialized) return;
@@ -273,14 +554,22 @@ int32_t SocketTable::AcceptSocket(int32_t socketHandle)
         if (a == INVALID_SOCKET)
         {
             int errorCode = GetLastSocketError();
+            if (WouldBlock(errorCode))
+            {
+                return -1;
+            }
             SocketError socketError(GetSocketErrorMessage(errorCode));
             socketError.SetErrorCode(errorCode);
             throw socketError;
         }
 #else
-        if (s == -1)
+        if (a == -1)
         {
             int errorCode = GetLastSocketError();
+            if (WouldBlock(errorCode))
+            {
+                return -1;
+            }
             SocketError socketError(GetSocketErrorMessage(errorCode));
             socketError.SetErrorCode(errorCode);
             throw socketError;
@@ -310,14 +599,22 @@ int32_t SocketTable::AcceptSocket(int32_t socketHandle)
             if (a == INVALID_SOCKET)
             {
                 int errorCode = GetLastSocketError();
+                if (WouldBlock(errorCode))
+                {
+                    return -1;
+                }
                 SocketError socketError(GetSocketErrorMessage(errorCode));
                 socketError.SetErrorCode(errorCode);
                 throw socketError;
             }
 #else
-            if (s == -1)
+            if (a == -1)
             {
                 int errorCode = GetLastSocketError();
+                if (WouldBlock(errorCode))
+                {
+                    return -1;
+                }
                 SocketError socketError(GetSocketErrorMessage(errorCode));
                 socketError.SetErrorCode(errorCode);
                 throw socketError;
@@ -530,6 +827,10 @@ int SocketTable::SendSocket(int32_t socketHandle, const char* buf, int len, int
     if (result < 0)
     {
         int errorCode = GetLastSocketError();
+        if (WouldBlock(errorCode))
+        {
+            return -1;
+        }
         SocketError socketError(GetSocketErrorMessage(errorCode));
         socketError.SetErrorCode(errorCode);
         throw socketError;
@@ -567,6 +868,10 @@ int SocketTable::ReceiveSocket(int32_t socketHandle, char* buf, int len, int fla
     if (result < 0)
     {
         int errorCode = GetLastSocketError();
+        if (WouldBlock(errorCode))
+        {
+            return -1;
+        }
         SocketError socketError(GetSocketErrorMessage(errorCode));
         socketError.SetErrorCode(errorCode);
         throw socketError;
@@ -574,6 +879,200 @@ int SocketTable::ReceiveSocket(int32_t socketHandle, char* buf, int len, int fla
     return result;
 }
 
+SOCKET SocketTable::GetSocket(int32_t socketHandle)
+{
+    if (socketHandle <= 0)
+    {
+        throw SocketError("invalid socket handle " + std::to_string(socketHandle));
+    }
+    else if (socketHandle < maxNoLockSocketHandles)
+    {
+        return sockets[socketHandle];
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = socketMap.find(socketHandle);
+        if (it != socketMap.cend())
+        {
+            return it->second;
+        }
+        else
+        {
+            throw SocketError("invalid socket handle " + std::to_string(socketHandle));
+        }
+    }
+}
+
+void SocketTable::SetSocketBlocking(int32_t socketHandle, bool blocking)
+{
+    InitSockets();
+    SOCKET s = GetSocket(socketHandle);
+#ifdef _WIN32
+    u_long nonBlocking = blocking ? 0 : 1;
+    if (ioctlsocket(s, FIONBIO, &nonBlocking) != 0)
+    {
+        ThrowLastSocketError();
+    }
+#else
+    int flags = fcntl(s, F_GETFL, 0);
+    if (flags == -1)
+    {
+        ThrowLastSocketError();
+    }
+    flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+    if (fcntl(s, F_SETFL, flags) == -1)
+    {
+        ThrowLastSocketError();
+    }
+#endif
+}
+
+//  Returns a shared pointer, so that a selector closed by another thread stays alive until the calling thread is done with it.
+
+std::shared_ptr<Selector> SocketTable::GetSelector(int32_t selectorHandle)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = selectorMap.find(selectorHandle);
+    if (it != selectorMap.cend())
+    {
+        return it->second;
+    }
+    throw SocketError("invalid selector handle " + std::to_string(selectorHandle));
+}
+
+int32_t SocketTable::CreateSelector()
+{
+    InitSockets();
+    std::shared_ptr<Selector> selector(new Selector());
+    std::lock_guard<std::mutex> lock(mtx);
+    int32_t selectorHandle = nextSelectorHandle++;
+    selectorMap[selectorHandle] = std::move(selector);
+    return selectorHandle;
+}
+
+void SocketTable::CloseSelector(int32_t selectorHandle)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = selectorMap.find(selectorHandle);
+    if (it == selectorMap.cend())
+    {
+        throw SocketError("invalid selector handle " + std::to_string(selectorHandle));
+    }
+    selectorMap.erase(it);
+}
+
+void SocketTable::AddToSelector(int32_t selectorHandle, int32_t socketHandle, int32_t events)
+{
+    SOCKET s = GetSocket(socketHandle);
+    std::shared_ptr<Selector> selector = GetSelector(selectorHandle);
+    selector->Add(socketHandle, s, events);
+}
+
+void SocketTable::ModifySelector(int32_t selectorHandle, int32_t socketHandle, int32_t events)
+{
+    SOCKET s = GetSocket(socketHandle);
+    std::shared_ptr<Selector> selector = GetSelector(selectorHandle);
+    selector->Modify(socketHandle, s, events);
+}
+
+void SocketTable::RemoveFromSelector(int32_t selectorHandle, int32_t socketHandle)
+{
+    SOCKET s = GetSocket(socketHandle);
+    std::shared_ptr<Selector> selector = GetSelector(selectorHandle);
+    selector->Remove(socketHandle, s);
+}
+
+int SocketTable::WaitSelector(int32_t selectorHandle, int timeoutMs, std::vector<SelectedSocket>& selected, int maxSockets)
+{
+    std::shared_ptr<Selector> selector = GetSelector(selectorHandle);
+    return selector->Wait(timeoutMs, selected, maxSockets);
+}
+
+#ifdef _WIN32
+
+void SocketTable::PollSocketWaits(std::vector<SocketWait>& socketWaits, int timeoutMs)
+{
+    std::vector<WSAPOLLFD> fds;
+    for (SocketWait& socketWait : socketWaits)
+    {
+        WSAPOLLFD pollFd;
+        pollFd.fd = INVALID_SOCKET;
+        try
+        {
+            pollFd.fd = GetSocket(socketWait.socketHandle);
+        }
+        catch (const SocketError&)
+        {
+            socketWait.ready = true;
+            timeoutMs = 0;
+        }
+        pollFd.events = ToPollEvents(socketWait.events);
+        pollFd.revents = 0;
+        fds.push_back(pollFd);
+    }
+    int result = WSAPoll(&fds[0], ULONG(fds.size()), timeoutMs);
+    if (result == SOCKET_ERROR)
+    {
+        ThrowLastSocketError();
+    }
+    int n = int(fds.size());
+    for (int i = 0; i < n; ++i)
+    {
+        if (fds[i].revents != 0)
+        {
+            socketWaits[i].ready = true;
+        }
+    }
+}
+
+#else
+
+void SocketTable::PollSocketWaits(std::vector<SocketWait>& socketWaits, int timeoutMs)
+{
+    std::vector<pollfd> fds;
+    for (SocketWait& socketWait : socketWaits)
+    {
+        pollfd pollFd;
+        pollFd.fd = -1;
+        try
+        {
+            pollFd.fd = GetSocket(socketWait.socketHandle);
+        }
+        catch (const SocketError&)
+        {
+            socketWait.ready = true;
+            timeoutMs = 0;
+        }
+        pollFd.events = 0;
+        if ((socketWait.events & selectRead) != 0)
+        {
+            pollFd.events |= POLLIN;
+        }
+        if ((socketWait.events & selectWrite) != 0)
+        {
+            pollFd.events |= POLLOUT;
+        }
+        pollFd.revents = 0;
+        fds.push_back(pollFd);
+    }
+    int result = poll(&fds[0], fds.size(), timeoutMs);
+    if (result == -1 && errno != EINTR)
+    {
+        ThrowLastSocketError();
+    }
+    int n = int(fds.size());
+    for (int i = 0; i < n; ++i)
+    {
+        if (fds[i].revents != 0)
+        {
+            socketWaits[i].ready = true;
+        }
+    }
+}
+
+#endif
+
 int32_t CreateSocket()
 {
     return SocketTable::Instance().CreateSocket();
@@ -619,13 +1118,55 @@ int ReceiveSocket(int32_t socketHandle, char* buf, int len, int flags)
     return SocketTable::Instance().ReceiveSocket(socketHandle, buf, len, flags);
 }
 
+void SetSocketBlocking(int32_t socketHandle, bool blocking)
+{
+    SocketTable::Instance().SetSocketBlocking(socketHandle, blocking);
+}
+
+int32_t CreateSelector()
+{
+    return SocketTable::Instance().CreateSelector();
+}
+
+void CloseSelector(int32_t selectorHandle)
+{
+    SocketTable::Instance().CloseSelector(selectorHandle);
+}
+
+void AddToSelector(int32_t selectorHandle, int32_t socketHandle, int32_t events)
+{
+    SocketTable::Instance().AddToSelector(selectorHandle, socketHandle, events);
+}
+
+void ModifySelector(int32_t selectorHandle, int32_t socketHandle, int32_t events)
+{
+    SocketTable::Instance().ModifySelector(selectorHandle, socketHandle, events);
+}
+
+void RemoveFromSelector(int32_t selectorHandle, int32_t socketHandle)
+{
+    SocketTable::Instance().RemoveFromSelector(selectorHandle, socketHandle);
+}
+
+int WaitSelector(int32_t selectorHandle, int timeoutMs, std::vector<SelectedSocket>& selected, int maxSockets)
+{
+    return SocketTable::Instance().WaitSelector(selectorHandle, timeoutMs, selected, maxSockets);
+}
+
+void PollSocketWaits(std::vector<SocketWait>& socketWaits, int timeoutMs)
+{
+    SocketTable::Instance().PollSocketWaits(socketWaits, timeoutMs);
+}
+
 void SocketInit()
 {
     SocketTable::Init();
+    SetPollSocketsFn(PollSocketWaits);
 }
 
 void SocketDone()
 {
+    SetPollSocketsFn(nullptr);
     SocketTable::Done();
 }
 
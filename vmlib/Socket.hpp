@@ -5,8 +5,10 @@
 
 #ifndef CMINOR_VMLIB_SOCKET_INCLUDED
 #define CMINOR_VMLIB_SOCKET_INCLUDED
+#include <cminor/machine/Fiber.hpp>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 namespace cminor { namespace vmlib {
 
@@ -26,6 +28,35 @@ int32_t ConnectSocket(const std::string& node, const std::string& service);
 int SendSocket(int32_t socketHandle, const char* buf, int len, int flags);
 int ReceiveSocket(int32_t socketHandle, char* buf, int len, int flags);
 
+//  A non-blocking socket returns -1 from AcceptSocket, SendSocket and ReceiveSocket when the operation would block.
+
+void SetSocketBlocking(int32_t socketHandle, bool blocking);
+
+//  A selector waits for readiness events of a set of sockets. It is backed by epoll on Linux and by WSAPoll on Windows.
+
+const int32_t selectRead = 1;
+const int32_t selectWrite = 2;
+const int32_t selectError = 4;
+
+struct SelectedSocket
+{
+    SelectedSocket(int32_t socketHandle_, int32_t events_) : socketHandle(socketHandle_), events(events_) {}
+    int32_t socketHandle;
+    int32_t events;
+};
+
+int32_t CreateSelector();
+void CloseSelector(int32_t selectorHandle);
+void AddToSelector(int32_t selectorHandle, int32_t socketHandle, int32_t events);
+void ModifySelector(int32_t selectorHandle, int32_t socketHandle, int32_t events);
+void RemoveFromSelector(int32_t selectorHandle, int32_t socketHandle);
+int WaitSelector(int32_t selectorHandle, int timeoutMs, std::vector<SelectedSocket>& selected, int maxSockets);
+
+//  Sets the ready flag of the socket waits of fibers whose sockets are ready for the events, waiting at most timeoutMs milliseconds. A socket
+//  that is closed or in error counts as ready, so that the fiber retries the operation and gets the error.
+
+void PollSocketWaits(std::vector<cminor::machine::SocketWait>& socketWaits, int timeoutMs);
+
 void SocketInit();
 void SocketDone();
 
@@ -4,11 +4,25 @@
 // =================================
 
 #include <cminor/vmlib/Threading.hpp>
+#include <cminor/machine/Machine.hpp>
 #include <mutex>
 #include <condition_variable>
+#include <thread>
 
 namespace cminor { namespace vmlib {
 
+//  An inflated lock records its owner thread and recursion count, so that exiting a monitor not owned by the current thread can be detected.
+
+const int32_t noLockOwner = -1;
+
+struct InflatedLock
+{
+    InflatedLock() : owner(noLockOwner), count(0) {}
+    std::recursive_mutex mtx;
+    std::atomic<int32_t> owner;
+    int32_t count;
+};
+
 class LockTable
 {
 public:
@@ -17,21 +31,33 @@ public:
     static LockTable& Instance() { Assert(instance, "lock table instance not set"); return *instance; }
     int32_t CreateLock();
     void DestroyLock(int32_t lockId);
-    std::recursive_mutex& GetLock(int32_t lockId);
-    void AcquireLock(int32_t lockId);
-    void ReleaseLock(int32_t lockId);
+    InflatedLock& GetLock(int32_t lockId);
+    bool AcquireLock(int32_t lockId, int32_t threadId);
+    void ReleaseLock(int32_t lockId, int32_t threadId);
 private:
     const int32_t maxNoLockingMtxSize = 256;
     static std::unique_ptr<LockTable> instance;
     std::atomic<int32_t> nextLockId;
     std::mutex mtx;
-    std::vector<std::unique_ptr<std::recursive_mutex>> mutexes;
-    std::unordered_map<uint32_t, std::unique_ptr<std::recursive_mutex>> mutexMap;
+    std::vector<std::unique_ptr<InflatedLock>> locks;
+    std::unordered_map<uint32_t, std::unique_ptr<InflatedLock>> lockMap;
     LockTable();
 };
 
 std::unique_ptr<LockTable> LockTable::instance;
 
+//  Returns true if the mutex was held by another thread, so that the calling thread had to wait for it.
+
+inline bool AcquireMutex(std::recursive_mutex& m)
+{
+    if (m.try_lock())
+    {
+        return false;
+    }
+    m.lock();
+    return true;
+}
+
 void LockTable::Init()
 {
     instance.reset(new LockTable());
@@ -44,7 +70,7 @@ void LockTable::Done()
 
 LockTable::LockTable() : nextLockId(0)
 {
-    mutexes.resize(maxNoLockingMtxSize);
+    locks.resize(maxNoLockingMtxSize);
 }
 
 int32_t LockTable::CreateLock()
@@ -53,12 +79,12 @@ int32_t LockTable::CreateLock()
     Assert(lockId >= 0, "invalid lock id");
     if (lockId < maxNoLockingMtxSize)
     {
-        mutexes[lockId].reset(new std::recursive_mutex());
+        locks[lockId].reset(new InflatedLock());
     }
     else
     {
         std::lock_guard<std::mutex> lock(mtx);
-        mutexMap.insert(std::make_pair(lockId, std::unique_ptr<std::recursive_mutex>(new std::recursive_mutex())));
+        lockMap.insert(std::make_pair(lockId, std::unique_ptr<InflatedLock>(new InflatedLock())));
     }
     return lockId;
 }
@@ -68,16 +94,16 @@ void LockTable::DestroyLock(int32_t lockId)
     Assert(lockId >= 0, "invalid lock id");
     if (lockId < maxNoLockingMtxSize)
     {
-        mutexes[lockId].reset();
+        locks[lockId].reset();
     }
     else
     {
         std::lock_guard<std::mutex> lock(mtx);
-        mutexMap.erase(lockId);
+        lockMap.erase(lockId);
     }
 }
 
-std::recursive_mutex& LockTable::GetLock(int32_t lockId)
+InflatedLock& LockTable::GetLock(int32_t lockId)
 {
     if (lockId < 0)
     {
@@ -85,10 +111,10 @@ std::recursive_mutex& LockTable::GetLock(int32_t lockId)
     }
     else if (lockId < maxNoLockingMtxSize)
     {
-        std::recursive_mutex* m = mutexes[lockId].get();
-        if (m)
+        InflatedLock* l = locks[lockId].get();
+        if (l)
         {
-            return *m;
+            return *l;
         }
         else
         {
@@ -98,13 +124,13 @@ std::recursive_mutex& LockTable::GetLock(int32_t lockId)
     else
     {
         std::lock_guard<std::mutex> lock(mtx);
-        auto it = mutexMap.find(lockId);
-        if (it != mutexMap.cend())
+        auto it = lockMap.find(lockId);
+        if (it != lockMap.cend())
         {
-            std::recursive_mutex* m = it->second.get();
-            if (m)
+            InflatedLock* l = it->second.get();
+            if (l)
             {
-                return *m;
+                return *l;
             }
             else
             {
@@ -118,106 +144,260 @@ std::recursive_mutex& LockTable::GetLock(int32_t lockId)
     }
 }
 
-void LockTable::AcquireLock(int32_t lockId)
+bool LockTable::AcquireLock(int32_t lockId, int32_t threadId)
 {
-    if (lockId < 0)
+    InflatedLock& l = GetLock(lockId);
+    bool waited = AcquireMutex(l.mtx);
+    l.owner.store(threadId, std::memory_order_relaxed);
+    ++l.count;
+    return waited;
+}
+
+void LockTable::ReleaseLock(int32_t lockId, int32_t threadId)
+{
+    InflatedLock& l = GetLock(lockId);
+    if (l.owner.load(std::memory_order_relaxed) != threadId)
     {
-        throw std::runtime_error("invalid lock id " + std::to_string(lockId));
+        throw ThreadingException("tried to exit a monitor not owned by the current thread");
     }
-    else if (lockId < maxNoLockingMtxSize)
+    if (--l.count == 0)
+    {
+        l.owner.store(noLockOwner, std::memory_order_relaxed);
+    }
+    l.mtx.unlock();
+}
+
+//  The lock word of a managed allocation header is either lockNotAllocated (an unlocked thin lock), a nonnegative LockTable lock id (an inflated lock),
+//  or a thin lock held by a thread. A held thin lock has bit 31 set, the owner thread id + 1 in bits 8..30, the waiters bit in bit 7 and the recursion count in bits 0..6.
+//  An uncontended lock is acquired with a single compare-and-swap. A thread that finds the thin lock held by another thread spins for a while,
+//  then sets the waiters bit and parks on a condition variable selected by the allocation handle of the lock object. The owner wakes the parked threads when it releases
+//  or inflates the lock. A thread that had to wait for a thin lock inflates it to a LockTable mutex after acquiring it, so later contenders block on the mutex.
+//  Waiting on a condition variable also inflates the lock. Inflated locks are never deflated.
+//  EnterMonitor returns true if the calling thread had to wait for the lock.
+
+const uint32_t thinLockBit = 0x80000000u;
+const int32_t thinLockOwnerShift = 8;
+const uint32_t thinLockWaitersBit = 0x80u;
+const uint32_t thinLockCountMask = 0x7Fu;
+const uint32_t maxThinLockOwner = 0x7FFFFEu;
+const uint32_t maxThinLockCount = 0x7Eu;
+const int32_t numSpinsBeforeYield = 64;
+const int32_t numSpinsBeforePark = 1024;
+
+inline bool IsThinLock(int32_t lockWord)
+{
+    return lockWord < 0 && lockWord != lockNotAllocated;
+}
+
+inline uint32_t ThinLockOwner(int32_t lockWord)
+{
+    return (static_cast<uint32_t>(lockWord) & ~thinLockBit) >> thinLockOwnerShift;
+}
+
+inline uint32_t ThinLockCount(int32_t lockWord)
+{
+    return static_cast<uint32_t>(lockWord) & thinLockCountMask;
+}
+
+inline bool ThinLockHasWaiters(int32_t lockWord)
+{
+    return (static_cast<uint32_t>(lockWord) & thinLockWaitersBit) != 0;
+}
+
+inline int32_t MakeThinLock(uint32_t owner, uint32_t count)
+{
+    return static_cast<int32_t>(thinLockBit | (owner << thinLockOwnerShift) | count);
+}
+
+inline uint32_t ThinLockOwnerOf(int32_t threadId)
+{
+    uint32_t owner = static_cast<uint32_t>(threadId) + 1;
+    Assert(owner <= maxThinLockOwner, "thread id too big for a thin lock");
+    return owner;
+}
+
+struct ParkingSlot
+{
+    std::mutex mtx;
+    std::condition_variable cv;
+};
+
+const int numParkingSlots = 64;
+
+ParkingSlot parkingSlots[numParkingSlots];
+
+//  The garbage collector moves the lock object while the threads are paused or waiting, so the parking slot is selected by the allocation handle
+//  of the lock object, and a header is used only while the calling thread is running.
+
+inline ParkingSlot& GetParkingSlot(ObjectReference lockReference)
+{
+    return parkingSlots[lockReference.Value() % numParkingSlots];
+}
+
+ManagedAllocationHeader* GetLockHeader(ObjectReference lockReference)
+{
+    ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+    std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex());
+    return GetAllocationHeader(memoryPool.GetObject(lockReference, lock));
+}
+
+void UnparkWaiters(ObjectReference lockReference)
+{
+    ParkingSlot& slot = GetParkingSlot(lockReference);
+    std::lock_guard<std::mutex> lock(slot.mtx);
+    slot.cv.notify_all();
+}
+
+//  Blocks until the lock word of a thin lock held by another thread changes. The waiters bit is set under the slot mutex, and the owner notifies under it,
+//  so a release between setting the bit and waiting is not lost. The header is not touched after the thread has entered the waiting state.
+
+void ParkOnThinLock(ObjectReference lockReference, ManagedAllocationHeader* header, uint32_t owner, Thread& thread)
+{
+    ParkingSlot& slot = GetParkingSlot(lockReference);
     {
-        std::recursive_mutex* m = mutexes[lockId].get();
-        if (m)
+        std::unique_lock<std::mutex> lock(slot.mtx);
+        int32_t lockWord = header->lockId.load(std::memory_order_acquire);
+        if (!IsThinLock(lockWord) || ThinLockOwner(lockWord) == owner)
         {
-            m->lock();
+            return;
         }
-        else
+        if (!ThinLockHasWaiters(lockWord))
         {
-            throw std::runtime_error("invalid lock id " + std::to_string(lockId));
+            if (!header->lockId.compare_exchange_strong(lockWord, static_cast<int32_t>(static_cast<uint32_t>(lockWord) | thinLockWaitersBit), std::memory_order_acq_rel))
+            {
+                return;
+            }
         }
+        WaitingSetter waiting(thread);
+        slot.cv.wait(lock);
     }
-    else
+    GetMachine().GetGarbageCollector().WaitForIdle(thread);
+}
+
+//  Called by the owner of a thin lock: creates a LockTable mutex, acquires it as many times as the thin lock has been acquired and publishes its id in the lock word.
+
+int32_t InflateThinLock(ObjectReference lockReference, ManagedAllocationHeader* header, int32_t threadId, uint32_t count)
+{
+    int32_t lockId = LockTable::Instance().CreateLock();
+    for (uint32_t i = 0; i < count; ++i)
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        auto it = mutexMap.find(lockId);
-        if (it != mutexMap.cend())
+        LockTable::Instance().AcquireLock(lockId, threadId);
+    }
+    int32_t prevLockWord = header->lockId.exchange(lockId, std::memory_order_acq_rel);
+    if (IsThinLock(prevLockWord) && ThinLockHasWaiters(prevLockWord))
+    {
+        UnparkWaiters(lockReference);
+    }
+    return lockId;
+}
+
+bool EnterMonitor(ObjectReference lockReference, Thread& thread)
+{
+    int32_t threadId = thread.Id();
+    uint32_t owner = ThinLockOwnerOf(threadId);
+    int32_t numSpins = 0;
+    ManagedAllocationHeader* header = GetLockHeader(lockReference);
+    while (true)
+    {
+        int32_t lockWord = header->lockId.load(std::memory_order_acquire);
+        if (lockWord == lockNotAllocated)
         {
-            std::recursive_mutex* m = it->second.get();
-            if (m)
+            if (header->lockId.compare_exchange_weak(lockWord, MakeThinLock(owner, 1), std::memory_order_acquire))
             {
-                m->lock();
+                if (numSpins > 0)
+                {
+                    InflateThinLock(lockReference, header, threadId, 1);
+                    return true;
+                }
+                return false;
+            }
+        }
+        else if (lockWord >= 0)
+        {
+            bool contended = false;
+            {
+                WaitingSetter waiting(thread);
+                contended = LockTable::Instance().AcquireLock(lockWord, threadId);
+            }
+            GetMachine().GetGarbageCollector().WaitForIdle(thread);
+            return contended || numSpins > 0;
+        }
+        else if (ThinLockOwner(lockWord) == owner)
+        {
+            uint32_t count = ThinLockCount(lockWord);
+            if (count < maxThinLockCount)
+            {
+                header->lockId.fetch_add(1, std::memory_order_relaxed);
             }
             else
             {
-                throw std::runtime_error("invalid lock id " + std::to_string(lockId));
+                InflateThinLock(lockReference, header, threadId, count + 1);
             }
+            return false;
         }
         else
         {
-            throw std::runtime_error("invalid lock id " + std::to_string(lockId));
+            ++numSpins;
+            if (numSpins >= numSpinsBeforePark)
+            {
+                ParkOnThinLock(lockReference, header, owner, thread);
+                header = GetLockHeader(lockReference);
+            }
+            else if (numSpins % numSpinsBeforeYield == 0)
+            {
+                std::this_thread::yield();
+            }
         }
     }
 }
 
-void LockTable::ReleaseLock(int32_t lockId)
+void ExitMonitor(ObjectReference lockReference, int32_t threadId)
 {
-    if (lockId < 0)
+    ManagedAllocationHeader* header = GetLockHeader(lockReference);
+    int32_t lockWord = header->lockId.load(std::memory_order_relaxed);
+    if (lockWord >= 0)
     {
-        throw std::runtime_error("invalid lock id " + std::to_string(lockId));
+        LockTable::Instance().ReleaseLock(lockWord, threadId);
     }
-    else if (lockId < maxNoLockingMtxSize)
+    else if (IsThinLock(lockWord) && ThinLockOwner(lockWord) == ThinLockOwnerOf(threadId))
     {
-        std::recursive_mutex* m = mutexes[lockId].get();
-        if (m)
+        uint32_t count = ThinLockCount(lockWord);
+        if (count > 1)
         {
-            m->unlock();
+            header->lockId.fetch_sub(1, std::memory_order_relaxed);
         }
         else
         {
-            throw std::runtime_error("invalid lock id " + std::to_string(lockId));
+            int32_t prevLockWord = header->lockId.exchange(lockNotAllocated, std::memory_order_release);
+            if (ThinLockHasWaiters(prevLockWord))
+            {
+                UnparkWaiters(lockReference);
+            }
         }
     }
     else
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        auto it = mutexMap.find(lockId);
-        if (it != mutexMap.cend())
-        {
-            std::recursive_mutex* m = it->second.get();
-            if (m)
-            {
-                m->unlock();
-            }
-            else
-            {
-                throw std::runtime_error("invalid lock id " + std::to_string(lockId));
-            }
-        }
-        else
-        {
-            throw std::runtime_error("invalid lock id " + std::to_string(lockId));
-        }
+        throw ThreadingException("tried to exit a monitor not owned by the current thread");
     }
 }
 
-std::mutex createLockMutex;
-
-void EnterMonitor(ManagedAllocationHeader* header)
+int32_t InflateMonitor(ObjectReference lockReference, int32_t threadId)
 {
-    if (header->LockId() == lockNotAllocated)
+    ManagedAllocationHeader* header = GetLockHeader(lockReference);
+    int32_t lockWord = header->lockId.load(std::memory_order_acquire);
+    if (lockWord >= 0)
     {
-        std::lock_guard<std::mutex> lock(createLockMutex);
-        if (header->LockId() == lockNotAllocated)
+        if (LockTable::Instance().GetLock(lockWord).owner.load(std::memory_order_relaxed) != threadId)
         {
-            header->SetLockId(LockTable::Instance().CreateLock());
+            throw ThreadingException("condition variable must be waited inside a lock statement");
         }
+        return lockWord;
     }
-    LockTable::Instance().AcquireLock(header->LockId());
-}
-
-void ExitMonitor(ManagedAllocationHeader* header)
-{
-    LockTable::Instance().ReleaseLock(header->LockId());
+    if (IsThinLock(lockWord) && ThinLockOwner(lockWord) == ThinLockOwnerOf(threadId))
+    {
+        return InflateThinLock(lockReference, header, threadId, ThinLockCount(lockWord));
+    }
+    throw ThreadingException("condition variable must be waited inside a lock statement");
 }
 
 void DestroyLock(uint32_t lockId)
@@ -354,19 +534,42 @@ void NotifyAll(int32_t conditionVariableId)
     conditionVariable.notify_all();
 }
 
-void WaitConditionVariable(int32_t conditionVariableId, int32_t lockId)
+//  The waiting thread gives up the ownership of the inflated lock for the duration of the wait and regains it with its recursion count when the wait returns.
+
+class LockOwnershipReleaser
+{
+public:
+    LockOwnershipReleaser(InflatedLock& l_, int32_t threadId_) : l(l_), threadId(threadId_), count(l.count)
+    {
+        l.count = 0;
+        l.owner.store(noLockOwner, std::memory_order_relaxed);
+    }
+    ~LockOwnershipReleaser()
+    {
+        l.owner.store(threadId, std::memory_order_relaxed);
+        l.count = count;
+    }
+private:
+    InflatedLock& l;
+    int32_t threadId;
+    int32_t count;
+};
+
+void WaitConditionVariable(int32_t conditionVariableId, int32_t lockId, int32_t threadId)
 {
-    std::recursive_mutex& mtx = LockTable::Instance().GetLock(lockId);
+    InflatedLock& l = LockTable::Instance().GetLock(lockId);
     std::condition_variable_any& conditionVariable = ConditionVariableTable::Instance().GetConditionVariable(conditionVariableId);
-    conditionVariable.wait(mtx);
+    LockOwnershipReleaser releaser(l, threadId);
+    conditionVariable.wait(l.mtx);
 }
 
-CondVarStatus WaitConditionVariable(int32_t conditionVariableId, int32_t lockId, std::chrono::nanoseconds duration)
+CondVarStatus WaitConditionVariable(int32_t conditionVariableId, int32_t lockId, int32_t threadId, std::chrono::nanoseconds duration)
 {
-    std::recursive_mutex& mtx = LockTable::Instance().GetLock(lockId);
+    InflatedLock& l = LockTable::Instance().GetLock(lockId);
     std::condition_variable_any& conditionVariable = ConditionVariableTable::Instance().GetConditionVariable(conditionVariableId);
     CondVarStatus status = CondVarStatus::timeout;
-    if (conditionVariable.wait_for(mtx, duration) == std::cv_status::no_timeout)
+    LockOwnershipReleaser releaser(l, threadId);
+    if (conditionVariable.wait_for(l.mtx, duration) == std::cv_status::no_timeout)
     {
         status = CondVarStatus::no_timeout;
     }
@@ -6,14 +6,16 @@
 #ifndef CMINOR_VMLIB_THREADING_INCLUDED
 #define CMINOR_VMLIB_THREADING_INCLUDED
 #include <cminor/machine/Object.hpp>
+#include <cminor/machine/Thread.hpp>
 #include <chrono>
 
 namespace cminor { namespace vmlib {
 
 using namespace cminor::machine;
 
-void EnterMonitor(ManagedAllocationHeader* header);
-void ExitMonitor(ManagedAllocationHeader* header);
+bool EnterMonitor(ObjectReference lockReference, Thread& thread);
+void ExitMonitor(ObjectReference lockReference, int32_t threadId);
+int32_t InflateMonitor(ObjectReference lockReference, int32_t threadId);
 
 int32_t CreateConditionVariable();
 void DestroyConditionVariable(int32_t conditionVariableId);
@@ -21,14 +23,14 @@ void DestroyConditionVariable(int32_t conditionVariableId);
 void NotifyOne(int32_t conditionVariableId);
 void NotifyAll(int32_t conditionVariableId);
 
-void WaitConditionVariable(int32_t conditionVariableId, int32_t lockId);
+void WaitConditionVariable(int32_t conditionVariableId, int32_t lockId, int32_t threadId);
 
 enum class CondVarStatus : uint8_t
 {
     timeout, no_timeout
 };
 
-CondVarStatus WaitConditionVariable(int32_t conditionVariableId, int32_t lockId, std::chrono::nanoseconds duration);
+CondVarStatus WaitConditionVariable(int32_t conditionVariableId, int32_t lockId, int32_t threadId, std::chrono::nanoseconds duration);
 
 void ThreadingInit();
 void ThreadingDone();
@@ -6,18 +6,23 @@
 #include <cminor/vmlib/VmFunction.hpp>
 #include <cminor/vmlib/File.hpp>
 #include <cminor/vmlib/Socket.hpp>
+#include <cminor/vmlib/MemoryMappedFile.hpp>
 #include <cminor/vmlib/Threading.hpp>
 #include <cminor/machine/Function.hpp>
 #include <cminor/machine/Class.hpp>
 #include <cminor/machine/Type.hpp>
 #include <cminor/machine/Machine.hpp>
 #include <cminor/machine/Runtime.hpp>
+#include <cminor/machine/StringOps.hpp>
+#include <cminor/machine/ArrayOps.hpp>
+#include <cminor/machine/LockProfiler.hpp>
 #include <cminor/util/Random.hpp>
 #include <cminor/util/Unicode.hpp>
 #include <cminor/util/Defines.hpp>
 #include <boost/filesystem.hpp>
 #include <cctype>
 #include <chrono>
+#include <cstring>
 #include <thread>
 
 namespace cminor { namespace vmlib {
@@ -623,36 +628,29 @@ void VmSystemStringConstructorCharArray::Execute(Frame& frame)
     }
 }
 
-class VmSystemIOOpenFile : public VmFunction
+class VmSystemStringIntern : public VmFunction
 {
 public:
-    VmSystemIOOpenFile(ConstantPool& constantPool);
+    VmSystemStringIntern(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemIOOpenFile::VmSystemIOOpenFile(ConstantPool& constantPool)
+VmSystemStringIntern::VmSystemStringIntern(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"fopen"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"intern"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemIOOpenFile::Execute(Frame& frame)
+void VmSystemStringIntern::Execute(Frame& frame)
 {
     try
     {
-        IntegralValue filePathValue = frame.Local(0).GetValue();
-        Assert(filePathValue.GetType() == ValueType::objectReference, "object reference expected");
-        ObjectReference filePathStr(filePathValue.Value());
-        std::string filePath = GetManagedMemoryPool().GetUtf8String(filePathStr);
-        IntegralValue modeValue = frame.Local(1).GetValue();
-        Assert(modeValue.GetType() == ValueType::byteType, "byte expected");
-        FileMode mode = static_cast<FileMode>(modeValue.AsByte());
-        IntegralValue accessValue = frame.Local(2).GetValue();
-        Assert(accessValue.GetType() == ValueType::byteType, "byte expected");
-        FileAccess access = static_cast<FileAccess>(accessValue.AsByte());
-        int32_t fileHandle = OpenFile(filePath, mode, access);
-        frame.OpStack().Push(MakeIntegralValue<int32_t>(fileHandle, ValueType::intType));
+        IntegralValue stringValue = frame.Local(0).GetValue();
+        Assert(stringValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference stringRef(stringValue.Value());
+        ObjectReference internedRef = GetManagedMemoryPool().InternString(frame.GetThread(), stringRef);
+        frame.OpStack().Push(internedRef);
     }
     catch (const NullReferenceException& ex)
     {
@@ -662,14 +660,6 @@ void VmSystemIOOpenFile::Execute(Frame& frame)
         }
         ThrowNullReferenceException(ex, frame);
     }
-    catch (const FileSystemError& ex)
-    {
-        if (RunningNativeCode())
-        {
-            throw;
-        }
-        ThrowFileSystemException(ex, frame);
-    }
     catch (const SystemException& ex)
     {
         if (RunningNativeCode())
@@ -680,36 +670,51 @@ void VmSystemIOOpenFile::Execute(Frame& frame)
     }
 }
 
-class VmSystemIOCloseFile : public VmFunction
+class VmSystemStringIndexOf : public VmFunction
 {
 public:
-    VmSystemIOCloseFile(ConstantPool& constantPool);
+    VmSystemStringIndexOf(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemIOCloseFile::VmSystemIOCloseFile(ConstantPool& constantPool)
+VmSystemStringIndexOf::VmSystemStringIndexOf(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"fclose"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"strindexof"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemIOCloseFile::Execute(Frame& frame)
+void VmSystemStringIndexOf::Execute(Frame& frame)
 {
     try
     {
-        IntegralValue fileHandleValue = frame.Local(0).GetValue();
-        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
-        int32_t fileHandle = fileHandleValue.AsInt();
-        CloseFile(fileHandle);
+        IntegralValue strValue = frame.Local(0).GetValue();
+        Assert(strValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference str(strValue.Value());
+        IntegralValue cValue = frame.Local(1).GetValue();
+        Assert(cValue.GetType() == ValueType::charType, "char expected");
+        char32_t c = cValue.AsChar();
+        IntegralValue startValue = frame.Local(2).GetValue();
+        Assert(startValue.GetType() == ValueType::intType, "int expected");
+        int32_t start = startValue.AsInt();
+        int32_t result = StringIndexOf(str, c, start);
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(result, ValueType::intType));
     }
-    catch (const FileSystemError& ex)
+    catch (const NullReferenceException& ex)
     {
         if (RunningNativeCode())
         {
             throw;
         }
-        ThrowFileSystemException(ex, frame);
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
     }
     catch (const SystemException& ex)
     {
@@ -721,39 +726,51 @@ void VmSystemIOCloseFile::Execute(Frame& frame)
     }
 }
 
-class VmSystemIOWriteByteToFile : public VmFunction
+class VmSystemStringLastIndexOf : public VmFunction
 {
 public:
-    VmSystemIOWriteByteToFile(ConstantPool& constantPool);
+    VmSystemStringLastIndexOf(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemIOWriteByteToFile::VmSystemIOWriteByteToFile(ConstantPool& constantPool)
+VmSystemStringLastIndexOf::VmSystemStringLastIndexOf(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"fputb"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"strlastindexof"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemIOWriteByteToFile::Execute(Frame& frame)
+void VmSystemStringLastIndexOf::Execute(Frame& frame)
 {
     try
     {
-        IntegralValue fileHandleValue = frame.Local(0).GetValue();
-        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
-        int32_t fileHandle = fileHandleValue.AsInt();
-        IntegralValue byteValue = frame.Local(1).GetValue();
-        Assert(byteValue.GetType() == ValueType::byteType, "byte expected");
-        uint8_t value = byteValue.AsByte();
-        WriteByteToFile(fileHandle, value);
+        IntegralValue strValue = frame.Local(0).GetValue();
+        Assert(strValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference str(strValue.Value());
+        IntegralValue cValue = frame.Local(1).GetValue();
+        Assert(cValue.GetType() == ValueType::charType, "char expected");
+        char32_t c = cValue.AsChar();
+        IntegralValue startValue = frame.Local(2).GetValue();
+        Assert(startValue.GetType() == ValueType::intType, "int expected");
+        int32_t start = startValue.AsInt();
+        int32_t result = StringLastIndexOf(str, c, start);
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(result, ValueType::intType));
     }
-    catch (const FileSystemError& ex)
+    catch (const NullReferenceException& ex)
     {
         if (RunningNativeCode())
         {
             throw;
         }
-        ThrowFileSystemException(ex, frame);
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
     }
     catch (const SystemException& ex)
     {
@@ -765,35 +782,35 @@ void VmSystemIOWriteByteToFile::Execute(Frame& frame)
     }
 }
 
-class VmSystemIOWriteFile : public VmFunction
+class VmSystemStringIndexOfAny : public VmFunction
 {
 public:
-    VmSystemIOWriteFile(ConstantPool& constantPool);
+    VmSystemStringIndexOfAny(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemIOWriteFile::VmSystemIOWriteFile(ConstantPool& constantPool)
+VmSystemStringIndexOfAny::VmSystemStringIndexOfAny(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"fwrite"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"strindexofany"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemIOWriteFile::Execute(Frame& frame)
+void VmSystemStringIndexOfAny::Execute(Frame& frame)
 {
     try
     {
-        IntegralValue fileHandleValue = frame.Local(0).GetValue();
-        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
-        int32_t fileHandle = fileHandleValue.AsInt();
-        IntegralValue bufferValue = frame.Local(1).GetValue();
-        Assert(bufferValue.GetType() == ValueType::objectReference, "object reference expected");
-        ObjectReference buffer(bufferValue.Value());
-        std::vector<uint8_t> bytes = GetManagedMemoryPool().GetBytes(buffer);
-        IntegralValue countValue = frame.Local(2).GetValue();
-        Assert(countValue.GetType() == ValueType::intType, "int expected");
-        int32_t count = countValue.AsInt();
-        WriteFile(fileHandle, &bytes[0], count);
+        IntegralValue strValue = frame.Local(0).GetValue();
+        Assert(strValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference str(strValue.Value());
+        IntegralValue charsValue = frame.Local(1).GetValue();
+        Assert(charsValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference chars(charsValue.Value());
+        IntegralValue startValue = frame.Local(2).GetValue();
+        Assert(startValue.GetType() == ValueType::intType, "int expected");
+        int32_t start = startValue.AsInt();
+        int32_t result = StringIndexOfAny(str, chars, start);
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(result, ValueType::intType));
     }
     catch (const NullReferenceException& ex)
     {
@@ -811,14 +828,6 @@ void VmSystemIOWriteFile::Execute(Frame& frame)
         }
         ThrowIndexOutOfRangeException(ex, frame);
     }
-    catch (const FileSystemError& ex)
-    {
-        if (RunningNativeCode())
-        {
-            throw;
-        }
-        ThrowFileSystemException(ex, frame);
-    }
     catch (const SystemException& ex)
     {
         if (RunningNativeCode())
@@ -829,37 +838,51 @@ void VmSystemIOWriteFile::Execute(Frame& frame)
     }
 }
 
-class VmSystemIOReadByteFromFile : public VmFunction
+class VmSystemStringLastIndexOfAny : public VmFunction
 {
 public:
-    VmSystemIOReadByteFromFile(ConstantPool& constantPool);
+    VmSystemStringLastIndexOfAny(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemIOReadByteFromFile::VmSystemIOReadByteFromFile(ConstantPool& constantPool)
+VmSystemStringLastIndexOfAny::VmSystemStringLastIndexOfAny(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"fgetb"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"strlastindexofany"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemIOReadByteFromFile::Execute(Frame& frame)
+void VmSystemStringLastIndexOfAny::Execute(Frame& frame)
 {
     try
     {
-        IntegralValue fileHandleValue = frame.Local(0).GetValue();
-        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
-        int32_t fileHandle = fileHandleValue.AsInt();
-        int32_t value = ReadByteFromFile(fileHandle);
-        frame.OpStack().Push(MakeIntegralValue<int32_t>(value, ValueType::intType));
+        IntegralValue strValue = frame.Local(0).GetValue();
+        Assert(strValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference str(strValue.Value());
+        IntegralValue charsValue = frame.Local(1).GetValue();
+        Assert(charsValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference chars(charsValue.Value());
+        IntegralValue startValue = frame.Local(2).GetValue();
+        Assert(startValue.GetType() == ValueType::intType, "int expected");
+        int32_t start = startValue.AsInt();
+        int32_t result = StringLastIndexOfAny(str, chars, start);
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(result, ValueType::intType));
     }
-    catch (const FileSystemError& ex)
+    catch (const NullReferenceException& ex)
     {
         if (RunningNativeCode())
         {
             throw;
         }
-        ThrowFileSystemException(ex, frame);
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
     }
     catch (const SystemException& ex)
     {
@@ -871,39 +894,32 @@ void VmSystemIOReadByteFromFile::Execute(Frame& frame)
     }
 }
 
-class VmSystemIOReadFile : public VmFunction
+class VmSystemStringStartsWith : public VmFunction
 {
 public:
-    VmSystemIOReadFile(ConstantPool& constantPool);
+    VmSystemStringStartsWith(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemIOReadFile::VmSystemIOReadFile(ConstantPool& constantPool)
+VmSystemStringStartsWith::VmSystemStringStartsWith(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"fread"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"strstartswith"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemIOReadFile::Execute(Frame& frame)
+void VmSystemStringStartsWith::Execute(Frame& frame)
 {
     try
     {
-        IntegralValue fileHandleValue = frame.Local(0).GetValue();
-        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
-        int32_t fileHandle = fileHandleValue.AsInt();
-        IntegralValue bufferValue = frame.Local(1).GetValue();
-        Assert(bufferValue.GetType() == ValueType::objectReference, "object reference expected");
-        ObjectReference buffer(bufferValue.Value());
-        std::vector<uint8_t> bytes;
-        ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
-        bytes.resize(memoryPool.GetNumArrayElements(buffer));
-        int32_t result = ReadFile(fileHandle, &bytes[0], int32_t(bytes.size()));
-        if (result > 0)
-        {
-            memoryPool.SetBytes(buffer, bytes, result);
-        }
-        frame.OpStack().Push(MakeIntegralValue<int32_t>(result, ValueType::intType));
+        IntegralValue strValue = frame.Local(0).GetValue();
+        Assert(strValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference str(strValue.Value());
+        IntegralValue prefixValue = frame.Local(1).GetValue();
+        Assert(prefixValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference prefix(prefixValue.Value());
+        bool result = StringStartsWith(str, prefix);
+        frame.OpStack().Push(MakeIntegralValue<bool>(result, ValueType::boolType));
     }
     catch (const NullReferenceException& ex)
     {
@@ -921,14 +937,6 @@ void VmSystemIOReadFile::Execute(Frame& frame)
         }
         ThrowIndexOutOfRangeException(ex, frame);
     }
-    catch (const FileSystemError& ex)
-    {
-        if (RunningNativeCode())
-        {
-            throw;
-        }
-        ThrowFileSystemException(ex, frame);
-    }
     catch (const SystemException& ex)
     {
         if (RunningNativeCode())
@@ -939,102 +947,85 @@ void VmSystemIOReadFile::Execute(Frame& frame)
     }
 }
 
-class VmSystemIOSeekFile : public VmFunction
+class VmSystemStringEndsWith : public VmFunction
 {
 public:
-    VmSystemIOSeekFile(ConstantPool& constantPool);
+    VmSystemStringEndsWith(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemIOSeekFile::VmSystemIOSeekFile(ConstantPool& constantPool)
+VmSystemStringEndsWith::VmSystemStringEndsWith(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"fseek"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"strendswith"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemIOSeekFile::Execute(Frame& frame)
+void VmSystemStringEndsWith::Execute(Frame& frame)
 {
     try
     {
-        IntegralValue fileHandleValue = frame.Local(0).GetValue();
-        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
-        int32_t fileHandle = fileHandleValue.AsInt();
-        IntegralValue posValue = frame.Local(1).GetValue();
-        Assert(posValue.GetType() == ValueType::intType, "int expected");
-        int32_t pos = posValue.AsInt();
-        IntegralValue originValue = frame.Local(2).GetValue();
-        Assert(originValue.GetType() == ValueType::byteType, "byte expected");
-        SeekFile(fileHandle, pos, Origin(originValue.AsByte()));
+        IntegralValue strValue = frame.Local(0).GetValue();
+        Assert(strValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference str(strValue.Value());
+        IntegralValue suffixValue = frame.Local(1).GetValue();
+        Assert(suffixValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference suffix(suffixValue.Value());
+        bool result = StringEndsWith(str, suffix);
+        frame.OpStack().Push(MakeIntegralValue<bool>(result, ValueType::boolType));
     }
-    catch (const FileSystemError& ex)
+    catch (const NullReferenceException& ex)
     {
         if (RunningNativeCode())
         {
             throw;
         }
-        ThrowFileSystemException(ex, frame);
+        ThrowNullReferenceException(ex, frame);
     }
-}
-
-class VmSystemIOTellFile : public VmFunction
-{
-public:
-    VmSystemIOTellFile(ConstantPool& constantPool);
-    void Execute(Frame& frame) override;
-};
-
-VmSystemIOTellFile::VmSystemIOTellFile(ConstantPool& constantPool)
-{
-    Constant name = constantPool.GetConstant(constantPool.Install(U"ftell"));
-    SetName(name);
-    VmFunctionTable::RegisterVmFunction(this);
-}
-
-void VmSystemIOTellFile::Execute(Frame& frame)
-{
-    try
+    catch (const IndexOutOfRangeException& ex)
     {
-        IntegralValue fileHandleValue = frame.Local(0).GetValue();
-        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
-        int32_t fileHandle = fileHandleValue.AsInt();
-        int32_t filePos = TellFile(fileHandle);
-        frame.OpStack().Push(MakeIntegralValue<int32_t>(filePos, ValueType::intType));
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
     }
-    catch (const FileSystemError& ex)
+    catch (const SystemException& ex)
     {
         if (RunningNativeCode())
         {
             throw;
         }
-        ThrowFileSystemException(ex, frame);
+        ThrowSystemException(ex, frame);
     }
 }
 
-class VmSystemIOFileExists : public VmFunction
+class VmSystemStringEqual : public VmFunction
 {
 public:
-    VmSystemIOFileExists(ConstantPool& constantPool);
+    VmSystemStringEqual(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemIOFileExists::VmSystemIOFileExists(ConstantPool& constantPool)
+VmSystemStringEqual::VmSystemStringEqual(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"fexists"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"streq"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemIOFileExists::Execute(Frame& frame)
+void VmSystemStringEqual::Execute(Frame& frame)
 {
     try
     {
-        IntegralValue filePathValue = frame.Local(0).GetValue();
-        Assert(filePathValue.GetType() == ValueType::objectReference, "object reference expected");
-        ObjectReference filePathStr(filePathValue.Value());
-        std::string filePath = GetManagedMemoryPool().GetUtf8String(filePathStr);
-        bool exists = boost::filesystem::exists(filePath);
-        frame.OpStack().Push(MakeIntegralValue<bool>(exists, ValueType::boolType));
+        IntegralValue leftValue = frame.Local(0).GetValue();
+        Assert(leftValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference left(leftValue.Value());
+        IntegralValue rightValue = frame.Local(1).GetValue();
+        Assert(rightValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference right(rightValue.Value());
+        bool result = StringEqual(left, right);
+        frame.OpStack().Push(MakeIntegralValue<bool>(result, ValueType::boolType));
     }
     catch (const NullReferenceException& ex)
     {
@@ -1044,6 +1035,14 @@ void VmSystemIOFileExists::Execute(Frame& frame)
         }
         ThrowNullReferenceException(ex, frame);
     }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
     catch (const SystemException& ex)
     {
         if (RunningNativeCode())
@@ -1054,35 +1053,32 @@ void VmSystemIOFileExists::Execute(Frame& frame)
     }
 }
 
-class VmSystemIOLastWriteTimeLess : public VmFunction
+class VmSystemStringLess : public VmFunction
 {
 public:
-    VmSystemIOLastWriteTimeLess(ConstantPool& constantPool);
+    VmSystemStringLess(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemIOLastWriteTimeLess::VmSystemIOLastWriteTimeLess(ConstantPool& constantPool)
+VmSystemStringLess::VmSystemStringLess(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"writetimeless"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"strless"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemIOLastWriteTimeLess::Execute(Frame& frame)
+void VmSystemStringLess::Execute(Frame& frame)
 {
     try
     {
-        IntegralValue firstFilePathValue = frame.Local(0).GetValue();
-        Assert(firstFilePathValue.GetType() == ValueType::objectReference, "object reference expected");
-        ObjectReference firstFilePathStr(firstFilePathValue.Value());
-        ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
-        std::string firstFilePath = memoryPool.GetUtf8String(firstFilePathStr);
-        IntegralValue secondFilePathValue = frame.Local(1).GetValue();
-        Assert(secondFilePathValue.GetType() == ValueType::objectReference, "object reference expected");
-        ObjectReference secondFilePathStr(secondFilePathValue.Value());
-        std::string secondFilePath = memoryPool.GetUtf8String(secondFilePathStr);
-        bool less = boost::filesystem::last_write_time(firstFilePath) < boost::filesystem::last_write_time(secondFilePath);
-        frame.OpStack().Push(MakeIntegralValue<bool>(less, ValueType::boolType));
+        IntegralValue leftValue = frame.Local(0).GetValue();
+        Assert(leftValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference left(leftValue.Value());
+        IntegralValue rightValue = frame.Local(1).GetValue();
+        Assert(rightValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference right(rightValue.Value());
+        bool result = StringLess(left, right);
+        frame.OpStack().Push(MakeIntegralValue<bool>(result, ValueType::boolType));
     }
     catch (const NullReferenceException& ex)
     {
@@ -1092,6 +1088,14 @@ void VmSystemIOLastWriteTimeLess::Execute(Frame& frame)
         }
         ThrowNullReferenceException(ex, frame);
     }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
     catch (const SystemException& ex)
     {
         if (RunningNativeCode())
@@ -1102,21 +1106,1745 @@ void VmSystemIOLastWriteTimeLess::Execute(Frame& frame)
     }
 }
 
-class VmSystemNetSocketsCreateSocket : public VmFunction
+class VmSystemStringGetHashCode : public VmFunction
 {
 public:
-    VmSystemNetSocketsCreateSocket(ConstantPool& constantPool);
+    VmSystemStringGetHashCode(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemNetSocketsCreateSocket::VmSystemNetSocketsCreateSocket(ConstantPool& constantPool)
+VmSystemStringGetHashCode::VmSystemStringGetHashCode(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"socket"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"strhash"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemNetSocketsCreateSocket::Execute(Frame& frame)
+void VmSystemStringGetHashCode::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue strValue = frame.Local(0).GetValue();
+        Assert(strValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference str(strValue.Value());
+        uint64_t hashCode = StringHashCode(str);
+        frame.OpStack().Push(MakeIntegralValue<uint64_t>(hashCode, ValueType::ulongType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemStringSubstring : public VmFunction
+{
+public:
+    VmSystemStringSubstring(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemStringSubstring::VmSystemStringSubstring(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"substring"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemStringSubstring::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue strValue = frame.Local(0).GetValue();
+        Assert(strValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference str(strValue.Value());
+        IntegralValue startValue = frame.Local(1).GetValue();
+        Assert(startValue.GetType() == ValueType::intType, "int expected");
+        int32_t start = startValue.AsInt();
+        IntegralValue lengthValue = frame.Local(2).GetValue();
+        Assert(lengthValue.GetType() == ValueType::intType, "int expected");
+        int32_t length = lengthValue.AsInt();
+        ObjectReference result = StringSubstring(frame.GetThread(), str, start, length);
+        frame.OpStack().Push(result);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemStringTrim : public VmFunction
+{
+public:
+    VmSystemStringTrim(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemStringTrim::VmSystemStringTrim(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"strtrim"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemStringTrim::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue strValue = frame.Local(0).GetValue();
+        Assert(strValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference str(strValue.Value());
+        ObjectReference result = StringTrim(frame.GetThread(), str);
+        frame.OpStack().Push(result);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+//  BlockingIoSetter puts the thread to the waiting state for the duration of a blocking I/O call, so that the call does not prevent garbage collection.
+//  The buffer of the call is pinned by a PinnedByteArray. When the call returns or throws, the thread waits until a collection that is in progress has finished.
+
+//  The members are destroyed in reverse order, so the thread leaves the waiting state before it waits for the collector to become idle.
+
+struct GcIdleWaiter
+{
+    GcIdleWaiter(Thread& thread_) : thread(thread_)
+    {
+    }
+    ~GcIdleWaiter()
+    {
+        GetMachine().GetGarbageCollector().WaitForIdle(thread);
+    }
+    Thread& thread;
+};
+
+struct BlockingIoSetter
+{
+    BlockingIoSetter(Thread& thread) : idleWaiter(thread), waiting(thread)
+    {
+    }
+    GcIdleWaiter idleWaiter;
+    WaitingSetter waiting;
+};
+
+class VmSystemStringConcat : public VmFunction
+{
+public:
+    VmSystemStringConcat(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemStringConcat::VmSystemStringConcat(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"strconcat"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemStringConcat::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue leftValue = frame.Local(0).GetValue();
+        Assert(leftValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference left(leftValue.Value());
+        IntegralValue rightValue = frame.Local(1).GetValue();
+        Assert(rightValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference right(rightValue.Value());
+        ObjectReference result = StringConcat(frame.GetThread(), left, right);
+        frame.OpStack().Push(result);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemStringFromUtf8 : public VmFunction
+{
+public:
+    VmSystemStringFromUtf8(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemStringFromUtf8::VmSystemStringFromUtf8(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"utf8decode"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemStringFromUtf8::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue bytesValue = frame.Local(0).GetValue();
+        Assert(bytesValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference bytes(bytesValue.Value());
+        IntegralValue offsetValue = frame.Local(1).GetValue();
+        Assert(offsetValue.GetType() == ValueType::intType, "int expected");
+        int32_t offset = offsetValue.AsInt();
+        IntegralValue countValue = frame.Local(2).GetValue();
+        Assert(countValue.GetType() == ValueType::intType, "int expected");
+        int32_t count = countValue.AsInt();
+        ObjectReference result = StringFromUtf8(frame.GetThread(), bytes, offset, count);
+        frame.OpStack().Push(result);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemStringUtf8Length : public VmFunction
+{
+public:
+    VmSystemStringUtf8Length(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemStringUtf8Length::VmSystemStringUtf8Length(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"utf8length"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemStringUtf8Length::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue strValue = frame.Local(0).GetValue();
+        Assert(strValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference str(strValue.Value());
+        int32_t length = StringUtf8Length(str);
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(length, ValueType::intType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemStringToUtf8 : public VmFunction
+{
+public:
+    VmSystemStringToUtf8(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemStringToUtf8::VmSystemStringToUtf8(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"utf8encode"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemStringToUtf8::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue strValue = frame.Local(0).GetValue();
+        Assert(strValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference str(strValue.Value());
+        IntegralValue bytesValue = frame.Local(1).GetValue();
+        Assert(bytesValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference bytes(bytesValue.Value());
+        IntegralValue offsetValue = frame.Local(2).GetValue();
+        Assert(offsetValue.GetType() == ValueType::intType, "int expected");
+        int32_t offset = offsetValue.AsInt();
+        int32_t length = StringToUtf8(str, bytes, offset);
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(length, ValueType::intType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemArrayCopy : public VmFunction
+{
+public:
+    VmSystemArrayCopy(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemArrayCopy::VmSystemArrayCopy(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"arrcopy"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemArrayCopy::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue sourceValue = frame.Local(0).GetValue();
+        Assert(sourceValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference source(sourceValue.Value());
+        IntegralValue sourceIndexValue = frame.Local(1).GetValue();
+        Assert(sourceIndexValue.GetType() == ValueType::intType, "int expected");
+        int32_t sourceIndex = sourceIndexValue.AsInt();
+        IntegralValue destinationValue = frame.Local(2).GetValue();
+        Assert(destinationValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference destination(destinationValue.Value());
+        IntegralValue destinationIndexValue = frame.Local(3).GetValue();
+        Assert(destinationIndexValue.GetType() == ValueType::intType, "int expected");
+        int32_t destinationIndex = destinationIndexValue.AsInt();
+        IntegralValue lengthValue = frame.Local(4).GetValue();
+        Assert(lengthValue.GetType() == ValueType::intType, "int expected");
+        int32_t length = lengthValue.AsInt();
+        ArrayCopy(source, sourceIndex, destination, destinationIndex, length);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
+    catch (const InvalidCastException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowInvalidCastException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemArrayFill : public VmFunction
+{
+public:
+    VmSystemArrayFill(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemArrayFill::VmSystemArrayFill(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"arrfill"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemArrayFill::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue arrValue = frame.Local(0).GetValue();
+        Assert(arrValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference arr(arrValue.Value());
+        IntegralValue valueValue = frame.Local(1).GetValue();
+        Assert(valueValue.GetType() == ValueType::ulongType, "ulong expected");
+        uint64_t value = valueValue.AsULong();
+        IntegralValue indexValue = frame.Local(2).GetValue();
+        Assert(indexValue.GetType() == ValueType::intType, "int expected");
+        int32_t index = indexValue.AsInt();
+        IntegralValue countValue = frame.Local(3).GetValue();
+        Assert(countValue.GetType() == ValueType::intType, "int expected");
+        int32_t count = countValue.AsInt();
+        ArrayFill(arr, value, index, count);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
+    catch (const InvalidCastException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowInvalidCastException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemArrayEqual : public VmFunction
+{
+public:
+    VmSystemArrayEqual(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemArrayEqual::VmSystemArrayEqual(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"arreq"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemArrayEqual::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue leftValue = frame.Local(0).GetValue();
+        Assert(leftValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference left(leftValue.Value());
+        IntegralValue rightValue = frame.Local(1).GetValue();
+        Assert(rightValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference right(rightValue.Value());
+        bool equal = ArrayEqual(left, right);
+        frame.OpStack().Push(MakeIntegralValue<bool>(equal, ValueType::boolType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemArrayIndexOf : public VmFunction
+{
+public:
+    VmSystemArrayIndexOf(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemArrayIndexOf::VmSystemArrayIndexOf(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"arrindexof"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemArrayIndexOf::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue arrValue = frame.Local(0).GetValue();
+        Assert(arrValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference arr(arrValue.Value());
+        IntegralValue valueValue = frame.Local(1).GetValue();
+        Assert(valueValue.GetType() == ValueType::ulongType, "ulong expected");
+        uint64_t value = valueValue.AsULong();
+        IntegralValue startValue = frame.Local(2).GetValue();
+        Assert(startValue.GetType() == ValueType::intType, "int expected");
+        int32_t start = startValue.AsInt();
+        IntegralValue countValue = frame.Local(3).GetValue();
+        Assert(countValue.GetType() == ValueType::intType, "int expected");
+        int32_t count = countValue.AsInt();
+        int32_t index = ArrayIndexOf(arr, value, start, count);
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(index, ValueType::intType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
+    catch (const InvalidCastException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowInvalidCastException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemArrayReverse : public VmFunction
+{
+public:
+    VmSystemArrayReverse(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemArrayReverse::VmSystemArrayReverse(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"arrreverse"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemArrayReverse::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue arrValue = frame.Local(0).GetValue();
+        Assert(arrValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference arr(arrValue.Value());
+        IntegralValue indexValue = frame.Local(1).GetValue();
+        Assert(indexValue.GetType() == ValueType::intType, "int expected");
+        int32_t index = indexValue.AsInt();
+        IntegralValue countValue = frame.Local(2).GetValue();
+        Assert(countValue.GetType() == ValueType::intType, "int expected");
+        int32_t count = countValue.AsInt();
+        ArrayReverse(arr, index, count);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemArraySort : public VmFunction
+{
+public:
+    VmSystemArraySort(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemArraySort::VmSystemArraySort(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"arrsort"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemArraySort::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue arrValue = frame.Local(0).GetValue();
+        Assert(arrValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference arr(arrValue.Value());
+        IntegralValue indexValue = frame.Local(1).GetValue();
+        Assert(indexValue.GetType() == ValueType::intType, "int expected");
+        int32_t index = indexValue.AsInt();
+        IntegralValue countValue = frame.Local(2).GetValue();
+        Assert(countValue.GetType() == ValueType::intType, "int expected");
+        int32_t count = countValue.AsInt();
+        IntegralValue parallelValue = frame.Local(3).GetValue();
+        Assert(parallelValue.GetType() == ValueType::boolType, "bool expected");
+        bool parallel = parallelValue.AsBool();
+        bool sorted = ArraySort(frame.GetThread(), arr, index, count, parallel);
+        frame.OpStack().Push(MakeIntegralValue<bool>(sorted, ValueType::boolType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOOpenFile : public VmFunction
+{
+public:
+    VmSystemIOOpenFile(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOOpenFile::VmSystemIOOpenFile(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"fopen"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOOpenFile::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue filePathValue = frame.Local(0).GetValue();
+        Assert(filePathValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference filePathStr(filePathValue.Value());
+        std::string filePath = GetManagedMemoryPool().GetUtf8String(filePathStr);
+        IntegralValue modeValue = frame.Local(1).GetValue();
+        Assert(modeValue.GetType() == ValueType::byteType, "byte expected");
+        FileMode mode = static_cast<FileMode>(modeValue.AsByte());
+        IntegralValue accessValue = frame.Local(2).GetValue();
+        Assert(accessValue.GetType() == ValueType::byteType, "byte expected");
+        FileAccess access = static_cast<FileAccess>(accessValue.AsByte());
+        int32_t fileHandle = OpenFile(filePath, mode, access);
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(fileHandle, ValueType::intType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOCloseFile : public VmFunction
+{
+public:
+    VmSystemIOCloseFile(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOCloseFile::VmSystemIOCloseFile(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"fclose"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOCloseFile::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue fileHandleValue = frame.Local(0).GetValue();
+        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t fileHandle = fileHandleValue.AsInt();
+        CloseFile(fileHandle);
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOWriteByteToFile : public VmFunction
+{
+public:
+    VmSystemIOWriteByteToFile(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOWriteByteToFile::VmSystemIOWriteByteToFile(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"fputb"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOWriteByteToFile::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue fileHandleValue = frame.Local(0).GetValue();
+        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t fileHandle = fileHandleValue.AsInt();
+        IntegralValue byteValue = frame.Local(1).GetValue();
+        Assert(byteValue.GetType() == ValueType::byteType, "byte expected");
+        uint8_t value = byteValue.AsByte();
+        WriteByteToFile(fileHandle, value);
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOWriteFile : public VmFunction
+{
+public:
+    VmSystemIOWriteFile(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOWriteFile::VmSystemIOWriteFile(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"fwrite"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOWriteFile::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue fileHandleValue = frame.Local(0).GetValue();
+        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t fileHandle = fileHandleValue.AsInt();
+        IntegralValue bufferValue = frame.Local(1).GetValue();
+        Assert(bufferValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference buffer(bufferValue.Value());
+        IntegralValue countValue = frame.Local(2).GetValue();
+        Assert(countValue.GetType() == ValueType::intType, "int expected");
+        int32_t count = countValue.AsInt();
+        Thread& thread = frame.GetThread();
+        PinnedByteArray bytes(thread, buffer);
+        bytes.CheckRange(0, count);
+        BlockingIoSetter blocking(thread);
+        WriteFile(fileHandle, bytes.Bytes(), count);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOWriteFileRange : public VmFunction
+{
+public:
+    VmSystemIOWriteFileRange(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOWriteFileRange::VmSystemIOWriteFileRange(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"fwriterange"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOWriteFileRange::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue fileHandleValue = frame.Local(0).GetValue();
+        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t fileHandle = fileHandleValue.AsInt();
+        IntegralValue bufferValue = frame.Local(1).GetValue();
+        Assert(bufferValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference buffer(bufferValue.Value());
+        IntegralValue offsetValue = frame.Local(2).GetValue();
+        Assert(offsetValue.GetType() == ValueType::intType, "int expected");
+        int32_t offset = offsetValue.AsInt();
+        IntegralValue countValue = frame.Local(3).GetValue();
+        Assert(countValue.GetType() == ValueType::intType, "int expected");
+        int32_t count = countValue.AsInt();
+        Thread& thread = frame.GetThread();
+        PinnedByteArray bytes(thread, buffer);
+        bytes.CheckRange(offset, count);
+        BlockingIoSetter blocking(thread);
+        WriteFile(fileHandle, bytes.Bytes() + offset, count);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOReadByteFromFile : public VmFunction
+{
+public:
+    VmSystemIOReadByteFromFile(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOReadByteFromFile::VmSystemIOReadByteFromFile(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"fgetb"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOReadByteFromFile::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue fileHandleValue = frame.Local(0).GetValue();
+        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t fileHandle = fileHandleValue.AsInt();
+        int32_t value = ReadByteFromFile(fileHandle);
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(value, ValueType::intType));
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOReadFile : public VmFunction
+{
+public:
+    VmSystemIOReadFile(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOReadFile::VmSystemIOReadFile(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"fread"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOReadFile::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue fileHandleValue = frame.Local(0).GetValue();
+        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t fileHandle = fileHandleValue.AsInt();
+        IntegralValue bufferValue = frame.Local(1).GetValue();
+        Assert(bufferValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference buffer(bufferValue.Value());
+        Thread& thread = frame.GetThread();
+        int32_t result = 0;
+        {
+            PinnedByteArray bytes(thread, buffer);
+            BlockingIoSetter blocking(thread);
+            result = ReadFile(fileHandle, bytes.Bytes(), bytes.Length());
+        }
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(result, ValueType::intType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOReadFileRange : public VmFunction
+{
+public:
+    VmSystemIOReadFileRange(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOReadFileRange::VmSystemIOReadFileRange(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"freadrange"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOReadFileRange::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue fileHandleValue = frame.Local(0).GetValue();
+        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t fileHandle = fileHandleValue.AsInt();
+        IntegralValue bufferValue = frame.Local(1).GetValue();
+        Assert(bufferValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference buffer(bufferValue.Value());
+        IntegralValue offsetValue = frame.Local(2).GetValue();
+        Assert(offsetValue.GetType() == ValueType::intType, "int expected");
+        int32_t offset = offsetValue.AsInt();
+        IntegralValue countValue = frame.Local(3).GetValue();
+        Assert(countValue.GetType() == ValueType::intType, "int expected");
+        int32_t count = countValue.AsInt();
+        Thread& thread = frame.GetThread();
+        int32_t result = 0;
+        {
+            PinnedByteArray bytes(thread, buffer);
+            bytes.CheckRange(offset, count);
+            BlockingIoSetter blocking(thread);
+            result = ReadFile(fileHandle, bytes.Bytes() + offset, count);
+        }
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(result, ValueType::intType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOSeekFile : public VmFunction
+{
+public:
+    VmSystemIOSeekFile(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOSeekFile::VmSystemIOSeekFile(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"fseek"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOSeekFile::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue fileHandleValue = frame.Local(0).GetValue();
+        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t fileHandle = fileHandleValue.AsInt();
+        IntegralValue posValue = frame.Local(1).GetValue();
+        Assert(posValue.GetType() == ValueType::intType, "int expected");
+        int32_t pos = posValue.AsInt();
+        IntegralValue originValue = frame.Local(2).GetValue();
+        Assert(originValue.GetType() == ValueType::byteType, "byte expected");
+        SeekFile(fileHandle, pos, Origin(originValue.AsByte()));
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOTellFile : public VmFunction
+{
+public:
+    VmSystemIOTellFile(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOTellFile::VmSystemIOTellFile(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"ftell"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOTellFile::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue fileHandleValue = frame.Local(0).GetValue();
+        Assert(fileHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t fileHandle = fileHandleValue.AsInt();
+        int32_t filePos = TellFile(fileHandle);
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(filePos, ValueType::intType));
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOFileExists : public VmFunction
+{
+public:
+    VmSystemIOFileExists(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOFileExists::VmSystemIOFileExists(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"fexists"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOFileExists::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue filePathValue = frame.Local(0).GetValue();
+        Assert(filePathValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference filePathStr(filePathValue.Value());
+        std::string filePath = GetManagedMemoryPool().GetUtf8String(filePathStr);
+        bool exists = boost::filesystem::exists(filePath);
+        frame.OpStack().Push(MakeIntegralValue<bool>(exists, ValueType::boolType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOLastWriteTimeLess : public VmFunction
+{
+public:
+    VmSystemIOLastWriteTimeLess(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOLastWriteTimeLess::VmSystemIOLastWriteTimeLess(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"writetimeless"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOLastWriteTimeLess::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue firstFilePathValue = frame.Local(0).GetValue();
+        Assert(firstFilePathValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference firstFilePathStr(firstFilePathValue.Value());
+        ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+        std::string firstFilePath = memoryPool.GetUtf8String(firstFilePathStr);
+        IntegralValue secondFilePathValue = frame.Local(1).GetValue();
+        Assert(secondFilePathValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference secondFilePathStr(secondFilePathValue.Value());
+        std::string secondFilePath = memoryPool.GetUtf8String(secondFilePathStr);
+        bool less = boost::filesystem::last_write_time(firstFilePath) < boost::filesystem::last_write_time(secondFilePath);
+        frame.OpStack().Push(MakeIntegralValue<bool>(less, ValueType::boolType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOOpenMappedFile : public VmFunction
+{
+public:
+    VmSystemIOOpenMappedFile(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOOpenMappedFile::VmSystemIOOpenMappedFile(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"mmapopen"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOOpenMappedFile::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue filePathValue = frame.Local(0).GetValue();
+        Assert(filePathValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference filePathStr(filePathValue.Value());
+        std::string filePath = GetManagedMemoryPool().GetUtf8String(filePathStr);
+        int32_t mappedFileHandle = OpenMappedFile(filePath);
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(mappedFileHandle, ValueType::intType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOCloseMappedFile : public VmFunction
+{
+public:
+    VmSystemIOCloseMappedFile(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOCloseMappedFile::VmSystemIOCloseMappedFile(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"mmapclose"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOCloseMappedFile::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue mappedFileHandleValue = frame.Local(0).GetValue();
+        Assert(mappedFileHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t mappedFileHandle = mappedFileHandleValue.AsInt();
+        CloseMappedFile(mappedFileHandle);
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOGetMappedFileLength : public VmFunction
+{
+public:
+    VmSystemIOGetMappedFileLength(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOGetMappedFileLength::VmSystemIOGetMappedFileLength(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"mmaplength"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOGetMappedFileLength::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue mappedFileHandleValue = frame.Local(0).GetValue();
+        Assert(mappedFileHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t mappedFileHandle = mappedFileHandleValue.AsInt();
+        int64_t length = GetMappedFileLength(mappedFileHandle);
+        frame.OpStack().Push(MakeIntegralValue<int64_t>(length, ValueType::longType));
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOGetMappedFileAddress : public VmFunction
+{
+public:
+    VmSystemIOGetMappedFileAddress(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOGetMappedFileAddress::VmSystemIOGetMappedFileAddress(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"mmapaddress"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOGetMappedFileAddress::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue mappedFileHandleValue = frame.Local(0).GetValue();
+        Assert(mappedFileHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t mappedFileHandle = mappedFileHandleValue.AsInt();
+        uint64_t address = reinterpret_cast<uint64_t>(GetMappedFileData(mappedFileHandle));
+        frame.OpStack().Push(MakeIntegralValue<uint64_t>(address, ValueType::ulongType));
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+//  The managed accessors check the index against the length of the mapping before they call these functions.
+
+class VmSystemIOLoadMappedByte : public VmFunction
+{
+public:
+    VmSystemIOLoadMappedByte(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOLoadMappedByte::VmSystemIOLoadMappedByte(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"mmapbyte"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOLoadMappedByte::Execute(Frame& frame)
+{
+    IntegralValue addressValue = frame.Local(0).GetValue();
+    Assert(addressValue.GetType() == ValueType::ulongType, "ulong expected");
+    IntegralValue indexValue = frame.Local(1).GetValue();
+    Assert(indexValue.GetType() == ValueType::longType, "long expected");
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(addressValue.AsULong());
+    frame.OpStack().Push(MakeIntegralValue<uint8_t>(data[indexValue.AsLong()], ValueType::byteType));
+}
+
+class VmSystemIOLoadMappedInt : public VmFunction
+{
+public:
+    VmSystemIOLoadMappedInt(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOLoadMappedInt::VmSystemIOLoadMappedInt(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"mmapint"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOLoadMappedInt::Execute(Frame& frame)
+{
+    IntegralValue addressValue = frame.Local(0).GetValue();
+    Assert(addressValue.GetType() == ValueType::ulongType, "ulong expected");
+    IntegralValue indexValue = frame.Local(1).GetValue();
+    Assert(indexValue.GetType() == ValueType::longType, "long expected");
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(addressValue.AsULong());
+    int32_t value = 0;
+    std::memcpy(&value, data + indexValue.AsLong(), sizeof(value));
+    frame.OpStack().Push(MakeIntegralValue<int32_t>(value, ValueType::intType));
+}
+
+class VmSystemIOReadMappedFile : public VmFunction
+{
+public:
+    VmSystemIOReadMappedFile(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOReadMappedFile::VmSystemIOReadMappedFile(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"mmapread"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOReadMappedFile::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue mappedFileHandleValue = frame.Local(0).GetValue();
+        Assert(mappedFileHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t mappedFileHandle = mappedFileHandleValue.AsInt();
+        IntegralValue positionValue = frame.Local(1).GetValue();
+        Assert(positionValue.GetType() == ValueType::longType, "long expected");
+        int64_t position = positionValue.AsLong();
+        IntegralValue bufferValue = frame.Local(2).GetValue();
+        Assert(bufferValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference buffer(bufferValue.Value());
+        IntegralValue offsetValue = frame.Local(3).GetValue();
+        Assert(offsetValue.GetType() == ValueType::intType, "int expected");
+        int32_t offset = offsetValue.AsInt();
+        IntegralValue countValue = frame.Local(4).GetValue();
+        Assert(countValue.GetType() == ValueType::intType, "int expected");
+        int32_t count = countValue.AsInt();
+        Thread& thread = frame.GetThread();
+        int32_t bytesRead = 0;
+        {
+            PinnedByteArray bytes(thread, buffer);
+            bytes.CheckRange(offset, count);
+            BlockingIoSetter blocking(thread);
+            bytesRead = ReadMappedFile(mappedFileHandle, position, bytes.Bytes() + offset, count);
+        }
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(bytesRead, ValueType::intType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemIOMappedFileIndexOf : public VmFunction
+{
+public:
+    VmSystemIOMappedFileIndexOf(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemIOMappedFileIndexOf::VmSystemIOMappedFileIndexOf(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"mmapindexof"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemIOMappedFileIndexOf::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue mappedFileHandleValue = frame.Local(0).GetValue();
+        Assert(mappedFileHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t mappedFileHandle = mappedFileHandleValue.AsInt();
+        IntegralValue byteValue = frame.Local(1).GetValue();
+        Assert(byteValue.GetType() == ValueType::byteType, "byte expected");
+        uint8_t value = byteValue.AsByte();
+        IntegralValue startValue = frame.Local(2).GetValue();
+        Assert(startValue.GetType() == ValueType::longType, "long expected");
+        int64_t start = startValue.AsLong();
+        int64_t index = -1;
+        {
+            BlockingIoSetter blocking(frame.GetThread());
+            index = MappedFileIndexOf(mappedFileHandle, value, start);
+        }
+        frame.OpStack().Push(MakeIntegralValue<int64_t>(index, ValueType::longType));
+    }
+    catch (const FileSystemError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowFileSystemException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemNetSocketsCreateSocket : public VmFunction
+{
+public:
+    VmSystemNetSocketsCreateSocket(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemNetSocketsCreateSocket::VmSystemNetSocketsCreateSocket(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"socket"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemNetSocketsCreateSocket::Execute(Frame& frame)
 {
     try
     {
@@ -1149,33 +2877,351 @@ void VmSystemNetSocketsCreateSocket::Execute(Frame& frame)
     }
 }
 
-class VmSystemNetSocketsConnectSocket : public VmFunction
+class VmSystemNetSocketsConnectSocket : public VmFunction
+{
+public:
+    VmSystemNetSocketsConnectSocket(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemNetSocketsConnectSocket::VmSystemNetSocketsConnectSocket(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"connect"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemNetSocketsConnectSocket::Execute(Frame& frame)
+{
+    try
+    {
+        ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+        IntegralValue nodeValue = frame.Local(0).GetValue();
+        Assert(nodeValue.GetType() == ValueType::objectReference, "object reference expected");
+        std::string node = memoryPool.GetUtf8String(nodeValue.Value());
+        IntegralValue serviceValue = frame.Local(1).GetValue();
+        Assert(serviceValue.GetType() == ValueType::objectReference, "object reference expected");
+        std::string service = memoryPool.GetUtf8String(serviceValue.Value());
+        int32_t socketHandle = ConnectSocket(node, service);
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(socketHandle, ValueType::intType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const SocketError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSocketException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemNetSocketsCloseSocket : public VmFunction
+{
+public:
+    VmSystemNetSocketsCloseSocket(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemNetSocketsCloseSocket::VmSystemNetSocketsCloseSocket(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"closesocket"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemNetSocketsCloseSocket::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue socketValue = frame.Local(0).GetValue();
+        Assert(socketValue.GetType() == ValueType::intType, "int expected");
+        int32_t socketHandle = socketValue.AsInt();
+        CloseSocket(socketHandle);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const SocketError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSocketException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemNetSocketsBindSocket : public VmFunction
+{
+public:
+    VmSystemNetSocketsBindSocket(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemNetSocketsBindSocket::VmSystemNetSocketsBindSocket(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"bind"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemNetSocketsBindSocket::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue socketValue = frame.Local(0).GetValue();
+        Assert(socketValue.GetType() == ValueType::intType, "int expected");
+        int32_t socketHandle = socketValue.AsInt();
+        IntegralValue portValue = frame.Local(1).GetValue();
+        Assert(portValue.GetType() == ValueType::intType, "int expected");
+        int port = portValue.AsInt();
+        BindSocket(socketHandle, port);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const SocketError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSocketException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemNetSocketsListenSocket : public VmFunction
+{
+public:
+    VmSystemNetSocketsListenSocket(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemNetSocketsListenSocket::VmSystemNetSocketsListenSocket(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"listen"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemNetSocketsListenSocket::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue socketValue = frame.Local(0).GetValue();
+        Assert(socketValue.GetType() == ValueType::intType, "int expected");
+        int32_t socketHandle = socketValue.AsInt();
+        IntegralValue backlogValue = frame.Local(1).GetValue();
+        Assert(backlogValue.GetType() == ValueType::intType, "int expected");
+        int backlog = backlogValue.AsInt();
+        ListenSocket(socketHandle, backlog);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const SocketError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSocketException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemNetSocketsAcceptSocket : public VmFunction
+{
+public:
+    VmSystemNetSocketsAcceptSocket(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemNetSocketsAcceptSocket::VmSystemNetSocketsAcceptSocket(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"accept"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemNetSocketsAcceptSocket::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue socketValue = frame.Local(0).GetValue();
+        Assert(socketValue.GetType() == ValueType::intType, "int expected");
+        int32_t socketHandle = socketValue.AsInt();
+        int32_t acceptedSocketHandle = AcceptSocket(socketHandle);
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(acceptedSocketHandle, ValueType::intType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const SocketError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSocketException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemNetSocketsShutdownSocket : public VmFunction
+{
+public:
+    VmSystemNetSocketsShutdownSocket(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemNetSocketsShutdownSocket::VmSystemNetSocketsShutdownSocket(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"shutdown"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemNetSocketsShutdownSocket::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue socketValue = frame.Local(0).GetValue();
+        Assert(socketValue.GetType() == ValueType::intType, "int expected");
+        int32_t socketHandle = socketValue.AsInt();
+        IntegralValue modeValue = frame.Local(1).GetValue();
+        Assert(modeValue.GetType() == ValueType::byteType, "byte expected");
+        ShutdownMode mode = static_cast<ShutdownMode>(modeValue.AsByte());
+        ShutdownSocket(socketHandle, mode);
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const SocketError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSocketException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemNetSocketsSendSocket : public VmFunction
 {
 public:
-    VmSystemNetSocketsConnectSocket(ConstantPool& constantPool);
+    VmSystemNetSocketsSendSocket(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemNetSocketsConnectSocket::VmSystemNetSocketsConnectSocket(ConstantPool& constantPool)
+VmSystemNetSocketsSendSocket::VmSystemNetSocketsSendSocket(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"connect"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"send"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemNetSocketsConnectSocket::Execute(Frame& frame)
+void VmSystemNetSocketsSendSocket::Execute(Frame& frame)
 {
     try
     {
-        ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
-        IntegralValue nodeValue = frame.Local(0).GetValue();
-        Assert(nodeValue.GetType() == ValueType::objectReference, "object reference expected");
-        std::string node = memoryPool.GetUtf8String(nodeValue.Value());
-        IntegralValue serviceValue = frame.Local(1).GetValue();
-        Assert(serviceValue.GetType() == ValueType::objectReference, "object reference expected");
-        std::string service = memoryPool.GetUtf8String(serviceValue.Value());
-        int32_t socketHandle = ConnectSocket(node, service);
-        frame.OpStack().Push(MakeIntegralValue<int32_t>(socketHandle, ValueType::intType));
+        IntegralValue socketValue = frame.Local(0).GetValue();
+        Assert(socketValue.GetType() == ValueType::intType, "int expected");
+        int32_t socketHandle = socketValue.AsInt();
+        IntegralValue bufferValue = frame.Local(1).GetValue();
+        Assert(bufferValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference buffer(bufferValue.Value());
+        IntegralValue countValue = frame.Local(2).GetValue();
+        Assert(countValue.GetType() == ValueType::intType, "int expected");
+        int len = countValue.AsInt();
+        Thread& thread = frame.GetThread();
+        int bytesSent = 0;
+        {
+            PinnedByteArray bytes(thread, buffer);
+            bytes.CheckRange(0, len);
+            BlockingIoSetter blocking(thread);
+            bytesSent = SendSocket(socketHandle, reinterpret_cast<const char*>(bytes.Bytes()), len, 0);
+        }
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(bytesSent, ValueType::intType));
     }
     catch (const NullReferenceException& ex)
     {
@@ -1203,28 +3249,45 @@ void VmSystemNetSocketsConnectSocket::Execute(Frame& frame)
     }
 }
 
-class VmSystemNetSocketsCloseSocket : public VmFunction
+class VmSystemNetSocketsSendSocketRange : public VmFunction
 {
 public:
-    VmSystemNetSocketsCloseSocket(ConstantPool& constantPool);
+    VmSystemNetSocketsSendSocketRange(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemNetSocketsCloseSocket::VmSystemNetSocketsCloseSocket(ConstantPool& constantPool)
+VmSystemNetSocketsSendSocketRange::VmSystemNetSocketsSendSocketRange(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"closesocket"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"sendrange"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemNetSocketsCloseSocket::Execute(Frame& frame)
+void VmSystemNetSocketsSendSocketRange::Execute(Frame& frame)
 {
     try
     {
-        IntegralValue socketValue = frame.Local(0).GetValue();
-        Assert(socketValue.GetType() == ValueType::intType, "int expected");
-        int32_t socketHandle = socketValue.AsInt();
-        CloseSocket(socketHandle);
+        IntegralValue socketHandleValue = frame.Local(0).GetValue();
+        Assert(socketHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t socketHandle = socketHandleValue.AsInt();
+        IntegralValue bufferValue = frame.Local(1).GetValue();
+        Assert(bufferValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference buffer(bufferValue.Value());
+        IntegralValue offsetValue = frame.Local(2).GetValue();
+        Assert(offsetValue.GetType() == ValueType::intType, "int expected");
+        int32_t offset = offsetValue.AsInt();
+        IntegralValue countValue = frame.Local(3).GetValue();
+        Assert(countValue.GetType() == ValueType::intType, "int expected");
+        int32_t count = countValue.AsInt();
+        Thread& thread = frame.GetThread();
+        int bytesSent = 0;
+        {
+            PinnedByteArray bytes(thread, buffer);
+            bytes.CheckRange(offset, count);
+            BlockingIoSetter blocking(thread);
+            bytesSent = SendSocket(socketHandle, reinterpret_cast<const char*>(bytes.Bytes() + offset), count, 0);
+        }
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(bytesSent, ValueType::intType));
     }
     catch (const NullReferenceException& ex)
     {
@@ -1234,6 +3297,14 @@ void VmSystemNetSocketsCloseSocket::Execute(Frame& frame)
         }
         ThrowNullReferenceException(ex, frame);
     }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
     catch (const SocketError& ex)
     {
         if (RunningNativeCode())
@@ -1252,31 +3323,38 @@ void VmSystemNetSocketsCloseSocket::Execute(Frame& frame)
     }
 }
 
-class VmSystemNetSocketsBindSocket : public VmFunction
+class VmSystemNetSocketsReceiveSocket : public VmFunction
 {
 public:
-    VmSystemNetSocketsBindSocket(ConstantPool& constantPool);
+    VmSystemNetSocketsReceiveSocket(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemNetSocketsBindSocket::VmSystemNetSocketsBindSocket(ConstantPool& constantPool)
+VmSystemNetSocketsReceiveSocket::VmSystemNetSocketsReceiveSocket(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"bind"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"recv"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemNetSocketsBindSocket::Execute(Frame& frame)
+void VmSystemNetSocketsReceiveSocket::Execute(Frame& frame)
 {
     try
     {
         IntegralValue socketValue = frame.Local(0).GetValue();
         Assert(socketValue.GetType() == ValueType::intType, "int expected");
         int32_t socketHandle = socketValue.AsInt();
-        IntegralValue portValue = frame.Local(1).GetValue();
-        Assert(portValue.GetType() == ValueType::intType, "int expected");
-        int port = portValue.AsInt();
-        BindSocket(socketHandle, port);
+        IntegralValue bufferValue = frame.Local(1).GetValue();
+        Assert(bufferValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference buffer(bufferValue.Value());
+        Thread& thread = frame.GetThread();
+        int32_t bytesReceived = 0;
+        {
+            PinnedByteArray bytes(thread, buffer);
+            BlockingIoSetter blocking(thread);
+            bytesReceived = ReceiveSocket(socketHandle, reinterpret_cast<char*>(bytes.Bytes()), bytes.Length(), 0);
+        }
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(bytesReceived, ValueType::intType));
     }
     catch (const NullReferenceException& ex)
     {
@@ -1304,31 +3382,45 @@ void VmSystemNetSocketsBindSocket::Execute(Frame& frame)
     }
 }
 
-class VmSystemNetSocketsListenSocket : public VmFunction
+class VmSystemNetSocketsReceiveSocketRange : public VmFunction
 {
 public:
-    VmSystemNetSocketsListenSocket(ConstantPool& constantPool);
+    VmSystemNetSocketsReceiveSocketRange(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemNetSocketsListenSocket::VmSystemNetSocketsListenSocket(ConstantPool& constantPool)
+VmSystemNetSocketsReceiveSocketRange::VmSystemNetSocketsReceiveSocketRange(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"listen"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"recvrange"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemNetSocketsListenSocket::Execute(Frame& frame)
+void VmSystemNetSocketsReceiveSocketRange::Execute(Frame& frame)
 {
     try
     {
-        IntegralValue socketValue = frame.Local(0).GetValue();
-        Assert(socketValue.GetType() == ValueType::intType, "int expected");
-        int32_t socketHandle = socketValue.AsInt();
-        IntegralValue backlogValue = frame.Local(1).GetValue();
-        Assert(backlogValue.GetType() == ValueType::intType, "int expected");
-        int backlog = backlogValue.AsInt();
-        ListenSocket(socketHandle, backlog);
+        IntegralValue socketHandleValue = frame.Local(0).GetValue();
+        Assert(socketHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t socketHandle = socketHandleValue.AsInt();
+        IntegralValue bufferValue = frame.Local(1).GetValue();
+        Assert(bufferValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference buffer(bufferValue.Value());
+        IntegralValue offsetValue = frame.Local(2).GetValue();
+        Assert(offsetValue.GetType() == ValueType::intType, "int expected");
+        int32_t offset = offsetValue.AsInt();
+        IntegralValue countValue = frame.Local(3).GetValue();
+        Assert(countValue.GetType() == ValueType::intType, "int expected");
+        int32_t count = countValue.AsInt();
+        Thread& thread = frame.GetThread();
+        int32_t bytesReceived = 0;
+        {
+            PinnedByteArray bytes(thread, buffer);
+            bytes.CheckRange(offset, count);
+            BlockingIoSetter blocking(thread);
+            bytesReceived = ReceiveSocket(socketHandle, reinterpret_cast<char*>(bytes.Bytes() + offset), count, 0);
+        }
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(bytesReceived, ValueType::intType));
     }
     catch (const NullReferenceException& ex)
     {
@@ -1338,6 +3430,14 @@ void VmSystemNetSocketsListenSocket::Execute(Frame& frame)
         }
         ThrowNullReferenceException(ex, frame);
     }
+    catch (const IndexOutOfRangeException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowIndexOutOfRangeException(ex, frame);
+    }
     catch (const SocketError& ex)
     {
         if (RunningNativeCode())
@@ -1356,37 +3456,90 @@ void VmSystemNetSocketsListenSocket::Execute(Frame& frame)
     }
 }
 
-class VmSystemNetSocketsAcceptSocket : public VmFunction
+class VmSystemNetSocketsSetSocketBlocking : public VmFunction
 {
 public:
-    VmSystemNetSocketsAcceptSocket(ConstantPool& constantPool);
+    VmSystemNetSocketsSetSocketBlocking(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemNetSocketsAcceptSocket::VmSystemNetSocketsAcceptSocket(ConstantPool& constantPool)
+VmSystemNetSocketsSetSocketBlocking::VmSystemNetSocketsSetSocketBlocking(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"accept"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"setblocking"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemNetSocketsAcceptSocket::Execute(Frame& frame)
+void VmSystemNetSocketsSetSocketBlocking::Execute(Frame& frame)
 {
     try
     {
-        IntegralValue socketValue = frame.Local(0).GetValue();
-        Assert(socketValue.GetType() == ValueType::intType, "int expected");
-        int32_t socketHandle = socketValue.AsInt();
-        int32_t acceptedSocketHandle = AcceptSocket(socketHandle);
-        frame.OpStack().Push(MakeIntegralValue<int32_t>(acceptedSocketHandle, ValueType::intType));
+        IntegralValue socketHandleValue = frame.Local(0).GetValue();
+        Assert(socketHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t socketHandle = socketHandleValue.AsInt();
+        IntegralValue blockingValue = frame.Local(1).GetValue();
+        Assert(blockingValue.GetType() == ValueType::boolType, "bool expected");
+        bool blocking = blockingValue.AsBool();
+        SetSocketBlocking(socketHandle, blocking);
     }
-    catch (const NullReferenceException& ex)
+    catch (const SocketError& ex)
     {
         if (RunningNativeCode())
         {
             throw;
         }
-        ThrowNullReferenceException(ex, frame);
+        ThrowSocketException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+//  Called before a blocking socket operation. A fiber whose socket is not ready waits for it, so that the other fibers of the thread can run
+//  meanwhile, and the function returns true; the caller then calls it again when the fiber resumes. Returns false when the operation can proceed.
+
+class VmSystemNetSocketsWaitSocketInFiber : public VmFunction
+{
+public:
+    VmSystemNetSocketsWaitSocketInFiber(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemNetSocketsWaitSocketInFiber::VmSystemNetSocketsWaitSocketInFiber(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"waitsocketfiber"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemNetSocketsWaitSocketInFiber::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue socketHandleValue = frame.Local(0).GetValue();
+        Assert(socketHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t socketHandle = socketHandleValue.AsInt();
+        IntegralValue eventsValue = frame.Local(1).GetValue();
+        Assert(eventsValue.GetType() == ValueType::intType, "int expected");
+        int32_t events = eventsValue.AsInt();
+        bool waiting = false;
+        Thread& thread = frame.GetThread();
+        if (!RunningNativeCode() && thread.GetFiberSchedulerIfStarted())
+        {
+            std::vector<SocketWait> socketWaits(1, SocketWait(nullptr, socketHandle, events));
+            PollSocketWaits(socketWaits, 0);
+            if (!socketWaits[0].ready)
+            {
+                thread.GetFiberScheduler().WaitSocketCurrent(socketHandle, events);
+                waiting = true;
+            }
+        }
+        frame.OpStack().Push(MakeIntegralValue<bool>(waiting, ValueType::boolType));
     }
     catch (const SocketError& ex)
     {
@@ -1406,39 +3559,161 @@ void VmSystemNetSocketsAcceptSocket::Execute(Frame& frame)
     }
 }
 
-class VmSystemNetSocketsShutdownSocket : public VmFunction
+class VmSystemNetSocketsCreateSelector : public VmFunction
 {
 public:
-    VmSystemNetSocketsShutdownSocket(ConstantPool& constantPool);
+    VmSystemNetSocketsCreateSelector(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemNetSocketsShutdownSocket::VmSystemNetSocketsShutdownSocket(ConstantPool& constantPool)
+VmSystemNetSocketsCreateSelector::VmSystemNetSocketsCreateSelector(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"shutdown"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"selector"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemNetSocketsShutdownSocket::Execute(Frame& frame)
+void VmSystemNetSocketsCreateSelector::Execute(Frame& frame)
 {
     try
     {
-        IntegralValue socketValue = frame.Local(0).GetValue();
-        Assert(socketValue.GetType() == ValueType::intType, "int expected");
-        int32_t socketHandle = socketValue.AsInt();
-        IntegralValue modeValue = frame.Local(1).GetValue();
-        Assert(modeValue.GetType() == ValueType::byteType, "byte expected");
-        ShutdownMode mode = static_cast<ShutdownMode>(modeValue.AsByte());
-        ShutdownSocket(socketHandle, mode);
+        int32_t selectorHandle = CreateSelector();
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(selectorHandle, ValueType::intType));
     }
-    catch (const NullReferenceException& ex)
+    catch (const SocketError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSocketException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemNetSocketsCloseSelector : public VmFunction
+{
+public:
+    VmSystemNetSocketsCloseSelector(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemNetSocketsCloseSelector::VmSystemNetSocketsCloseSelector(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"closeselector"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemNetSocketsCloseSelector::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue selectorHandleValue = frame.Local(0).GetValue();
+        Assert(selectorHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t selectorHandle = selectorHandleValue.AsInt();
+        CloseSelector(selectorHandle);
+    }
+    catch (const SocketError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSocketException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemNetSocketsAddToSelector : public VmFunction
+{
+public:
+    VmSystemNetSocketsAddToSelector(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemNetSocketsAddToSelector::VmSystemNetSocketsAddToSelector(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"selectoradd"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemNetSocketsAddToSelector::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue selectorHandleValue = frame.Local(0).GetValue();
+        Assert(selectorHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t selectorHandle = selectorHandleValue.AsInt();
+        IntegralValue socketHandleValue = frame.Local(1).GetValue();
+        Assert(socketHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t socketHandle = socketHandleValue.AsInt();
+        IntegralValue eventsValue = frame.Local(2).GetValue();
+        Assert(eventsValue.GetType() == ValueType::intType, "int expected");
+        int32_t events = eventsValue.AsInt();
+        AddToSelector(selectorHandle, socketHandle, events);
+    }
+    catch (const SocketError& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSocketException(ex, frame);
+    }
+    catch (const SystemException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowSystemException(ex, frame);
+    }
+}
+
+class VmSystemNetSocketsModifySelector : public VmFunction
+{
+public:
+    VmSystemNetSocketsModifySelector(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemNetSocketsModifySelector::VmSystemNetSocketsModifySelector(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"selectormod"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemNetSocketsModifySelector::Execute(Frame& frame)
+{
+    try
     {
-        if (RunningNativeCode())
-        {
-            throw;
-        }
-        ThrowNullReferenceException(ex, frame);
+        IntegralValue selectorHandleValue = frame.Local(0).GetValue();
+        Assert(selectorHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t selectorHandle = selectorHandleValue.AsInt();
+        IntegralValue socketHandleValue = frame.Local(1).GetValue();
+        Assert(socketHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t socketHandle = socketHandleValue.AsInt();
+        IntegralValue eventsValue = frame.Local(2).GetValue();
+        Assert(eventsValue.GetType() == ValueType::intType, "int expected");
+        int32_t events = eventsValue.AsInt();
+        ModifySelector(selectorHandle, socketHandle, events);
     }
     catch (const SocketError& ex)
     {
@@ -1458,45 +3733,31 @@ void VmSystemNetSocketsShutdownSocket::Execute(Frame& frame)
     }
 }
 
-class VmSystemNetSocketsSendSocket : public VmFunction
+class VmSystemNetSocketsRemoveFromSelector : public VmFunction
 {
 public:
-    VmSystemNetSocketsSendSocket(ConstantPool& constantPool);
+    VmSystemNetSocketsRemoveFromSelector(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemNetSocketsSendSocket::VmSystemNetSocketsSendSocket(ConstantPool& constantPool)
+VmSystemNetSocketsRemoveFromSelector::VmSystemNetSocketsRemoveFromSelector(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"send"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"selectorremove"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemNetSocketsSendSocket::Execute(Frame& frame)
+void VmSystemNetSocketsRemoveFromSelector::Execute(Frame& frame)
 {
     try
     {
-        IntegralValue socketValue = frame.Local(0).GetValue();
-        Assert(socketValue.GetType() == ValueType::intType, "int expected");
-        int32_t socketHandle = socketValue.AsInt();
-        IntegralValue bufferValue = frame.Local(1).GetValue();
-        Assert(bufferValue.GetType() == ValueType::objectReference, "object reference expected");
-        ObjectReference buffer(bufferValue.Value());
-        std::vector<uint8_t> bytes = GetManagedMemoryPool().GetBytes(buffer);
-        IntegralValue countValue = frame.Local(2).GetValue();
-        Assert(countValue.GetType() == ValueType::intType, "int expected");
-        int len = countValue.AsInt();
-        const char* buf = reinterpret_cast<const char*>(&bytes[0]);
-        int bytesSent = SendSocket(socketHandle, buf, len, 0);
-        frame.OpStack().Push(MakeIntegralValue<int32_t>(bytesSent, ValueType::intType));
-    }
-    catch (const NullReferenceException& ex)
-    {
-        if (RunningNativeCode())
-        {
-            throw;
-        }
-        ThrowNullReferenceException(ex, frame);
+        IntegralValue selectorHandleValue = frame.Local(0).GetValue();
+        Assert(selectorHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t selectorHandle = selectorHandleValue.AsInt();
+        IntegralValue socketHandleValue = frame.Local(1).GetValue();
+        Assert(socketHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t socketHandle = socketHandleValue.AsInt();
+        RemoveFromSelector(selectorHandle, socketHandle);
     }
     catch (const SocketError& ex)
     {
@@ -1516,41 +3777,52 @@ void VmSystemNetSocketsSendSocket::Execute(Frame& frame)
     }
 }
 
-class VmSystemNetSocketsReceiveSocket : public VmFunction
+class VmSystemNetSocketsWaitSelector : public VmFunction
 {
 public:
-    VmSystemNetSocketsReceiveSocket(ConstantPool& constantPool);
+    VmSystemNetSocketsWaitSelector(ConstantPool& constantPool);
     void Execute(Frame& frame) override;
 };
 
-VmSystemNetSocketsReceiveSocket::VmSystemNetSocketsReceiveSocket(ConstantPool& constantPool)
+VmSystemNetSocketsWaitSelector::VmSystemNetSocketsWaitSelector(ConstantPool& constantPool)
 {
-    Constant name = constantPool.GetConstant(constantPool.Install(U"recv"));
+    Constant name = constantPool.GetConstant(constantPool.Install(U"selectorwait"));
     SetName(name);
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-void VmSystemNetSocketsReceiveSocket::Execute(Frame& frame)
+void VmSystemNetSocketsWaitSelector::Execute(Frame& frame)
 {
     try
     {
-        IntegralValue socketValue = frame.Local(0).GetValue();
-        Assert(socketValue.GetType() == ValueType::intType, "int expected");
-        int32_t socketHandle = socketValue.AsInt();
-        IntegralValue bufferValue = frame.Local(1).GetValue();
-        Assert(bufferValue.GetType() == ValueType::objectReference, "object reference expected");
-        ObjectReference buffer(bufferValue.Value());
-        std::vector<uint8_t> bytes;
+        IntegralValue selectorHandleValue = frame.Local(0).GetValue();
+        Assert(selectorHandleValue.GetType() == ValueType::intType, "int expected");
+        int32_t selectorHandle = selectorHandleValue.AsInt();
+        IntegralValue timeoutMsValue = frame.Local(1).GetValue();
+        Assert(timeoutMsValue.GetType() == ValueType::intType, "int expected");
+        int timeoutMs = timeoutMsValue.AsInt();
+        IntegralValue socketHandlesValue = frame.Local(2).GetValue();
+        Assert(socketHandlesValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference socketHandles(socketHandlesValue.Value());
+        IntegralValue eventsValue = frame.Local(3).GetValue();
+        Assert(eventsValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference events(eventsValue.Value());
         ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
-        bytes.resize(memoryPool.GetNumArrayElements(buffer));
-        char* buf = reinterpret_cast<char*>(&bytes[0]);
-        int len = int(bytes.size());
-        int32_t bytesReceived = ReceiveSocket(socketHandle, buf, len, 0); 
-        if (bytesReceived > 0)
+        int maxSockets = std::min(memoryPool.GetNumArrayElements(socketHandles), memoryPool.GetNumArrayElements(events));
+        std::vector<SelectedSocket> selected;
+        Thread& thread = frame.GetThread();
         {
-            memoryPool.SetBytes(buffer, bytes, bytesReceived);
+            WaitingSetter waiting(thread);
+            WaitSelector(selectorHandle, timeoutMs, selected, maxSockets);
         }
-        frame.OpStack().Push(MakeIntegralValue<int32_t>(bytesReceived, ValueType::intType));
+        GetMachine().GetGarbageCollector().WaitForIdle(thread);
+        int32_t n = int32_t(selected.size());
+        for (int32_t i = 0; i < n; ++i)
+        {
+            memoryPool.SetArrayElement(socketHandles, i, MakeIntegralValue<int32_t>(selected[i].socketHandle, ValueType::intType));
+            memoryPool.SetArrayElement(events, i, MakeIntegralValue<int32_t>(selected[i].events, ValueType::intType));
+        }
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(n, ValueType::intType));
     }
     catch (const NullReferenceException& ex)
     {
@@ -1868,27 +4140,6 @@ VmSystemThreadingJoinThread::VmSystemThreadingJoinThread(ConstantPool& constantP
     VmFunctionTable::RegisterVmFunction(this);
 }
 
-struct WaitingSetter
-{
-    WaitingSetter(Thread& thread_) : thread(thread_)
-    {
-        prevState = thread.GetState();
-        if (RunningNativeCode())
-        {
-#ifdef SHADOW_STACK_GC
-            thread.SetFunctionStack(RtGetFunctionStack());
-#endif
-        }
-        thread.SetState(ThreadState::waiting);
-    }
-    ~WaitingSetter()
-    {
-        thread.SetState(prevState);
-    }
-    Thread& thread;
-    ThreadState prevState;
-};
-
 void VmSystemThreadingJoinThread::Execute(Frame& frame)
 {
     try
@@ -1953,14 +4204,23 @@ void VmSystemThreadingEnterMonitor::Execute(Frame& frame)
         void* lockObject = memoryPool.GetObject(lockReference, lock);
         ManagedAllocationHeader* header = GetAllocationHeader(lockObject);
         header->Reference();
+        const char32_t* typeName = header->objectHeader.GetType()->Name().Value();
         lock.unlock();
         Thread& thread = frame.GetThread();
-        WaitingSetter waiting(thread);
-        EnterMonitor(header);
+        if (LockProfilingEnabled())
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            bool contended = EnterMonitor(lockReference, thread);
+            int64_t waitNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            RecordLockWait(LockKind::monitor, lockReference.Value(), typeName, contended, waitNs, thread);
+        }
+        else
+        {
+            EnterMonitor(lockReference, thread);
+        }
         lockObject = memoryPool.GetObject(lockReference, lock);
         header = GetAllocationHeader(lockObject);
         header->Unreference();
-        GetMachine().GetGarbageCollector().WaitForIdle(thread);
     }
     catch (const NullReferenceException& ex)
     {
@@ -2002,11 +4262,19 @@ void VmSystemThreadingExitMonitor::Execute(Frame& frame)
         ManagedAllocationHeader* header = GetAllocationHeader(lockObject);
         header->Reference();
         lock.unlock();
-        ExitMonitor(header);
+        ExitMonitor(lockReference, frame.GetThread().Id());
         lockObject = memoryPool.GetObject(lockReference, lock);
         header = GetAllocationHeader(lockObject);
         header->Unreference();
     }
+    catch (const ThreadingException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowThreadingException(ex, frame);
+    }
     catch (const NullReferenceException& ex)
     {
         if (RunningNativeCode())
@@ -2172,17 +4440,18 @@ void VmSystemThreadingConditionVariableWait::Execute(Frame& frame)
         {
             throw NullReferenceException("tried to wait a condition variable with null lock object");
         }
-        void* lockObject = memoryPool.GetObject(lockObjectReference, lock);
-        ManagedAllocationHeader* header = GetAllocationHeader(lockObject);
-        if (header->LockId() == lockNotAllocated)
-        {
-            throw ThreadingException("condition variable must be waited inside a lock statement");
-        }
-        int32_t lockId = header->LockId();
-        lock.unlock();
         Thread& thread = frame.GetThread();
+        int32_t lockId = InflateMonitor(lockObjectReference, thread.Id());
+        const char32_t* condVarTypeName = GetAllocationHeader(memoryPool.GetObject(condVarRefefence, lock))->objectHeader.GetType()->Name().Value();
+        lock.unlock();
         WaitingSetter waiting(thread);
-        WaitConditionVariable(condVarId, lockId);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        WaitConditionVariable(condVarId, lockId, thread.Id());
+        if (LockProfilingEnabled())
+        {
+            int64_t waitNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            RecordLockWait(LockKind::conditionVariable, condVarRefefence.Value(), condVarTypeName, false, waitNs, thread);
+        }
         GetMachine().GetGarbageCollector().WaitForIdle(thread);
     }
     catch (const ThreadingException& ex)
@@ -2238,23 +4507,24 @@ void VmSystemThreadingConditionVariableWaitFor::Execute(Frame& frame)
         {
             throw NullReferenceException("tried to wait a condition variable with null lock object");
         }
-        void* lockObject = memoryPool.GetObject(lockObjectReference, lock);
-        ManagedAllocationHeader* header = GetAllocationHeader(lockObject);
-        if (header->LockId() == lockNotAllocated)
-        {
-            throw ThreadingException("condition variable must be waited inside a lock statement");
-        }
+        Thread& thread = frame.GetThread();
+        int32_t lockId = InflateMonitor(lockObjectReference, thread.Id());
         IntegralValue durationValue(frame.Local(1).GetValue());
         ObjectReference durationRef(durationValue.Value());
         IntegralValue nanosecondValue = memoryPool.GetField(durationRef, 1, lock);
         int64_t nanosecondCount = nanosecondValue.AsLong();
         if (nanosecondCount < 0) return;
         std::chrono::nanoseconds duration{ nanosecondCount };
-        Thread& thread = frame.GetThread();
+        const char32_t* condVarTypeName = GetAllocationHeader(memoryPool.GetObject(condVarRefefence, lock))->objectHeader.GetType()->Name().Value();
         WaitingSetter waiting(thread);
-        int32_t lockId = header->LockId();
         lock.unlock();
-        CondVarStatus status = WaitConditionVariable(condVarId, lockId, duration);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        CondVarStatus status = WaitConditionVariable(condVarId, lockId, thread.Id(), duration);
+        if (LockProfilingEnabled())
+        {
+            int64_t waitNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            RecordLockWait(LockKind::conditionVariable, condVarRefefence.Value(), condVarTypeName, false, waitNs, thread);
+        }
         GetMachine().GetGarbageCollector().WaitForIdle(thread);
         frame.OpStack().Push(MakeIntegralValue<uint8_t>(uint8_t(status), ValueType::byteType));
     }
@@ -2304,6 +4574,224 @@ void VmSystemThreadingHardwareConcurrency::Execute(Frame& frame)
     frame.OpStack().Push(MakeIntegralValue<int32_t>(cores, ValueType::intType));
 }
 
+class VmSystemThreadingCurrentThreadId : public VmFunction
+{
+public:
+    VmSystemThreadingCurrentThreadId(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemThreadingCurrentThreadId::VmSystemThreadingCurrentThreadId(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"thisthreadid"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemThreadingCurrentThreadId::Execute(Frame& frame)
+{
+    int32_t threadId = frame.GetThread().Id();
+    frame.OpStack().Push(MakeIntegralValue<int32_t>(threadId, ValueType::intType));
+}
+
+class VmSystemThreadingMakeDaemonThread : public VmFunction
+{
+public:
+    VmSystemThreadingMakeDaemonThread(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemThreadingMakeDaemonThread::VmSystemThreadingMakeDaemonThread(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"mkdaemon"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemThreadingMakeDaemonThread::Execute(Frame& frame)
+{
+    Thread& thread = frame.GetThread();
+    GetMachine().MakeDaemon(thread);
+}
+
+class VmSystemThreadingOnlyDaemonThreadsRunning : public VmFunction
+{
+public:
+    VmSystemThreadingOnlyDaemonThreadsRunning(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemThreadingOnlyDaemonThreadsRunning::VmSystemThreadingOnlyDaemonThreadsRunning(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"onlydaemons"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemThreadingOnlyDaemonThreadsRunning::Execute(Frame& frame)
+{
+    bool onlyDaemons = GetMachine().OnlyDaemonThreadsRunning();
+    frame.OpStack().Push(MakeIntegralValue<bool>(onlyDaemons, ValueType::boolType));
+}
+
+class VmSystemThreadingStartFiber : public VmFunction
+{
+public:
+    VmSystemThreadingStartFiber(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemThreadingStartFiber::VmSystemThreadingStartFiber(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"startfiber"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemThreadingStartFiber::Execute(Frame& frame)
+{
+    try
+    {
+        if (RunningNativeCode())
+        {
+            throw ThreadingException("fibers are supported only when running intermediate code");
+        }
+        IntegralValue clsdlg = frame.Local(0).GetValue();
+        Assert(clsdlg.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference classDelegateObject(clsdlg.Value());
+        if (classDelegateObject.IsNull())
+        {
+            throw NullReferenceException("provided class delegate is null");
+        }
+        ManagedMemoryPool& memoryPool = GetManagedMemoryPool();
+        std::unique_lock<std::recursive_mutex> lock(memoryPool.AllocationsMutex(), std::defer_lock_t());
+        IntegralValue classObjectValue = memoryPool.GetField(classDelegateObject, 1, lock);
+        Assert(classObjectValue.GetType() == ValueType::objectReference, "object reference expected");
+        ObjectReference receiver(classObjectValue.Value());
+        IntegralValue functionValue = memoryPool.GetField(classDelegateObject, 2, lock);
+        Assert(functionValue.GetType() == ValueType::functionPtr, "function pointer expected");
+        Function* fun = functionValue.AsFunctionPtr();
+        int32_t fiberId = frame.GetThread().GetFiberScheduler().StartFiber(*fun, receiver);
+        frame.OpStack().Push(MakeIntegralValue<int32_t>(fiberId, ValueType::intType));
+    }
+    catch (const NullReferenceException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowNullReferenceException(ex, frame);
+    }
+    catch (const ThreadingException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowThreadingException(ex, frame);
+    }
+}
+
+class VmSystemThreadingYieldFiber : public VmFunction
+{
+public:
+    VmSystemThreadingYieldFiber(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemThreadingYieldFiber::VmSystemThreadingYieldFiber(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"yieldfiber"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemThreadingYieldFiber::Execute(Frame& frame)
+{
+    if (RunningNativeCode())
+    {
+        std::this_thread::yield();
+        return;
+    }
+    frame.GetThread().GetFiberScheduler().YieldCurrent();
+}
+
+class VmSystemThreadingSleepFiber : public VmFunction
+{
+public:
+    VmSystemThreadingSleepFiber(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemThreadingSleepFiber::VmSystemThreadingSleepFiber(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"sleepfiber"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemThreadingSleepFiber::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue durationValue = frame.Local(0).GetValue();
+        ObjectReference durationRef(durationValue.Value());
+        IntegralValue nanosecondValue = GetManagedMemoryPool().GetField(durationRef, 1);
+        int64_t nanosecondCount = nanosecondValue.AsLong();
+        if (nanosecondCount < 0) return;
+        std::chrono::nanoseconds duration{ nanosecondCount };
+        Thread& thread = frame.GetThread();
+        if (RunningNativeCode())
+        {
+            WaitingSetter waiting(thread);
+            std::this_thread::sleep_for(duration);
+            GetMachine().GetGarbageCollector().WaitForIdle(thread);
+            return;
+        }
+        thread.GetFiberScheduler().SleepCurrent(duration);
+    }
+    catch (const std::exception& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw SystemException(ex.what());
+        }
+        ThrowSystemException(SystemException(ex.what()), frame);
+    }
+}
+
+class VmSystemThreadingJoinFiber : public VmFunction
+{
+public:
+    VmSystemThreadingJoinFiber(ConstantPool& constantPool);
+    void Execute(Frame& frame) override;
+};
+
+VmSystemThreadingJoinFiber::VmSystemThreadingJoinFiber(ConstantPool& constantPool)
+{
+    Constant name = constantPool.GetConstant(constantPool.Install(U"joinfiber"));
+    SetName(name);
+    VmFunctionTable::RegisterVmFunction(this);
+}
+
+void VmSystemThreadingJoinFiber::Execute(Frame& frame)
+{
+    try
+    {
+        IntegralValue fiberIdValue = frame.Local(0).GetValue();
+        int32_t fiberId = fiberIdValue.AsInt();
+        frame.GetThread().GetFiberScheduler().Join(fiberId);
+    }
+    catch (const ThreadingException& ex)
+    {
+        if (RunningNativeCode())
+        {
+            throw;
+        }
+        ThrowThreadingException(ex, frame);
+    }
+}
+
 class VmSystemTimePointNow : public VmFunction
 {
 public:
@@ -2716,16 +5204,48 @@ void VmFunctionPool::CreateVmFunctions(ConstantPool& constantPool)
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemObjectGetHashCode(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemObjectEqual(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringConstructorCharArray(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringIntern(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringIndexOf(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringLastIndexOf(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringIndexOfAny(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringLastIndexOfAny(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringStartsWith(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringEndsWith(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringEqual(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringLess(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringGetHashCode(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringSubstring(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringTrim(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringConcat(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringFromUtf8(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringUtf8Length(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemStringToUtf8(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemArrayCopy(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemArrayFill(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemArrayEqual(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemArrayIndexOf(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemArrayReverse(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemArraySort(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOOpenFile(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOCloseFile(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOWriteByteToFile(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOWriteFile(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOWriteFileRange(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOReadByteFromFile(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOReadFile(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOReadFileRange(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOSeekFile(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOTellFile(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOFileExists(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOLastWriteTimeLess(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOOpenMappedFile(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOCloseMappedFile(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOGetMappedFileLength(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOGetMappedFileAddress(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOLoadMappedByte(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOLoadMappedInt(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOReadMappedFile(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOMappedFileIndexOf(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsCreateSocket(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsConnectSocket(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsCloseSocket(constantPool)));
@@ -2734,7 +5254,17 @@ void VmFunctionPool::CreateVmFunctions(ConstantPool& constantPool)
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsAcceptSocket(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsShutdownSocket(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsSendSocket(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsSendSocketRange(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsReceiveSocket(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsReceiveSocketRange(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsSetSocketBlocking(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsWaitSocketInFiber(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsCreateSelector(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsCloseSelector(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsAddToSelector(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsModifySelector(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsRemoveFromSelector(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemNetSocketsWaitSelector(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemGetEnvironmentVariable(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemGetPathSeparatorChar(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemIOInternalGetCurrentWorkingDirectory(constantPool)));
@@ -2753,6 +5283,13 @@ void VmFunctionPool::CreateVmFunctions(ConstantPool& constantPool)
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemTimePointNow(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemSleepFor(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemThreadingHardwareConcurrency(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemThreadingCurrentThreadId(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemThreadingMakeDaemonThread(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemThreadingOnlyDaemonThreadsRunning(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemThreadingStartFiber(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemThreadingYieldFiber(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemThreadingSleepFiber(constantPool)));
+    vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemThreadingJoinFiber(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemRethrow(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemInitRand(constantPool)));
     vmFunctions.push_back(std::unique_ptr<VmFunction>(new VmSystemRandom(constantPool)));